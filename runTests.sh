@@ -15,8 +15,23 @@ make
 # /usr/bin/valgrind valgrind --error-exitcode=123 --leak-check=full ./tests/pageRankCalculationTest
 
 ./tests/sha256Test
+./tests/sha256PerformanceTest
 ./tests/pageRankCalculationTest
-./tests/pageRankPerformanceTest
+./tests/pageRankBenchmark --quick
+./tests/pageRankIncrementalTest
+./tests/pageRankPrecisionTest
+./tests/personalizedPageRankTest
+./tests/parameterSweepTest
+./tests/graphReorderingPerformanceTest
+./tests/rankViewTest
+./tests/binaryNetworkTest
+./tests/syntheticGraphTest
+./tests/computationStatsTest
+./tests/samplingProfilerTest
+./tests/pageIdMapTest
+./tests/externalPageRankTest
+./tests/networkReaderTest
+./tests/networkReaderPerformanceTest
 
 ./tests/e2eTest < ./tests/e2eScenario.txt
 for i in 1 2 7; do ./tests/e2eTest $i < ./tests/e2eScenario.txt; done
@@ -28,7 +43,7 @@ for i in 1 2 7; do ./tests/e2eTest $i < ./tests/e2eScenario.txt; done
 
 # ./tests/sha256Test
 # ./tests/pageRankCalculationTest
-# ./tests/pageRankPerformanceTest
+# ./tests/pageRankBenchmark --json pageRankBenchmark.json
 
 # ./tests/e2eTest < ./tests/e2eScenario.txt
 # for i in 1 2 3 4 8; do ./tests/e2eTest $i < ./tests/e2eScenario.txt; done
@@ -0,0 +1,325 @@
+#ifndef SRC_ACCELERATEDPAGERANKCOMPUTER_HPP_
+#define SRC_ACCELERATEDPAGERANKCOMPUTER_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "immutable/network.hpp"
+#include "immutable/pageIdAndRank.hpp"
+#include "immutable/pageRankComputer.hpp"
+
+#include "compiledNetwork.hpp"
+#include "computationStats.hpp"
+#include "phaseTimes.hpp"
+#include "rankView.hpp"
+
+// Jacobi iteration with two accelerations:
+// - every extrapolationPeriod iterations the rank vector is extrapolated from
+//   the last iterates (Aitken per page, or quadratic extrapolation that removes
+//   the two largest non-principal eigenvector components at once),
+// - adaptive iteration: when the sum of link contributions of a page changed by
+//   less than tolerance * its rank for freezeAfter iterations in a row, the page
+//   is frozen and its links are not read any more. The rank of a frozen page
+//   keeps the last link sum and follows only the dangling and random jump part.
+// Once the ranks converge with frozen pages, every page is unfrozen and full
+// sweeps are made until a full sweep meets the tolerance, so the stopping rule
+// is the same as without the accelerations.
+class AcceleratedPageRankComputer : public PageRankComputer {
+public:
+    enum class Extrapolation {
+        None,
+        Aitken,
+        Quadratic
+    };
+
+    struct Statistics {
+        uint32_t iterations = 0;
+        uint32_t extrapolations = 0;
+        uint64_t edgeVisits = 0; // links read while recomputing pages
+        uint64_t numEdges = 0; // links read by a single full sweep
+    };
+
+    AcceleratedPageRankComputer()
+        : AcceleratedPageRankComputer(Extrapolation::Quadratic, true) {};
+
+    AcceleratedPageRankComputer(Extrapolation extrapolationArg, bool adaptiveArg)
+        : extrapolation(extrapolationArg)
+        , adaptive(adaptiveArg)
+        , lastStatistics()
+        , lastPhaseTimes() {};
+
+    std::vector<PageIdAndRank> computeForNetwork(Network const& network, double alpha, uint32_t iterations, double tolerance) const
+    {
+        RankView view = this->computeViewForNetwork(network, alpha, iterations, tolerance);
+        PhaseStopwatch stopwatch(this->stats.get());
+        std::vector<PageIdAndRank> result = view.toVector();
+        this->lastPhaseTimes.output = stopwatch.lap("output");
+
+        ASSERT(result.size() == network.getSize(), "Invalid result size=" << result.size() << ", for network" << network);
+
+        return result;
+    }
+
+    RankView computeViewForNetwork(Network const& network, double alpha, uint32_t iterations, double tolerance) const
+    {
+        if (this->stats) {
+            this->stats->begin(this->getName(), 1, iterations);
+        }
+        PhaseStopwatch stopwatch(this->stats.get());
+        network.generateIds(0, network.getSize());
+        this->lastPhaseTimes.hashing = stopwatch.lap("generateIds");
+        std::shared_ptr<CompiledNetwork> compiled(new CompiledNetwork(network));
+        this->lastPhaseTimes.build = stopwatch.lap("build");
+        if (this->stats) {
+            this->stats->addBytesAllocated(compiled->getAllocatedBytes());
+        }
+
+        std::vector<double> ranks = this->computeRanks(*compiled, alpha, iterations, tolerance);
+        this->lastPhaseTimes.iterations = stopwatch.lap("iterations");
+        this->lastPhaseTimes.output = 0.0;
+        return RankView(compiled, std::move(ranks));
+    }
+
+    std::string getName() const
+    {
+        std::string name = "AcceleratedPageRankComputer[";
+        switch (this->extrapolation) {
+        case Extrapolation::None:
+            name += "none";
+            break;
+        case Extrapolation::Aitken:
+            name += "aitken";
+            break;
+        case Extrapolation::Quadratic:
+            name += "quadratic";
+            break;
+        }
+        return name + (this->adaptive ? ", adaptive]" : "]");
+    }
+
+    Statistics getLastStatistics() const
+    {
+        return this->lastStatistics;
+    }
+
+    // Number of iterations the last computation needed to converge
+    uint32_t getLastIterations() const
+    {
+        return this->lastStatistics.iterations;
+    }
+
+    // Durations of the phases of the last computation
+    PhaseTimes getLastPhaseTimes() const
+    {
+        return this->lastPhaseTimes;
+    }
+
+    // Every following computation fills the given stats object, nullptr stops the collection
+    void attachStats(std::shared_ptr<ComputationStats> statsArg)
+    {
+        this->stats = statsArg;
+    }
+
+private:
+    static uint32_t const extrapolationPeriod = 6;
+    static uint32_t const freezeAfter = 2;
+    static constexpr double maxAitkenRatio = 0.95;
+
+    Extrapolation extrapolation;
+    bool adaptive;
+    // Written by every computeForNetwork, so one computation may run at a time
+    mutable Statistics lastStatistics;
+    mutable PhaseTimes lastPhaseTimes;
+    std::shared_ptr<ComputationStats> stats;
+
+    std::vector<double> computeRanks(CompiledNetwork const& compiled, double alpha, uint32_t iterations, double tolerance) const
+    {
+        uint32_t size = compiled.getSize();
+        auto const& offsets = compiled.getOffsets();
+        auto const& sources = compiled.getSources();
+        auto const& inverseOutDegrees = compiled.getInverseOutDegrees();
+
+        Statistics statistics;
+        statistics.numEdges = compiled.getNumEdges();
+
+        std::vector<double> ranks(size, 1.0 / size);
+        std::vector<double> previousRanks(size);
+        // Iterates k - 3 and k - 2 for an extrapolation at iteration k
+        std::vector<double> olderRanks;
+        std::vector<double> oldRanks;
+        uint32_t history = this->extrapolation == Extrapolation::Quadratic ? 3 : 2;
+
+        // alpha * sum of contributions of the links of every page, kept for frozen pages
+        std::vector<double> linkSums(size, 0.0);
+        std::vector<uint8_t> stableIterations(size, 0);
+        uint32_t numFrozen = 0;
+        bool finalSweeps = false;
+
+        ComputationStats* stats = this->stats.get();
+        ThreadTimeline timeline(stats, 0);
+        if (stats != nullptr) {
+            // Both rank vectors, link sums, the iterates kept for extrapolation and stability counters
+            uint32_t numVectors = 3 + (this->extrapolation == Extrapolation::None ? 0 : history - 1);
+            stats->addBytesAllocated(size * (numVectors * sizeof(double) + sizeof(uint8_t)));
+        }
+
+        for (uint32_t i = 1; i <= iterations; ++i) {
+            double iterationStart = stats != nullptr ? stats->now() : 0.0;
+            uint64_t edgeVisitsBefore = statistics.edgeVisits;
+            ranks.swap(previousRanks);
+
+            double dangleSum = 0;
+            for (auto danglingNode : compiled.getDanglingNodes()) {
+                dangleSum += previousRanks[danglingNode];
+            }
+            double baseRank = alpha * dangleSum / size + (1.0 - alpha) / size;
+
+            bool fullSweep = numFrozen == 0;
+            double difference = 0;
+            for (uint32_t page = 0; page < size; ++page) {
+                if (stableIterations[page] < freezeAfter) {
+                    double linkSum = 0;
+                    for (uint64_t e = offsets[page]; e < offsets[page + 1]; ++e) {
+                        linkSum += alpha * previousRanks[sources[e]] * inverseOutDegrees[sources[e]];
+                    }
+                    statistics.edgeVisits += offsets[page + 1] - offsets[page];
+
+                    // Pages without links to them read nothing and are never frozen
+                    bool stable = offsets[page + 1] > offsets[page] && std::abs(linkSum - linkSums[page]) < tolerance * previousRanks[page];
+                    if (this->adaptive && not finalSweeps && stable) {
+                        numFrozen += ++stableIterations[page] == freezeAfter ? 1 : 0;
+                    } else {
+                        stableIterations[page] = 0;
+                    }
+                    linkSums[page] = linkSum;
+                }
+
+                double rank = baseRank + linkSums[page];
+                ranks[page] = rank;
+                difference += std::abs(previousRanks[page] - rank);
+            }
+            if (stats != nullptr) {
+                timeline.busy(fullSweep ? "sweep" : "adaptiveSweep", i);
+                stats->addIteration(iterationStart, stats->now(), difference);
+                stats->addEdgesProcessed(statistics.edgeVisits - edgeVisitsBefore);
+            }
+
+            if (difference < tolerance) {
+                if (fullSweep) {
+                    statistics.iterations = i;
+                    this->lastStatistics = statistics;
+                    return ranks;
+                }
+                finalSweeps = true;
+                numFrozen = 0;
+                std::fill(stableIterations.begin(), stableIterations.end(), 0);
+                continue;
+            }
+
+            if (this->extrapolation == Extrapolation::None || finalSweeps) {
+                continue;
+            }
+            uint32_t phase = i % extrapolationPeriod;
+            if (phase == extrapolationPeriod - history) {
+                olderRanks = ranks;
+            } else if (phase == extrapolationPeriod - history + 1 && history == 3) {
+                oldRanks = ranks;
+            } else if (phase == 0) {
+                bool extrapolated = this->extrapolation == Extrapolation::Aitken
+                    ? this->extrapolateAitken(olderRanks, previousRanks, ranks)
+                    : this->extrapolateQuadratic(olderRanks, oldRanks, previousRanks, ranks);
+                statistics.extrapolations += extrapolated ? 1 : 0;
+            }
+        }
+
+        ASSERT(false, "Not able to find result in iterations=" << iterations);
+        return {};
+    }
+
+    // Aitken delta-squared process for every page: with changes d1 = x1 - x0 and
+    // d2 = x2 - x1 shrinking with the ratio r = d2 / d1, the limit is
+    // x2 + d2 * r / (1 - r). olderRanks, previousRanks and ranks are x0, x1 and x2.
+    bool extrapolateAitken(std::vector<double> const& olderRanks,
+        std::vector<double> const& previousRanks, std::vector<double>& ranks) const
+    {
+        double sumBefore = 0;
+        double sumAfter = 0;
+        for (uint32_t page = 0; page < ranks.size(); ++page) {
+            double previousStep = previousRanks[page] - olderRanks[page];
+            double step = ranks[page] - previousRanks[page];
+            sumBefore += ranks[page];
+            // Only pages whose changes shrink monotonically are extrapolated
+            if (previousStep != 0.0) {
+                double ratio = step / previousStep;
+                if (ratio > 0.0 && ratio < maxAitkenRatio) {
+                    ranks[page] += step * ratio / (1.0 - ratio);
+                }
+            }
+            sumAfter += ranks[page];
+        }
+        return this->rescale(sumBefore, sumAfter, ranks);
+    }
+
+    // Quadratic extrapolation (Kamvar et al.): with x0, x1, x2, x3 the last four
+    // iterates and y_j = x_j - x0, gamma minimizes |gamma1 * y1 + gamma2 * y2 + y3|
+    // and the extrapolated vector is beta0 * x1 + beta1 * x2 + beta2 * x3 with
+    // beta0 = gamma1 + gamma2 + 1, beta1 = gamma2 + 1, beta2 = 1.
+    bool extrapolateQuadratic(std::vector<double> const& olderRanks,
+        std::vector<double> const& oldRanks, std::vector<double> const& previousRanks, std::vector<double>& ranks) const
+    {
+        // Normal equations of the 2x2 least squares problem
+        double y11 = 0, y12 = 0, y22 = 0, y13 = 0, y23 = 0;
+        for (uint32_t page = 0; page < ranks.size(); ++page) {
+            double y1 = oldRanks[page] - olderRanks[page];
+            double y2 = previousRanks[page] - olderRanks[page];
+            double y3 = ranks[page] - olderRanks[page];
+            y11 += y1 * y1;
+            y12 += y1 * y2;
+            y22 += y2 * y2;
+            y13 += y1 * y3;
+            y23 += y2 * y3;
+        }
+        double determinant = y11 * y22 - y12 * y12;
+        if (not(std::abs(determinant) > 1e-12 * y11 * y22)) {
+            return false;
+        }
+        double gamma1 = -(y22 * y13 - y12 * y23) / determinant;
+        double gamma2 = -(y11 * y23 - y12 * y13) / determinant;
+        double beta0 = gamma1 + gamma2 + 1.0;
+        double beta1 = gamma2 + 1.0;
+        double betaSum = beta0 + beta1 + 1.0;
+        if (not(std::abs(betaSum) > 1e-12)) {
+            return false;
+        }
+
+        double sumBefore = 0;
+        double sumAfter = 0;
+        for (uint32_t page = 0; page < ranks.size(); ++page) {
+            double rank = ranks[page];
+            sumBefore += rank;
+            double extrapolated = (beta0 * oldRanks[page] + beta1 * previousRanks[page] + rank) / betaSum;
+            if (extrapolated > 0.0) {
+                ranks[page] = extrapolated;
+            }
+            sumAfter += ranks[page];
+        }
+        return this->rescale(sumBefore, sumAfter, ranks);
+    }
+
+    // Extrapolated ranks keep the mass of the pages before the extrapolation
+    bool rescale(double sumBefore, double sumAfter, std::vector<double>& ranks) const
+    {
+        if (not(sumAfter > 0.0)) {
+            return false;
+        }
+        double scale = sumBefore / sumAfter;
+        for (uint32_t page = 0; page < ranks.size(); ++page) {
+            ranks[page] *= scale;
+        }
+        return true;
+    }
+};
+
+#endif /* SRC_ACCELERATEDPAGERANKCOMPUTER_HPP_ */
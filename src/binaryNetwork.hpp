@@ -0,0 +1,232 @@
+#ifndef SRC_BINARYNETWORK_HPP_
+#define SRC_BINARYNETWORK_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "immutable/common.hpp"
+
+#include "compiledNetwork.hpp"
+#include "csrGraph.hpp"
+#include "pageIdTable.hpp"
+
+// On-disk form of a compiled network, laid out so that it can be used
+// straight from a read-only memory mapping. All integers are little endian,
+// every section starts at a 64-byte aligned offset:
+//
+//   BinaryNetworkHeader
+//   digests     numPages * 32 bytes, page ids in page index order
+//   offsets     (numPages + 1) * uint64_t, reverse-edge CSR offsets
+//   sources     numEdges * uint32_t, reverse-edge CSR sources
+//   outDegrees  numPages * uint32_t, number of links of every page
+struct BinaryNetworkHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint64_t numPages;
+    uint64_t numEdges;
+    uint64_t digestsOffset;
+    uint64_t offsetsOffset;
+    uint64_t sourcesOffset;
+    uint64_t outDegreesOffset;
+    uint64_t fileSize;
+};
+
+class BinaryNetwork {
+public:
+    static uint32_t const version = 1;
+
+    static char const* magic()
+    {
+        return "PRNKNET";
+    }
+
+    static void write(CompiledNetwork const& compiled, std::string const& path)
+    {
+        BinaryNetworkHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, magic(), sizeof(header.magic));
+        header.version = version;
+        header.byteOrderMark = byteOrderMark;
+        header.numPages = compiled.getSize();
+        header.numEdges = compiled.getNumEdges();
+        header.digestsOffset = align(sizeof(header));
+        header.offsetsOffset = align(header.digestsOffset + header.numPages * PageId::numBytes);
+        header.sourcesOffset = align(header.offsetsOffset + (header.numPages + 1) * sizeof(uint64_t));
+        header.outDegreesOffset = align(header.sourcesOffset + header.numEdges * sizeof(uint32_t));
+        header.fileSize = align(header.outDegreesOffset + header.numPages * sizeof(uint32_t));
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        ASSERT(out.good(), "Cannot open " << path << " for writing");
+
+        uint64_t position = 0;
+        writeSection(out, position, 0, &header, sizeof(header));
+        writeSection(out, position, header.digestsOffset, nullptr, 0);
+        for (auto const& pageId : compiled.getPageIds()) {
+            writeSection(out, position, position, pageId.getBytes().data(), PageId::numBytes);
+        }
+        writeSection(out, position, header.offsetsOffset, compiled.getOffsets().data(), (header.numPages + 1) * sizeof(uint64_t));
+        writeSection(out, position, header.sourcesOffset, compiled.getSources().data(), header.numEdges * sizeof(uint32_t));
+        writeSection(out, position, header.outDegreesOffset, compiled.getOutDegrees().data(), header.numPages * sizeof(uint32_t));
+        writeSection(out, position, header.fileSize, nullptr, 0);
+
+        ASSERT(out.good(), "Writing " << path << " failed");
+    }
+
+    static uint64_t align(uint64_t offset)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+private:
+    static uint64_t const alignment = 64;
+    static uint32_t const byteOrderMark = 0x01020304;
+
+    friend class MappedNetwork;
+
+    // Pads the file with zeros up to offset and writes size bytes of data there
+    static void writeSection(std::ofstream& out, uint64_t& position, uint64_t offset, void const* data, uint64_t size)
+    {
+        static char const zeros[alignment] = { 0 };
+        ASSERT(position <= offset, "Overlapping sections of the binary network");
+        while (position < offset) {
+            uint64_t chunk = offset - position < alignment ? offset - position : alignment;
+            out.write(zeros, static_cast<std::streamsize>(chunk));
+            position += chunk;
+        }
+        out.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+        position += size;
+    }
+};
+
+// Binary network mapped read-only into memory. Page ids, CSR offsets and
+// sources are used in place, only the inverse out-degrees and the list of
+// dangling pages (O(pages)) are derived when the file is opened.
+class MappedNetwork : public PageIdTable {
+public:
+    MappedNetwork(std::string const& path)
+        : data(nullptr)
+        , size(0)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        ASSERT(fd >= 0, "Cannot open binary network " << path);
+
+        struct stat fileStat;
+        ASSERT(fstat(fd, &fileStat) == 0, "Cannot stat binary network " << path);
+        this->size = static_cast<size_t>(fileStat.st_size);
+        ASSERT(this->size >= sizeof(BinaryNetworkHeader), "Binary network " << path << " is too short");
+
+        void* mapped = mmap(nullptr, this->size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        ASSERT(mapped != MAP_FAILED, "Cannot map binary network " << path);
+        this->data = static_cast<uint8_t const*>(mapped);
+
+        BinaryNetworkHeader const& header = this->getHeader();
+        ASSERT(std::memcmp(header.magic, BinaryNetwork::magic(), sizeof(header.magic)) == 0, path << " is not a binary network");
+        ASSERT(header.version == BinaryNetwork::version, "Unsupported binary network version=" << header.version);
+        ASSERT(header.byteOrderMark == BinaryNetwork::byteOrderMark, "Binary network " << path << " has a different byte order");
+        ASSERT(header.fileSize == this->size, "Binary network " << path << " is truncated, expected size=" << header.fileSize);
+        ASSERT(header.numPages < (1ull << 32), "Too many pages in binary network=" << header.numPages);
+        ASSERT(header.numEdges <= header.fileSize / sizeof(uint32_t), "Too many edges in binary network=" << header.numEdges);
+        uint64_t end = sizeof(BinaryNetworkHeader);
+        checkSection(path, "digests", header.digestsOffset, header.numPages * PageId::numBytes, end);
+        checkSection(path, "offsets", header.offsetsOffset, (header.numPages + 1) * sizeof(uint64_t), end);
+        checkSection(path, "sources", header.sourcesOffset, header.numEdges * sizeof(uint32_t), end);
+        checkSection(path, "out-degrees", header.outDegreesOffset, header.numPages * sizeof(uint32_t), end);
+
+        uint64_t const* offsets = reinterpret_cast<uint64_t const*>(this->data + header.offsetsOffset);
+        ASSERT(offsets[0] == 0 && offsets[header.numPages] == header.numEdges,
+            "Offsets of binary network " << path << " end at=" << offsets[header.numPages] << ", expected=" << header.numEdges);
+
+        // Offsets are checked along the out-degrees, which have to be read anyway
+        this->inverseOutDegrees.resize(header.numPages);
+        uint32_t const* outDegrees = this->getOutDegrees();
+        for (uint32_t page = 0; page < header.numPages; ++page) {
+            ASSERT(offsets[page] <= offsets[page + 1], "Offsets of binary network " << path << " decrease at page=" << page);
+            if (outDegrees[page] == 0) {
+                this->inverseOutDegrees[page] = 0.0;
+                this->danglingNodes.push_back(page);
+            } else {
+                this->inverseOutDegrees[page] = 1.0 / outDegrees[page];
+            }
+        }
+    }
+
+    MappedNetwork(MappedNetwork const&) = delete;
+    MappedNetwork& operator=(MappedNetwork const&) = delete;
+
+    ~MappedNetwork()
+    {
+        munmap(const_cast<uint8_t*>(this->data), this->size);
+    }
+
+    virtual uint32_t getSize() const /*override*/
+    {
+        return static_cast<uint32_t>(this->getHeader().numPages);
+    }
+
+    uint64_t getNumEdges() const
+    {
+        return this->getHeader().numEdges;
+    }
+
+    virtual PageId getPageId(uint32_t page) const /*override*/
+    {
+        return PageId::fromBytes(this->data + this->getHeader().digestsOffset + page * PageId::numBytes);
+    }
+
+    uint32_t const* getOutDegrees() const
+    {
+        return reinterpret_cast<uint32_t const*>(this->data + this->getHeader().outDegreesOffset);
+    }
+
+    CsrGraph getGraph() const
+    {
+        BinaryNetworkHeader const& header = this->getHeader();
+        return CsrGraph {
+            this->getSize(),
+            header.numEdges,
+            reinterpret_cast<uint64_t const*>(this->data + header.offsetsOffset),
+            reinterpret_cast<uint32_t const*>(this->data + header.sourcesOffset),
+            this->inverseOutDegrees.data(),
+            this->danglingNodes.data(),
+            this->danglingNodes.size()
+        };
+    }
+
+    // Pages of a binary network keep the order they were written in
+    virtual uint32_t getCompiledIndex(uint32_t networkIndex) const /*override*/
+    {
+        return networkIndex;
+    }
+
+private:
+    uint8_t const* data;
+    size_t size;
+
+    std::vector<double> inverseOutDegrees;
+    std::vector<uint32_t> danglingNodes;
+
+    BinaryNetworkHeader const& getHeader() const
+    {
+        return *reinterpret_cast<BinaryNetworkHeader const*>(this->data);
+    }
+
+    // Section of size bytes at an aligned offset after the previous section, within the file
+    void checkSection(std::string const& path, char const* name, uint64_t offset, uint64_t sectionSize, uint64_t& end) const
+    {
+        ASSERT(offset % BinaryNetwork::alignment == 0 && offset >= end && offset <= this->size && sectionSize <= this->size - offset,
+            "Section " << name << " of binary network " << path << " is misplaced, offset=" << offset << ", size=" << sectionSize);
+        end = offset + sectionSize;
+    }
+};
+
+#endif /* SRC_BINARYNETWORK_HPP_ */
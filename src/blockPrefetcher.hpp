@@ -0,0 +1,141 @@
+#ifndef SRC_BLOCKPREFETCHER_HPP_
+#define SRC_BLOCKPREFETCHER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "immutable/common.hpp"
+
+#include "blockedEdgeFile.hpp"
+
+// Streams blocks of a BlockedEdgeFile in the order 0, 1, ..., numBlocks - 1,
+// 0, 1, ... over and over: I/O threads read blocks with pread into a ring of
+// buffers ahead of the consumer, so disk reads overlap with the computation,
+// also across iterations. The consumer takes the n-th block of the stream
+// with acquire(n) and returns its buffer with release(n), in order.
+class BlockPrefetcher {
+public:
+    BlockPrefetcher(BlockedEdgeFile const& fileArg, uint32_t numBuffersArg, uint32_t numIoThreadsArg)
+        : file(fileArg)
+        , numBuffers(numBuffersArg)
+        , buffers(numBuffersArg, std::vector<uint32_t>(fileArg.getMaxBlockBytes() / sizeof(uint32_t)))
+        , readySequences(numBuffersArg, noSequence)
+        , nextToRead(0)
+        , numReleased(0)
+        , stopping(false)
+        , waitSeconds(0.0)
+        , bytesRead(0)
+    {
+        ASSERT(numBuffersArg > 0 && numIoThreadsArg > 0, "Prefetching needs a buffer and an I/O thread");
+        ASSERT(!fileArg.getBlocks().empty(), "Nothing to prefetch from a file without blocks");
+        for (uint32_t i = 0; i < numIoThreadsArg; ++i) {
+            this->ioThreads.emplace_back(&BlockPrefetcher::ioLoop, this);
+        }
+    }
+
+    BlockPrefetcher(BlockPrefetcher const&) = delete;
+    BlockPrefetcher& operator=(BlockPrefetcher const&) = delete;
+
+    ~BlockPrefetcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->condition.notify_all();
+        for (auto& thread : this->ioThreads) {
+            thread.join();
+        }
+    }
+
+    // Offsets and sources of block sequence % numBlocks, waits until it is read
+    uint32_t const* acquire(uint64_t sequence)
+    {
+        uint32_t buffer = static_cast<uint32_t>(sequence % this->numBuffers);
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (this->readySequences[buffer] != sequence) {
+            auto start = std::chrono::steady_clock::now();
+            this->condition.wait(lock, [this, buffer, sequence] {
+                return this->readySequences[buffer] == sequence;
+            });
+            this->waitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        return this->buffers[buffer].data();
+    }
+
+    void release(uint64_t sequence)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            ASSERT(sequence == this->numReleased, "Blocks have to be released in order, got=" << sequence << ", expected=" << this->numReleased);
+            this->numReleased++;
+        }
+        this->condition.notify_all();
+    }
+
+    // Time the consumer waited for blocks not read yet
+    double getWaitSeconds() const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->waitSeconds;
+    }
+
+    // Bytes read so far, including blocks read ahead and never acquired
+    uint64_t getBytesRead() const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->bytesRead;
+    }
+
+private:
+    enum : uint64_t { noSequence = UINT64_MAX };
+
+    BlockedEdgeFile const& file;
+    uint32_t const numBuffers;
+    std::vector<std::vector<uint32_t>> buffers;
+    std::vector<uint64_t> readySequences; // sequence of the block held by every buffer
+
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    uint64_t nextToRead;
+    uint64_t numReleased;
+    bool stopping;
+    double waitSeconds;
+    uint64_t bytesRead;
+    std::vector<std::thread> ioThreads;
+
+    void ioLoop()
+    {
+        uint32_t numBlocks = static_cast<uint32_t>(this->file.getBlocks().size());
+        while (true) {
+            uint64_t sequence;
+            {
+                // A buffer is free once the block read into it before was released
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->condition.wait(lock, [this] {
+                    return this->stopping || this->nextToRead < this->numReleased + this->numBuffers;
+                });
+                if (this->stopping) {
+                    return;
+                }
+                sequence = this->nextToRead++;
+            }
+
+            uint32_t block = static_cast<uint32_t>(sequence % numBlocks);
+            std::vector<uint32_t>& buffer = this->buffers[sequence % this->numBuffers];
+            this->file.readBlock(block, buffer.data(), buffer.size() * sizeof(uint32_t));
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->readySequences[sequence % this->numBuffers] = sequence;
+                this->bytesRead += this->file.getBlocks()[block].getBytes();
+            }
+            this->condition.notify_all();
+        }
+    }
+};
+
+#endif /* SRC_BLOCKPREFETCHER_HPP_ */
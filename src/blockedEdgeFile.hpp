@@ -0,0 +1,379 @@
+#ifndef SRC_BLOCKEDEDGEFILE_HPP_
+#define SRC_BLOCKEDEDGEFILE_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "immutable/common.hpp"
+
+// On-disk graph for computations that keep only O(pages) arrays in memory.
+// Edges are partitioned into blocks of consecutive target pages, every block
+// holds the reverse-edge CSR of its pages, so it can be read with one large
+// sequential read and its updates stay within its range of pages. All integers
+// are little endian, blocks start at 4 KiB aligned offsets:
+//
+//   BlockedEdgeFileHeader
+//   outDegrees  numPages * uint32_t, number of links of every page
+//   blocks      numBlocks * BlockedEdgeFileBlock
+//   then, for every block:
+//     offsets   (numPages of the block + 1) * uint32_t, relative to the block
+//     sources   numEdges of the block * uint32_t, sorted for every page
+struct BlockedEdgeFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint64_t numPages;
+    uint64_t numEdges;
+    uint64_t numBlocks;
+    uint64_t maxBlockBytes;
+    uint64_t outDegreesOffset;
+    uint64_t blocksOffset;
+    uint64_t fileSize;
+};
+
+struct BlockedEdgeFileBlock {
+    uint32_t firstPage;
+    uint32_t numPages;
+    uint64_t numEdges;
+    uint64_t offset;
+
+    uint64_t getBytes() const
+    {
+        return (this->numPages + 1 + this->numEdges) * sizeof(uint32_t);
+    }
+};
+
+class BlockedEdgeFile {
+public:
+    static uint32_t const version = 1;
+
+    static char const* magic()
+    {
+        return "PRNKBLK";
+    }
+
+    // Partitions an edge list of native uint32_t pairs (source, target), as
+    // written by SyntheticGraphWriter::writeEdgeList, into blocks of at most
+    // blockBytes. Needs 8 bytes per page and about four blocks of memory: the
+    // list is read once to count degrees, once to spread edges into a
+    // temporary file by block, and every block is then sorted in memory.
+    static void write(std::string const& edgeListPath, uint32_t numPages, std::string const& path, uint64_t blockBytes)
+    {
+        std::vector<uint32_t> outDegrees(numPages, 0);
+        std::vector<uint32_t> inDegrees(numPages, 0);
+        uint64_t numEdges = 0;
+        forEachEdgeChunk(edgeListPath, blockBytes, [&](uint32_t const* edges, size_t count) {
+            for (size_t e = 0; e < count; ++e) {
+                ASSERT(edges[2 * e] < numPages && edges[2 * e + 1] < numPages, "Edge=" << numEdges + e << " of " << edgeListPath << " is out of range");
+                outDegrees[edges[2 * e]]++;
+                inDegrees[edges[2 * e + 1]]++;
+            }
+            numEdges += count;
+        });
+
+        std::vector<BlockedEdgeFileBlock> blocks = partition(inDegrees, blockBytes);
+        inDegrees = std::vector<uint32_t>();
+
+        BlockedEdgeFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, magic(), sizeof(header.magic));
+        header.version = version;
+        header.byteOrderMark = byteOrderMark;
+        header.numPages = numPages;
+        header.numEdges = numEdges;
+        header.numBlocks = blocks.size();
+        header.outDegreesOffset = sizeof(header);
+        header.blocksOffset = header.outDegreesOffset + numPages * sizeof(uint32_t);
+        uint64_t offset = align(header.blocksOffset + blocks.size() * sizeof(BlockedEdgeFileBlock));
+        for (auto& block : blocks) {
+            block.offset = offset;
+            offset = align(offset + block.getBytes());
+            header.maxBlockBytes = std::max(header.maxBlockBytes, block.getBytes());
+        }
+        header.fileSize = offset;
+
+        // Edges grouped by block, in the order of the edge list
+        std::string const pairsPath = path + ".pairs";
+        int pairsFd = open(pairsPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        ASSERT(pairsFd >= 0, "Cannot open " << pairsPath << " for writing");
+        std::vector<uint64_t> blockStarts(blocks.size() + 1, 0);
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            blockStarts[b + 1] = blockStarts[b] + blocks[b].numEdges;
+        }
+        std::vector<uint32_t> blockOf(numPages);
+        for (uint32_t b = 0; b < blocks.size(); ++b) {
+            std::fill(blockOf.begin() + blocks[b].firstPage, blockOf.begin() + blocks[b].firstPage + blocks[b].numPages, b);
+        }
+        size_t bucketEdges = std::max<size_t>(512, blockBytes / (2 * sizeof(uint32_t)) / std::max<size_t>(1, blocks.size()));
+        std::vector<std::vector<uint32_t>> buckets(blocks.size());
+        std::vector<uint64_t> written(blockStarts.begin(), blockStarts.end() - 1);
+        auto flush = [&](uint32_t b) {
+            writeFully(pairsFd, buckets[b].data(), buckets[b].size() * sizeof(uint32_t), written[b] * 2 * sizeof(uint32_t), pairsPath);
+            written[b] += buckets[b].size() / 2;
+            buckets[b].clear();
+        };
+        forEachEdgeChunk(edgeListPath, blockBytes, [&](uint32_t const* edges, size_t count) {
+            for (size_t e = 0; e < count; ++e) {
+                uint32_t b = blockOf[edges[2 * e + 1]];
+                buckets[b].push_back(edges[2 * e]);
+                buckets[b].push_back(edges[2 * e + 1]);
+                if (buckets[b].size() == 2 * bucketEdges) {
+                    flush(b);
+                }
+            }
+        });
+        for (uint32_t b = 0; b < blocks.size(); ++b) {
+            flush(b);
+        }
+        buckets = std::vector<std::vector<uint32_t>>();
+        blockOf = std::vector<uint32_t>();
+
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ASSERT(fd >= 0, "Cannot open " << path << " for writing");
+        ASSERT(ftruncate(fd, static_cast<off_t>(header.fileSize)) == 0, "Cannot resize " << path);
+        writeFully(fd, &header, sizeof(header), 0, path);
+        writeFully(fd, outDegrees.data(), numPages * sizeof(uint32_t), header.outDegreesOffset, path);
+        writeFully(fd, blocks.data(), blocks.size() * sizeof(BlockedEdgeFileBlock), header.blocksOffset, path);
+
+        // Counting sort of every block by target, then sources of every page are sorted
+        std::vector<uint32_t> pairs;
+        std::vector<uint32_t> blockData;
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            BlockedEdgeFileBlock const& block = blocks[b];
+            pairs.resize(2 * block.numEdges);
+            readFully(pairsFd, pairs.data(), pairs.size() * sizeof(uint32_t), blockStarts[b] * 2 * sizeof(uint32_t), pairsPath);
+            blockData.assign(block.numPages + 1 + block.numEdges, 0);
+            uint32_t* offsets = blockData.data();
+            uint32_t* sources = offsets + block.numPages + 1;
+            for (uint64_t e = 0; e < block.numEdges; ++e) {
+                offsets[pairs[2 * e + 1] - block.firstPage + 1]++;
+            }
+            for (uint32_t page = 0; page < block.numPages; ++page) {
+                offsets[page + 1] += offsets[page];
+            }
+            for (uint64_t e = 0; e < block.numEdges; ++e) {
+                sources[offsets[pairs[2 * e + 1] - block.firstPage]++] = pairs[2 * e];
+            }
+            for (uint32_t page = block.numPages; page > 0; --page) {
+                offsets[page] = offsets[page - 1];
+            }
+            offsets[0] = 0;
+            for (uint32_t page = 0; page < block.numPages; ++page) {
+                std::sort(sources + offsets[page], sources + offsets[page + 1]);
+            }
+            writeFully(fd, blockData.data(), block.getBytes(), block.offset, path);
+        }
+
+        close(pairsFd);
+        std::remove(pairsPath.c_str());
+        ASSERT(close(fd) == 0, "Writing " << path << " failed");
+    }
+
+    BlockedEdgeFile(std::string const& pathArg)
+        : path(pathArg)
+        , fd(open(pathArg.c_str(), O_RDONLY))
+    {
+        ASSERT(this->fd >= 0, "Cannot open blocked edge file " << pathArg);
+        readFully(this->fd, &this->header, sizeof(this->header), 0, pathArg);
+        ASSERT(std::memcmp(this->header.magic, magic(), sizeof(this->header.magic)) == 0, pathArg << " is not a blocked edge file");
+        ASSERT(this->header.version == version, "Unsupported blocked edge file version=" << this->header.version);
+        ASSERT(this->header.byteOrderMark == byteOrderMark, "Blocked edge file " << pathArg << " has a different byte order");
+        ASSERT(this->header.numPages < (1ull << 32), "Too many pages in blocked edge file=" << this->header.numPages);
+        struct stat fileStat;
+        ASSERT(fstat(this->fd, &fileStat) == 0 && static_cast<uint64_t>(fileStat.st_size) == this->header.fileSize,
+            "Blocked edge file " << pathArg << " is truncated, expected size=" << this->header.fileSize);
+
+        // Sections lie inside the file, so sizes computed from the header cannot overflow
+        uint64_t fileSize = this->header.fileSize;
+        ASSERT(this->header.numEdges <= fileSize / sizeof(uint32_t) && this->header.numBlocks <= fileSize / sizeof(BlockedEdgeFileBlock),
+            "Blocked edge file " << pathArg << " has too many edges=" << this->header.numEdges << " or blocks=" << this->header.numBlocks);
+        ASSERT(this->header.outDegreesOffset >= sizeof(BlockedEdgeFileHeader) && this->header.outDegreesOffset <= this->header.blocksOffset
+                && this->header.numPages * sizeof(uint32_t) <= this->header.blocksOffset - this->header.outDegreesOffset
+                && this->header.blocksOffset <= fileSize && this->header.numBlocks * sizeof(BlockedEdgeFileBlock) <= fileSize - this->header.blocksOffset,
+            "Blocked edge file " << pathArg << " has sections out of order or outside the file");
+        ASSERT(this->header.maxBlockBytes % sizeof(uint32_t) == 0 && this->header.maxBlockBytes <= fileSize,
+            "Invalid maximal block size=" << this->header.maxBlockBytes << " of " << pathArg);
+
+        this->outDegrees.resize(this->header.numPages);
+        readFully(this->fd, this->outDegrees.data(), this->outDegrees.size() * sizeof(uint32_t), this->header.outDegreesOffset, pathArg);
+        uint64_t numLinks = 0;
+        for (uint32_t outDegree : this->outDegrees) {
+            numLinks += outDegree;
+        }
+        ASSERT(numLinks == this->header.numEdges, "Out-degrees of " << pathArg << " sum to=" << numLinks << ", expected=" << this->header.numEdges);
+
+        // Blocks tile [0, numPages) in order and fit into the file and into buffers of maxBlockBytes
+        this->blocks.resize(this->header.numBlocks);
+        readFully(this->fd, this->blocks.data(), this->blocks.size() * sizeof(BlockedEdgeFileBlock), this->header.blocksOffset, pathArg);
+        uint64_t nextPage = 0;
+        uint64_t numEdges = 0;
+        uint64_t dataStart = this->header.blocksOffset + this->header.numBlocks * sizeof(BlockedEdgeFileBlock);
+        for (size_t b = 0; b < this->blocks.size(); ++b) {
+            BlockedEdgeFileBlock const& block = this->blocks[b];
+            ASSERT(block.firstPage == nextPage && block.numPages > 0 && block.numEdges <= this->header.numEdges - numEdges,
+                "Block=" << b << " of " << pathArg << " does not continue the previous block");
+            ASSERT(block.getBytes() <= this->header.maxBlockBytes, "Block=" << b << " of " << pathArg << " exceeds the maximal block size");
+            ASSERT(block.offset % alignment == 0 && block.offset >= dataStart && block.offset <= fileSize && block.getBytes() <= fileSize - block.offset,
+                "Block=" << b << " of " << pathArg << " lies outside the file");
+            nextPage += block.numPages;
+            numEdges += block.numEdges;
+        }
+        ASSERT(nextPage == this->header.numPages && numEdges == this->header.numEdges,
+            "Blocks of " << pathArg << " cover pages=" << nextPage << " and edges=" << numEdges);
+        posix_fadvise(this->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    BlockedEdgeFile(BlockedEdgeFile const&) = delete;
+    BlockedEdgeFile& operator=(BlockedEdgeFile const&) = delete;
+
+    ~BlockedEdgeFile()
+    {
+        close(this->fd);
+    }
+
+    uint32_t getNumPages() const
+    {
+        return static_cast<uint32_t>(this->header.numPages);
+    }
+
+    uint64_t getNumEdges() const
+    {
+        return this->header.numEdges;
+    }
+
+    uint64_t getMaxBlockBytes() const
+    {
+        return this->header.maxBlockBytes;
+    }
+
+    std::vector<BlockedEdgeFileBlock> const& getBlocks() const
+    {
+        return this->blocks;
+    }
+
+    std::vector<uint32_t> const& getOutDegrees() const
+    {
+        return this->outDegrees;
+    }
+
+    // Reads offsets and sources of the block, getBytes() of the block, with one
+    // call to pread where the system allows, into data of capacity bytes. The
+    // offsets and sources read are checked, so they index only the block and
+    // pages of the file. Safe to call from many threads.
+    void readBlock(uint32_t block, uint32_t* data, uint64_t capacity) const
+    {
+        ASSERT(block < this->blocks.size(), "Invalid block=" << block);
+        BlockedEdgeFileBlock const& entry = this->blocks[block];
+        ASSERT(entry.getBytes() <= capacity, "Block=" << block << " of bytes=" << entry.getBytes() << " does not fit a buffer of bytes=" << capacity);
+        readFully(this->fd, data, entry.getBytes(), entry.offset, this->path);
+
+        uint32_t const* offsets = data;
+        ASSERT(offsets[0] == 0 && offsets[entry.numPages] == entry.numEdges, "Block=" << block << " of " << this->path << " has invalid offsets");
+        for (uint32_t page = 0; page < entry.numPages; ++page) {
+            ASSERT(offsets[page] <= offsets[page + 1], "Block=" << block << " of " << this->path << " has decreasing offsets at page=" << page);
+        }
+        uint32_t const* sources = offsets + entry.numPages + 1;
+        uint32_t maxSource = 0;
+        for (uint64_t e = 0; e < entry.numEdges; ++e) {
+            maxSource = std::max(maxSource, sources[e]);
+        }
+        ASSERT(entry.numEdges == 0 || maxSource < this->header.numPages, "Block=" << block << " of " << this->path << " links from page=" << maxSource);
+    }
+
+private:
+    static uint64_t const alignment = 4096;
+    static uint32_t const byteOrderMark = 0x01020304;
+
+    std::string const path;
+    int const fd;
+    BlockedEdgeFileHeader header;
+    std::vector<uint32_t> outDegrees;
+    std::vector<BlockedEdgeFileBlock> blocks;
+
+    static uint64_t align(uint64_t offset)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    // Consecutive pages while offsets and sources fit into blockBytes
+    static std::vector<BlockedEdgeFileBlock> partition(std::vector<uint32_t> const& inDegrees, uint64_t blockBytes)
+    {
+        std::vector<BlockedEdgeFileBlock> blocks;
+        BlockedEdgeFileBlock block = { 0, 0, 0, 0 };
+        for (uint32_t page = 0; page < inDegrees.size(); ++page) {
+            uint64_t bytes = (block.numPages + 2 + block.numEdges + inDegrees[page]) * sizeof(uint32_t);
+            if (block.numPages > 0 && bytes > blockBytes) {
+                blocks.push_back(block);
+                block = { page, 0, 0, 0 };
+            }
+            block.numPages++;
+            block.numEdges += inDegrees[page];
+            ASSERT(block.getBytes() <= blockBytes, "Links to page=" << page << " do not fit into a block of bytes=" << blockBytes);
+        }
+        if (block.numPages > 0) {
+            blocks.push_back(block);
+        }
+        return blocks;
+    }
+
+    // Calls consume(edges, count) for chunks of the edge list of about chunkBytes
+    template <typename Consume>
+    static void forEachEdgeChunk(std::string const& edgeListPath, uint64_t chunkBytes, Consume const& consume)
+    {
+        int fd = open(edgeListPath.c_str(), O_RDONLY);
+        ASSERT(fd >= 0, "Cannot open edge list " << edgeListPath);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        std::vector<uint32_t> edges(std::max<uint64_t>(2, chunkBytes / sizeof(uint32_t) / 2 * 2));
+        uint64_t offset = 0;
+        while (true) {
+            size_t bytes = readUpTo(fd, edges.data(), edges.size() * sizeof(uint32_t), offset, edgeListPath);
+            ASSERT(bytes % (2 * sizeof(uint32_t)) == 0, "Edge list " << edgeListPath << " ends with half an edge");
+            if (bytes == 0) {
+                break;
+            }
+            consume(edges.data(), bytes / (2 * sizeof(uint32_t)));
+            offset += bytes;
+        }
+        close(fd);
+    }
+
+    // Bytes read until size or the end of the file
+    static size_t readUpTo(int fd, void* data, size_t size, uint64_t offset, std::string const& path)
+    {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t bytes = pread(fd, static_cast<char*>(data) + done, size - done, static_cast<off_t>(offset + done));
+            ASSERT(bytes >= 0, "Reading " << path << " failed");
+            if (bytes == 0) {
+                break;
+            }
+            done += static_cast<size_t>(bytes);
+        }
+        return done;
+    }
+
+    static void readFully(int fd, void* data, size_t size, uint64_t offset, std::string const& path)
+    {
+        ASSERT(readUpTo(fd, data, size, offset, path) == size, path << " is too short");
+    }
+
+    static void writeFully(int fd, void const* data, size_t size, uint64_t offset, std::string const& path)
+    {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t bytes = pwrite(fd, static_cast<char const*>(data) + done, size - done, static_cast<off_t>(offset + done));
+            ASSERT(bytes > 0, "Writing " << path << " failed");
+            done += static_cast<size_t>(bytes);
+        }
+    }
+};
+
+#endif /* SRC_BLOCKEDEDGEFILE_HPP_ */
@@ -0,0 +1,329 @@
+#ifndef SRC_COMPILEDNETWORK_HPP_
+#define SRC_COMPILEDNETWORK_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "immutable/network.hpp"
+
+#include "csrGraph.hpp"
+#include "graphReordering.hpp"
+#include "pageIdIndex.hpp"
+#include "pageIdTable.hpp"
+#include "workerPool.hpp"
+
+// Network resolved once into dense page indices. Incoming edges are kept in
+// CSR form: sources of links pointing to page v are
+// sources[offsets[v]] ... sources[offsets[v + 1] - 1].
+// Pages can be renumbered by a ReorderStrategy for better locality, results
+// are always returned in the order of the network.
+// Page ids have to be generated before compiling.
+class CompiledNetwork : public PageIdTable {
+public:
+    // Built by the calling thread alone, also from within a task of a WorkerPool
+    CompiledNetwork(Network const& network, ReorderStrategy strategy = ReorderStrategy::None)
+        : CompiledNetwork(network, nullptr, strategy)
+    {
+    }
+
+    // Built by all threads of the pool: link ids are resolved in parallel and
+    // counted in shared atomic in-degrees, a parallel prefix sum turns them into
+    // CSR offsets, links are scattered through an atomic cursor of every page
+    // and finally the sources of every page are sorted. Memory besides the graph
+    // is one counter per page and one target per link, whatever the number of
+    // threads.
+    CompiledNetwork(Network const& network, WorkerPool& pool, ReorderStrategy strategy = ReorderStrategy::None)
+        : CompiledNetwork(network, &pool, strategy)
+    {
+    }
+
+    // Network given directly by its parts: page ids, reverse-edge CSR with
+    // sorted sources of every page and the number of links of every page.
+    CompiledNetwork(std::vector<PageId>&& pageIdsArg, std::vector<uint64_t>&& offsetsArg, std::vector<uint32_t>&& sourcesArg, std::vector<uint32_t>&& outDegreesArg)
+        : offsets(std::move(offsetsArg))
+        , sources(std::move(sourcesArg))
+        , outDegrees(std::move(outDegreesArg))
+        , inverseOutDegrees(pageIdsArg.size(), 0.0)
+        , danglingNodes()
+        , pageIds(std::move(pageIdsArg))
+        , compiledIndices()
+    {
+        uint32_t size = this->getSize();
+        ASSERT(this->offsets.size() == size + 1ull && this->outDegrees.size() == size, "Inconsistent parts of a network of size=" << size);
+        ASSERT(this->offsets[size] == this->sources.size(), "Invalid number of edges=" << this->sources.size());
+        for (uint32_t i = 0; i < size; ++i) {
+            if (this->outDegrees[i] == 0) {
+                this->danglingNodes.push_back(i);
+            } else {
+                this->inverseOutDegrees[i] = 1.0 / this->outDegrees[i];
+            }
+        }
+    }
+
+    virtual uint32_t getSize() const /*override*/
+    {
+        return static_cast<uint32_t>(this->pageIds.size());
+    }
+
+    virtual PageId getPageId(uint32_t page) const /*override*/
+    {
+        return this->pageIds[page];
+    }
+
+    uint64_t getNumEdges() const
+    {
+        return this->sources.size();
+    }
+
+    std::vector<uint64_t> const& getOffsets() const
+    {
+        return this->offsets;
+    }
+
+    std::vector<uint32_t> const& getSources() const
+    {
+        return this->sources;
+    }
+
+    // Number of links of every page, including links to pages outside of the network.
+    std::vector<uint32_t> const& getOutDegrees() const
+    {
+        return this->outDegrees;
+    }
+
+    // 1 / (number of links) of every page, 0 for dangling pages.
+    std::vector<double> const& getInverseOutDegrees() const
+    {
+        return this->inverseOutDegrees;
+    }
+
+    std::vector<uint32_t> const& getDanglingNodes() const
+    {
+        return this->danglingNodes;
+    }
+
+    std::vector<PageId> const& getPageIds() const
+    {
+        return this->pageIds;
+    }
+
+    // Bytes held by the arrays of the compiled graph
+    uint64_t getAllocatedBytes() const
+    {
+        return this->offsets.capacity() * sizeof(uint64_t) + this->sources.capacity() * sizeof(uint32_t)
+            + this->outDegrees.capacity() * sizeof(uint32_t) + this->inverseOutDegrees.capacity() * sizeof(double)
+            + this->danglingNodes.capacity() * sizeof(uint32_t) + this->pageIds.capacity() * sizeof(PageId)
+            + this->compiledIndices.capacity() * sizeof(uint32_t);
+    }
+
+    CsrGraph getGraph() const
+    {
+        return CsrGraph {
+            this->getSize(),
+            this->getNumEdges(),
+            this->offsets.data(),
+            this->sources.data(),
+            this->inverseOutDegrees.data(),
+            this->danglingNodes.data(),
+            this->danglingNodes.size()
+        };
+    }
+
+    // Index of the i-th page of the network in the compiled form.
+    virtual uint32_t getCompiledIndex(uint32_t networkIndex) const /*override*/
+    {
+        return this->compiledIndices.empty() ? networkIndex : this->compiledIndices[networkIndex];
+    }
+
+private:
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> sources;
+    std::vector<uint32_t> outDegrees;
+    std::vector<double> inverseOutDegrees;
+    std::vector<uint32_t> danglingNodes;
+    std::vector<PageId> pageIds;
+    std::vector<uint32_t> compiledIndices; // empty when pages keep the order of the network
+
+    // Without a pool every step is a plain loop of the calling thread
+    CompiledNetwork(Network const& network, WorkerPool* pool, ReorderStrategy strategy)
+        : offsets(network.getSize() + 1, 0)
+        , sources()
+        , outDegrees(network.getSize(), 0)
+        , inverseOutDegrees(network.getSize(), 0.0)
+        , danglingNodes()
+        , pageIds(network.getSize())
+        , compiledIndices()
+    {
+        auto const& pages = network.getPages();
+        uint32_t size = static_cast<uint32_t>(pages.size());
+        uint32_t numThreads = pool == nullptr ? 1 : pool->getNumThreads();
+
+        // Pages are only read by reference, building allocates per graph, never per page
+        std::vector<ThreadSlot<uint64_t>> threadLinks(numThreads);
+        std::vector<ThreadSlot<uint64_t>> threadDangling(numThreads);
+        runOn(pool, [&](uint32_t thread) {
+            auto range = WorkerPool::range(size, thread, numThreads);
+            uint64_t numLinks = 0;
+            uint64_t numDangling = 0;
+            for (size_t page = range.first; page < range.second; ++page) {
+                auto const& links = pages[page].getLinks();
+                this->pageIds[page] = pages[page].getId();
+                this->outDegrees[page] = static_cast<uint32_t>(links.size());
+                // Links to pages outside of the network count towards the out-degree
+                // of their source but are not edges of the graph.
+                this->inverseOutDegrees[page] = links.empty() ? 0.0 : 1.0 / links.size();
+                numLinks += links.size();
+                numDangling += links.empty() ? 1 : 0;
+            }
+            threadLinks[thread].value = numLinks;
+            threadDangling[thread].value = numDangling;
+        });
+        PageIdIndex indices = pool == nullptr ? PageIdIndex(this->pageIds.data(), size) : PageIdIndex(this->pageIds.data(), size, *pool);
+
+        std::vector<uint64_t> linkStarts = exclusivePrefixSum(threadLinks);
+        std::vector<uint64_t> danglingStarts = exclusivePrefixSum(threadDangling);
+        std::vector<uint32_t> targets(linkStarts[numThreads]);
+        this->danglingNodes.resize(danglingStarts[numThreads]);
+        // In-degree of every page, later the number of its sources already scattered
+        std::unique_ptr<std::atomic<uint32_t>[]> inDegrees(new std::atomic<uint32_t>[size]);
+        runOn(pool, [&](uint32_t thread) {
+            auto range = WorkerPool::range(size, thread, numThreads);
+            for (size_t page = range.first; page < range.second; ++page) {
+                inDegrees[page].store(0, std::memory_order_relaxed);
+            }
+        });
+        runOn(pool, [&](uint32_t thread) {
+            auto range = WorkerPool::range(size, thread, numThreads);
+            uint64_t link = linkStarts[thread];
+            uint64_t dangling = danglingStarts[thread];
+            for (size_t page = range.first; page < range.second; ++page) {
+                auto const& links = pages[page].getLinks();
+                if (links.empty()) {
+                    this->danglingNodes[dangling++] = static_cast<uint32_t>(page);
+                }
+                for (auto const& linkId : links) {
+                    uint32_t target = indices.find(linkId);
+                    targets[link++] = target;
+                    if (target != PageIdIndex::notFound) {
+                        inDegrees[target].fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        });
+
+        // Prefix sum over ranges of pages by threads, then over pages of every range
+        std::vector<ThreadSlot<uint64_t>> rangeEdges(numThreads);
+        runOn(pool, [&](uint32_t thread) {
+            auto range = WorkerPool::range(size, thread, numThreads);
+            uint64_t numEdges = 0;
+            for (size_t page = range.first; page < range.second; ++page) {
+                numEdges += inDegrees[page].load(std::memory_order_relaxed);
+            }
+            rangeEdges[thread].value = numEdges;
+        });
+        std::vector<uint64_t> rangeStarts = exclusivePrefixSum(rangeEdges);
+        runOn(pool, [&](uint32_t thread) {
+            auto range = WorkerPool::range(size, thread, numThreads);
+            uint64_t offset = rangeStarts[thread];
+            for (size_t page = range.first; page < range.second; ++page) {
+                this->offsets[page] = offset;
+                offset += inDegrees[page].load(std::memory_order_relaxed);
+                inDegrees[page].store(0, std::memory_order_relaxed);
+            }
+        });
+        this->offsets[size] = rangeStarts[numThreads];
+
+        // Threads scatter in any order, sorting restores ascending sources of every page
+        this->sources.resize(this->offsets[size]);
+        runOn(pool, [&](uint32_t thread) {
+            auto range = WorkerPool::range(size, thread, numThreads);
+            uint64_t link = linkStarts[thread];
+            for (size_t page = range.first; page < range.second; ++page) {
+                for (uint32_t l = 0; l < this->outDegrees[page]; ++l) {
+                    uint32_t target = targets[link++];
+                    if (target != PageIdIndex::notFound) {
+                        uint32_t position = inDegrees[target].fetch_add(1, std::memory_order_relaxed);
+                        this->sources[this->offsets[target] + position] = static_cast<uint32_t>(page);
+                    }
+                }
+            }
+        });
+        if (numThreads > 1) {
+            runOn(pool, [&](uint32_t thread) {
+                auto range = WorkerPool::range(size, thread, numThreads);
+                for (size_t page = range.first; page < range.second; ++page) {
+                    std::sort(this->sources.begin() + this->offsets[page], this->sources.begin() + this->offsets[page + 1]);
+                }
+            });
+        }
+
+        if (strategy != ReorderStrategy::None) {
+            this->applyOrder(GraphReordering::computeOrder(this->getGraph(), strategy));
+        }
+    }
+
+    static void runOn(WorkerPool* pool, std::function<void(uint32_t)> const& task)
+    {
+        if (pool == nullptr) {
+            task(0);
+        } else {
+            pool->run(task);
+        }
+    }
+
+    // Start of the part of every thread, followed by the total
+    static std::vector<uint64_t> exclusivePrefixSum(std::vector<ThreadSlot<uint64_t>> const& counts)
+    {
+        std::vector<uint64_t> starts(counts.size() + 1, 0);
+        for (size_t thread = 0; thread < counts.size(); ++thread) {
+            starts[thread + 1] = starts[thread] + counts[thread].value;
+        }
+        return starts;
+    }
+
+    // Renumbers pages so that order[newIndex] = oldIndex, sources of every page stay sorted
+    void applyOrder(std::vector<uint32_t> const& order)
+    {
+        uint32_t size = this->getSize();
+        this->compiledIndices.assign(size, 0);
+        for (uint32_t page = 0; page < size; ++page) {
+            this->compiledIndices[order[page]] = page;
+        }
+
+        std::vector<uint64_t> newOffsets(size + 1, 0);
+        std::vector<uint32_t> newSources(this->sources.size());
+        std::vector<uint32_t> newOutDegrees(size);
+        std::vector<double> newInverseOutDegrees(size);
+        std::vector<PageId> newPageIds(size);
+        this->danglingNodes.clear();
+        for (uint32_t page = 0; page < size; ++page) {
+            uint32_t old = order[page];
+            uint64_t position = newOffsets[page];
+            for (uint64_t e = this->offsets[old]; e < this->offsets[old + 1]; ++e) {
+                newSources[position++] = this->compiledIndices[this->sources[e]];
+            }
+            std::sort(newSources.begin() + newOffsets[page], newSources.begin() + position);
+            newOffsets[page + 1] = position;
+
+            newOutDegrees[page] = this->outDegrees[old];
+            newInverseOutDegrees[page] = this->inverseOutDegrees[old];
+            newPageIds[page] = this->pageIds[old];
+            if (this->outDegrees[old] == 0) {
+                this->danglingNodes.push_back(page);
+            }
+        }
+
+        this->offsets.swap(newOffsets);
+        this->sources.swap(newSources);
+        this->outDegrees.swap(newOutDegrees);
+        this->inverseOutDegrees.swap(newInverseOutDegrees);
+        this->pageIds.swap(newPageIds);
+    }
+};
+
+#endif /* SRC_COMPILEDNETWORK_HPP_ */
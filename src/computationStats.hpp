@@ -0,0 +1,297 @@
+#ifndef SRC_COMPUTATIONSTATS_HPP_
+#define SRC_COMPUTATIONSTATS_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "immutable/common.hpp"
+
+#include "jsonWriter.hpp"
+#include "workerPool.hpp"
+
+// Telemetry of the last computation of a computer the object is attached to:
+// phase durations, duration and residual of every iteration, edges processed,
+// bytes allocated for the compiled graph and rank buffers, and the busy and
+// wait spans of every thread. Computers without an attached object only test a
+// null pointer at phase and iteration boundaries, nothing in the inner loops.
+class ComputationStats {
+public:
+    enum class SpanKind {
+        Busy,
+        Wait
+    };
+
+    struct Span {
+        char const* name;
+        uint32_t iteration; // 0 outside of iterations
+        double start; // seconds since the computation began
+        double end;
+    };
+
+    struct Iteration {
+        double start;
+        double end;
+        double residual;
+    };
+
+    ComputationStats()
+        : origin(std::chrono::steady_clock::now())
+        , numThreads(0)
+        , edgesProcessed(0)
+        , bytesAllocated(0)
+    {
+    }
+
+    // Forgets the previous computation, called by a computer when it starts
+    void begin(std::string const& computerArg, uint32_t numThreadsArg, uint32_t maxIterations)
+    {
+        this->origin = std::chrono::steady_clock::now();
+        this->computer = computerArg;
+        this->numThreads = numThreadsArg;
+        this->phases.clear();
+        this->iterations.clear();
+        this->edgesProcessed = 0;
+        this->bytesAllocated = 0;
+        this->threadSpans.assign(numThreadsArg, ThreadSlot<ThreadSpans>());
+        // Spans are recorded without reallocating for the usual numbers of iterations
+        size_t expectedSpans = 4 * std::min<size_t>(maxIterations, 256);
+        for (auto& spans : this->threadSpans) {
+            spans.value.busy.reserve(expectedSpans);
+            spans.value.wait.reserve(expectedSpans);
+        }
+        this->iterations.reserve(expectedSpans / 4);
+    }
+
+    double toSeconds(std::chrono::steady_clock::time_point time) const
+    {
+        return std::chrono::duration<double>(time - this->origin).count();
+    }
+
+    double now() const
+    {
+        return this->toSeconds(std::chrono::steady_clock::now());
+    }
+
+    void addPhase(char const* name, double start, double end)
+    {
+        this->phases.push_back(Span { name, 0, start, end });
+    }
+
+    // Called once per iteration by a single thread
+    void addIteration(double start, double end, double residual)
+    {
+        this->iterations.push_back(Iteration { start, end, residual });
+    }
+
+    // Only the given thread may add its spans, threads add them concurrently
+    void addThreadSpan(uint32_t thread, SpanKind kind, char const* name, uint32_t iteration, double start, double end)
+    {
+        ThreadSpans& spans = this->threadSpans[thread].value;
+        (kind == SpanKind::Busy ? spans.busy : spans.wait).push_back(Span { name, iteration, start, end });
+    }
+
+    void addEdgesProcessed(uint64_t edges)
+    {
+        this->edgesProcessed += edges;
+    }
+
+    void addBytesAllocated(uint64_t bytes)
+    {
+        this->bytesAllocated += bytes;
+    }
+
+    std::string const& getComputer() const
+    {
+        return this->computer;
+    }
+
+    uint32_t getNumThreads() const
+    {
+        return this->numThreads;
+    }
+
+    std::vector<Span> const& getPhases() const
+    {
+        return this->phases;
+    }
+
+    // Seconds of the phase with the given name, 0 when it was not recorded
+    double getPhaseSeconds(std::string const& name) const
+    {
+        double seconds = 0.0;
+        for (auto const& phase : this->phases) {
+            seconds += name == phase.name ? phase.end - phase.start : 0.0;
+        }
+        return seconds;
+    }
+
+    std::vector<Iteration> const& getIterations() const
+    {
+        return this->iterations;
+    }
+
+    uint64_t getEdgesProcessed() const
+    {
+        return this->edgesProcessed;
+    }
+
+    uint64_t getBytesAllocated() const
+    {
+        return this->bytesAllocated;
+    }
+
+    std::vector<Span> const& getThreadSpans(uint32_t thread, SpanKind kind) const
+    {
+        ThreadSpans const& spans = this->threadSpans[thread].value;
+        return kind == SpanKind::Busy ? spans.busy : spans.wait;
+    }
+
+    double getThreadSeconds(uint32_t thread, SpanKind kind) const
+    {
+        double seconds = 0.0;
+        for (auto const& span : this->getThreadSpans(thread, kind)) {
+            seconds += span.end - span.start;
+        }
+        return seconds;
+    }
+
+    void writeJson(std::ostream& out) const
+    {
+        JsonWriter json(out);
+        json.beginObject();
+        json.field("computer", this->computer).field("threads", this->numThreads);
+        json.field("edgesProcessed", this->edgesProcessed).field("bytesAllocated", this->bytesAllocated);
+        json.key("phases").beginArray();
+        for (auto const& phase : this->phases) {
+            json.beginObject().field("name", phase.name).field("start", phase.start).field("seconds", phase.end - phase.start).endObject();
+        }
+        json.endArray();
+        json.key("iterations").beginArray();
+        for (auto const& iteration : this->iterations) {
+            json.beginObject().field("seconds", iteration.end - iteration.start).field("residual", iteration.residual).endObject();
+        }
+        json.endArray();
+        json.key("threadTimes").beginArray();
+        for (uint32_t thread = 0; thread < this->numThreads; ++thread) {
+            json.beginObject().field("thread", thread);
+            json.field("busy", this->getThreadSeconds(thread, SpanKind::Busy)).field("wait", this->getThreadSeconds(thread, SpanKind::Wait));
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+    }
+
+    // Trace Event Format read by chrome://tracing and Perfetto: phases and
+    // iterations on the first track, busy and wait spans on a track per thread
+    // and the residual as a counter.
+    void writeChromeTrace(std::ostream& out) const
+    {
+        JsonWriter json(out);
+        json.beginObject();
+        json.key("displayTimeUnit").value("ms");
+        json.key("traceEvents").beginArray();
+        this->writeTrackName(json, 0, this->computer);
+        for (uint32_t thread = 0; thread < this->numThreads; ++thread) {
+            this->writeTrackName(json, thread + 1, "thread " + std::to_string(thread));
+        }
+
+        for (auto const& phase : this->phases) {
+            this->writeEvent(json, 0, "phase", phase);
+        }
+        for (size_t i = 0; i < this->iterations.size(); ++i) {
+            Iteration const& iteration = this->iterations[i];
+            this->writeEvent(json, 0, "iteration", Span { "iteration", static_cast<uint32_t>(i + 1), iteration.start, iteration.end });
+            json.beginObject();
+            json.field("name", "residual").field("ph", "C").field("pid", 1u).field("tid", 0u).field("ts", iteration.end * 1e6);
+            json.key("args").beginObject().field("residual", iteration.residual).endObject();
+            json.endObject();
+        }
+        for (uint32_t thread = 0; thread < this->numThreads; ++thread) {
+            for (auto const& span : this->getThreadSpans(thread, SpanKind::Busy)) {
+                this->writeEvent(json, thread + 1, "busy", span);
+            }
+            for (auto const& span : this->getThreadSpans(thread, SpanKind::Wait)) {
+                this->writeEvent(json, thread + 1, "wait", span);
+            }
+        }
+        json.endArray();
+        json.endObject();
+    }
+
+private:
+    struct ThreadSpans {
+        std::vector<Span> busy;
+        std::vector<Span> wait;
+    };
+
+    std::chrono::steady_clock::time_point origin;
+    std::string computer;
+    uint32_t numThreads;
+    std::vector<Span> phases;
+    std::vector<Iteration> iterations;
+    uint64_t edgesProcessed;
+    uint64_t bytesAllocated;
+    std::vector<ThreadSlot<ThreadSpans>> threadSpans;
+
+    void writeTrackName(JsonWriter& json, uint32_t track, std::string const& name) const
+    {
+        json.beginObject();
+        json.field("name", "thread_name").field("ph", "M").field("pid", 1u).field("tid", track);
+        json.key("args").beginObject().field("name", name).endObject();
+        json.endObject();
+    }
+
+    void writeEvent(JsonWriter& json, uint32_t track, char const* category, Span const& span) const
+    {
+        json.beginObject();
+        json.field("name", span.name).field("cat", category).field("ph", "X").field("pid", 1u).field("tid", track);
+        json.field("ts", span.start * 1e6).field("dur", (span.end - span.start) * 1e6);
+        if (span.iteration > 0) {
+            json.key("args").beginObject().field("iteration", span.iteration).endObject();
+        }
+        json.endObject();
+    }
+};
+
+// Splits the time of a thread into consecutive busy and wait spans. Does
+// nothing, not even reading the clock, when no stats object is attached.
+class ThreadTimeline {
+public:
+    ThreadTimeline(ComputationStats* statsArg, uint32_t threadArg)
+        : stats(statsArg)
+        , thread(threadArg)
+        , last(statsArg != nullptr ? statsArg->now() : 0.0)
+    {
+    }
+
+    // Ends the current span, which is of the given kind
+    void mark(ComputationStats::SpanKind kind, char const* name, uint32_t iteration)
+    {
+        if (this->stats != nullptr) {
+            double now = this->stats->now();
+            this->stats->addThreadSpan(this->thread, kind, name, iteration, this->last, now);
+            this->last = now;
+        }
+    }
+
+    void busy(char const* name, uint32_t iteration)
+    {
+        this->mark(ComputationStats::SpanKind::Busy, name, iteration);
+    }
+
+    void wait(uint32_t iteration)
+    {
+        this->mark(ComputationStats::SpanKind::Wait, "barrier", iteration);
+    }
+
+private:
+    ComputationStats* stats;
+    uint32_t thread;
+    double last;
+};
+
+#endif /* SRC_COMPUTATIONSTATS_HPP_ */
@@ -0,0 +1,20 @@
+#ifndef SRC_CSRGRAPH_HPP_
+#define SRC_CSRGRAPH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+// Non-owning view of a network in reverse-edge CSR form, shared by every
+// storage of compiled networks (in memory or memory-mapped from a file).
+// Sources of links pointing to page v are sources[offsets[v]] ... sources[offsets[v + 1] - 1].
+struct CsrGraph {
+    uint32_t size;
+    uint64_t numEdges;
+    uint64_t const* offsets;
+    uint32_t const* sources;
+    double const* inverseOutDegrees; // 1 / (number of links), 0 for dangling pages
+    uint32_t const* danglingNodes;
+    size_t numDanglingNodes;
+};
+
+#endif /* SRC_CSRGRAPH_HPP_ */
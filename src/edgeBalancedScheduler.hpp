@@ -0,0 +1,115 @@
+#ifndef SRC_EDGEBALANCEDSCHEDULER_HPP_
+#define SRC_EDGEBALANCEDSCHEDULER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "immutable/common.hpp"
+
+#include "csrGraph.hpp"
+#include "workerPool.hpp"
+
+// Splits the pages of a graph into chunks of about the same work, counted as
+// in-edges plus one per page (prefix sums over the CSR offsets). Every thread
+// owns a contiguous run of chunks and, once done with it, steals the remaining
+// chunks of other threads of its group (all threads by default). A single page
+// is never split, so a page with more in-edges than a chunk forms a chunk of
+// its own.
+//
+// Iterations alternate between two sets of chunk counters. While running
+// iteration i a thread resets its counter for iteration i + 1, which is safe as
+// long as threads pass a barrier between the chunk loops of consecutive iterations.
+class EdgeBalancedScheduler {
+public:
+    static uint32_t const defaultChunksPerThread = 16;
+
+    EdgeBalancedScheduler(CsrGraph const& graph, uint32_t numThreadsArg, uint32_t chunksPerThread = defaultChunksPerThread)
+        : EdgeBalancedScheduler(graph, numThreadsArg, std::vector<uint32_t>(numThreadsArg, 0), chunksPerThread)
+    {
+    }
+
+    // Threads steal only from threads with the same group, e.g. threads of one NUMA node
+    EdgeBalancedScheduler(CsrGraph const& graph, uint32_t numThreadsArg, std::vector<uint32_t> const& groupsArg, uint32_t chunksPerThread = defaultChunksPerThread)
+        : numThreads(numThreadsArg)
+        , groups(groupsArg)
+        , chunkStarts()
+        , ownedChunks()
+    {
+        ASSERT(groupsArg.size() == numThreadsArg, "Invalid number of thread groups=" << groupsArg.size());
+
+        uint64_t const* offsets = graph.offsets;
+        size_t numChunks = std::min<size_t>(graph.size, static_cast<size_t>(numThreadsArg) * chunksPerThread);
+        uint64_t totalWork = graph.numEdges + graph.size;
+
+        this->chunkStarts.push_back(0);
+        for (size_t chunk = 1; chunk < numChunks; ++chunk) {
+            uint64_t work = totalWork * chunk / numChunks;
+            uint32_t low = this->chunkStarts.back();
+            uint32_t high = graph.size;
+            // First page whose preceding work (offsets[page] + page) reaches the chunk boundary
+            while (low < high) {
+                uint32_t middle = low + (high - low) / 2;
+                if (offsets[middle] + middle < work) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            if (low > this->chunkStarts.back()) {
+                this->chunkStarts.push_back(low);
+            }
+        }
+        this->chunkStarts.push_back(graph.size);
+
+        for (uint32_t thread = 0; thread < numThreadsArg; ++thread) {
+            this->ownedChunks.push_back(WorkerPool::range(this->getNumChunks(), thread, numThreadsArg));
+        }
+        for (auto& counters : this->nextChunks) {
+            counters = std::vector<ThreadSlot<std::atomic<size_t>>>(numThreadsArg);
+            for (uint32_t thread = 0; thread < numThreadsArg; ++thread) {
+                counters[thread].value = this->ownedChunks[thread].first;
+            }
+        }
+    }
+
+    size_t getNumChunks() const
+    {
+        return this->chunkStarts.size() - 1;
+    }
+
+    // Pages [start, end) of the chunks owned by the thread
+    std::pair<size_t, size_t> getOwnedPages(uint32_t thread) const
+    {
+        return std::make_pair(this->chunkStarts[this->ownedChunks[thread].first], this->chunkStarts[this->ownedChunks[thread].second]);
+    }
+
+    // Calls process(start, end, owner) for page ranges of the chunks the thread claims in the iteration
+    template <typename Process>
+    void forEachChunk(uint32_t thread, uint32_t iteration, Process const& process)
+    {
+        auto& counters = this->nextChunks[iteration % 2];
+        for (uint32_t step = 0; step < this->numThreads; ++step) {
+            uint32_t victim = (thread + step) % this->numThreads;
+            if (this->groups[victim] != this->groups[thread]) {
+                continue;
+            }
+            size_t end = this->ownedChunks[victim].second;
+            for (size_t chunk = counters[victim].value++; chunk < end; chunk = counters[victim].value++) {
+                process(this->chunkStarts[chunk], this->chunkStarts[chunk + 1], victim);
+            }
+        }
+        this->nextChunks[(iteration + 1) % 2][thread].value = this->ownedChunks[thread].first;
+    }
+
+private:
+    uint32_t numThreads;
+    std::vector<uint32_t> groups;
+    std::vector<uint32_t> chunkStarts;
+    std::vector<std::pair<size_t, size_t>> ownedChunks;
+    std::vector<ThreadSlot<std::atomic<size_t>>> nextChunks[2];
+};
+
+#endif /* SRC_EDGEBALANCEDSCHEDULER_HPP_ */
@@ -0,0 +1,202 @@
+#ifndef SRC_EXTERNALPAGERANKCOMPUTER_HPP_
+#define SRC_EXTERNALPAGERANKCOMPUTER_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "immutable/common.hpp"
+
+#include "blockPrefetcher.hpp"
+#include "blockedEdgeFile.hpp"
+#include "computationStats.hpp"
+#include "phaseTimes.hpp"
+#include "workerPool.hpp"
+
+// Semi-external computer for graphs whose edges do not fit in memory: only
+// ranks, contributions (rank / out-degree) and out-degrees of the pages are
+// kept in memory (20 bytes per page), edges are streamed from a
+// BlockedEdgeFile once per iteration. Every block updates the ranks of its
+// own range of pages, split between the threads of the pool, while I/O
+// threads read the next blocks. Blocks are read into as many buffers as the
+// memory budget leaves room for, at least two.
+// Iterations are the same as those of the in-memory computers, ranks are
+// returned in the order of pages of the file.
+class ExternalPageRankComputer {
+public:
+    ExternalPageRankComputer(uint32_t numThreadsArg, uint64_t memoryBudgetArg)
+        : ExternalPageRankComputer(numThreadsArg, memoryBudgetArg, 2)
+    {
+    }
+
+    ExternalPageRankComputer(uint32_t numThreadsArg, uint64_t memoryBudgetArg, uint32_t numIoThreadsArg)
+        : numThreads(numThreadsArg)
+        , memoryBudget(memoryBudgetArg)
+        , numIoThreads(numIoThreadsArg)
+        , pool(new WorkerPool(numThreadsArg))
+        , lastIterations(0)
+        , lastIo()
+    {
+    }
+
+    // Bytes of memory needed besides the block buffers
+    static uint64_t getResidentBytes(BlockedEdgeFile const& file)
+    {
+        return file.getNumPages() * (2 * sizeof(double) + sizeof(uint32_t)) + file.getBlocks().size() * sizeof(BlockedEdgeFileBlock);
+    }
+
+    std::vector<double> computeForFile(BlockedEdgeFile const& file, double alpha, uint32_t iterations, double tolerance) const
+    {
+        uint32_t size = file.getNumPages();
+        if (size == 0) {
+            // No blocks to stream, nothing for the prefetcher to read
+            this->lastIo.waitSeconds = 0.0;
+            this->lastIo.bytesRead = 0;
+            this->lastIo.numBuffers = 0;
+            this->lastIterations = 0;
+            return {};
+        }
+        uint32_t numBlocks = static_cast<uint32_t>(file.getBlocks().size());
+        uint64_t residentBytes = getResidentBytes(file);
+        ASSERT(this->memoryBudget >= residentBytes + 2 * file.getMaxBlockBytes(),
+            "Memory budget=" << this->memoryBudget << " is too small, at least " << residentBytes + 2 * file.getMaxBlockBytes() << " bytes are needed");
+        uint32_t numBuffers = static_cast<uint32_t>(std::min<uint64_t>((this->memoryBudget - residentBytes) / file.getMaxBlockBytes(), numBlocks + 1ull));
+        numBuffers = std::max(numBuffers, 2u);
+
+        if (this->stats) {
+            this->stats->begin(this->getName(), this->numThreads, iterations);
+            this->stats->addBytesAllocated(residentBytes + numBuffers * file.getMaxBlockBytes());
+        }
+        PhaseStopwatch stopwatch(this->stats.get());
+
+        std::vector<uint32_t> const& outDegrees = file.getOutDegrees();
+        std::vector<double> ranks(size, 1.0 / size);
+        std::vector<double> contributions(size);
+        BlockPrefetcher prefetcher(file, numBuffers, this->numIoThreads);
+        stopwatch.lap("build");
+
+        std::vector<ThreadSlot<double>> differences(this->numThreads);
+        std::vector<ThreadSlot<double>> dangleSums(this->numThreads);
+        uint64_t sequence = 0;
+        for (uint32_t i = 1; i <= iterations; ++i) {
+            double iterationStart = this->stats ? this->stats->now() : 0.0;
+            this->pool->run([&](uint32_t thread) {
+                auto range = WorkerPool::range(size, thread, this->numThreads);
+                double dangleSum = 0.0;
+                for (size_t page = range.first; page < range.second; ++page) {
+                    if (outDegrees[page] == 0) {
+                        contributions[page] = 0.0;
+                        dangleSum += ranks[page];
+                    } else {
+                        contributions[page] = ranks[page] / outDegrees[page];
+                    }
+                }
+                dangleSums[thread].value = dangleSum;
+                differences[thread].value = 0.0;
+            });
+            double dangleSum = 0.0;
+            for (auto const& slot : dangleSums) {
+                dangleSum += slot.value;
+            }
+            double baseRank = (alpha * dangleSum + (1.0 - alpha)) / size;
+
+            for (uint32_t b = 0; b < numBlocks; ++b, ++sequence) {
+                BlockedEdgeFileBlock const& block = file.getBlocks()[b];
+                uint32_t const* offsets = prefetcher.acquire(sequence);
+                uint32_t const* sources = offsets + block.numPages + 1;
+                this->pool->run([&](uint32_t thread) {
+                    auto range = WorkerPool::range(block.numPages, thread, this->numThreads);
+                    double difference = 0.0;
+                    for (size_t page = range.first; page < range.second; ++page) {
+                        double sum = 0.0;
+                        for (uint32_t e = offsets[page]; e < offsets[page + 1]; ++e) {
+                            sum += contributions[sources[e]];
+                        }
+                        double& rank = ranks[block.firstPage + page];
+                        double next = baseRank + alpha * sum;
+                        difference += std::abs(next - rank);
+                        rank = next;
+                    }
+                    differences[thread].value += difference;
+                });
+                prefetcher.release(sequence);
+            }
+
+            double difference = 0.0;
+            for (auto const& slot : differences) {
+                difference += slot.value;
+            }
+            if (this->stats) {
+                this->stats->addIteration(iterationStart, this->stats->now(), difference);
+                this->stats->addEdgesProcessed(file.getNumEdges());
+            }
+            if (difference < tolerance) {
+                this->lastIterations = i;
+                this->lastIo.waitSeconds = prefetcher.getWaitSeconds();
+                this->lastIo.bytesRead = prefetcher.getBytesRead();
+                this->lastIo.numBuffers = numBuffers;
+                stopwatch.lap("iterations");
+                return ranks;
+            }
+        }
+
+        ASSERT(false, "Not able to find result in iterations=" << iterations);
+        return {};
+    }
+
+    std::string getName() const
+    {
+        return "ExternalPageRankComputer[" + std::to_string(this->numThreads) + ", " + std::to_string(this->numIoThreads) + " I/O]";
+    }
+
+    // Number of iterations the last computation needed to converge
+    uint32_t getLastIterations() const
+    {
+        return this->lastIterations;
+    }
+
+    // Seconds the last computation waited for blocks not read yet
+    double getLastIoWaitSeconds() const
+    {
+        return this->lastIo.waitSeconds;
+    }
+
+    // Bytes of blocks read by the last computation, including blocks read ahead
+    uint64_t getLastBytesRead() const
+    {
+        return this->lastIo.bytesRead;
+    }
+
+    // Number of block buffers the memory budget left room for in the last computation
+    uint32_t getLastNumBuffers() const
+    {
+        return this->lastIo.numBuffers;
+    }
+
+    // Every following computation fills the given stats object, nullptr stops the collection
+    void attachStats(std::shared_ptr<ComputationStats> statsArg)
+    {
+        this->stats = statsArg;
+    }
+
+private:
+    struct IoStatistics {
+        double waitSeconds = 0.0;
+        uint64_t bytesRead = 0;
+        uint32_t numBuffers = 0;
+    };
+
+    uint32_t const numThreads;
+    uint64_t const memoryBudget;
+    uint32_t const numIoThreads;
+    std::shared_ptr<WorkerPool> pool;
+    // Written by every computeForFile, which must not run concurrently on one computer
+    mutable uint32_t lastIterations;
+    mutable IoStatistics lastIo;
+    std::shared_ptr<ComputationStats> stats;
+};
+
+#endif /* SRC_EXTERNALPAGERANKCOMPUTER_HPP_ */
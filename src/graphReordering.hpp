@@ -0,0 +1,292 @@
+#ifndef SRC_GRAPHREORDERING_HPP_
+#define SRC_GRAPHREORDERING_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "immutable/common.hpp"
+
+#include "csrGraph.hpp"
+
+enum class ReorderStrategy {
+    None,
+    InDegree, // pages with most in-links first
+    ReverseCuthillMcKee, // bandwidth reduction of the undirected graph
+    CacheWindow // greedy (Gorder-like) placement of pages sharing in-neighbours next to each other
+};
+
+// Computes locality-improving orders of the pages of a graph. An order lists
+// the current page indices in their new order: order[newIndex] = oldIndex.
+class GraphReordering {
+public:
+    static std::vector<uint32_t> computeOrder(CsrGraph const& graph, ReorderStrategy strategy)
+    {
+        switch (strategy) {
+        case ReorderStrategy::InDegree:
+            return inDegreeOrder(graph);
+        case ReorderStrategy::ReverseCuthillMcKee:
+            return reverseCuthillMcKeeOrder(graph);
+        case ReorderStrategy::CacheWindow:
+            return cacheWindowOrder(graph);
+        case ReorderStrategy::None:
+            break;
+        }
+
+        std::vector<uint32_t> order(graph.size);
+        for (uint32_t page = 0; page < graph.size; ++page) {
+            order[page] = page;
+        }
+        return order;
+    }
+
+    static std::string getName(ReorderStrategy strategy)
+    {
+        static char const* names[] = { "none", "in-degree", "rcm", "cache-window" };
+        return names[static_cast<int>(strategy)];
+    }
+
+private:
+    // Number of most recently placed pages the cache window order scores candidates against
+    static uint32_t const windowSize = 5;
+
+    // Pages with positive scores in doubly linked lists, one per score value.
+    // Scores change by one, so every update and finding the maximum take O(1)
+    // amortized (the "unit heap" of Gorder).
+    class ScoreBuckets {
+    public:
+        enum : uint32_t {
+            none = UINT32_MAX
+        };
+
+        ScoreBuckets(uint32_t size)
+            : scores(size, 0)
+            , previous(size, none)
+            , next(size, none)
+            , heads(1, none)
+            , maxScore(0)
+        {
+        }
+
+        void update(uint32_t page, bool increase)
+        {
+            this->unlink(page);
+            if (increase) {
+                this->scores[page]++;
+            } else {
+                this->scores[page]--;
+            }
+            this->link(page);
+        }
+
+        void remove(uint32_t page)
+        {
+            this->unlink(page);
+            this->scores[page] = 0;
+        }
+
+        // Page with the highest positive score, none when all scores are zero
+        uint32_t getMax()
+        {
+            while (this->maxScore > 0 && this->heads[this->maxScore] == none) {
+                this->maxScore--;
+            }
+            return this->heads[this->maxScore];
+        }
+
+    private:
+        std::vector<uint32_t> scores;
+        std::vector<uint32_t> previous;
+        std::vector<uint32_t> next;
+        std::vector<uint32_t> heads; // heads[0] is always none
+        uint32_t maxScore;
+
+        void link(uint32_t page)
+        {
+            uint32_t score = this->scores[page];
+            if (score == 0) {
+                return;
+            }
+            if (score >= this->heads.size()) {
+                this->heads.resize(score + 1, none);
+            }
+            this->previous[page] = none;
+            this->next[page] = this->heads[score];
+            if (this->heads[score] != none) {
+                this->previous[this->heads[score]] = page;
+            }
+            this->heads[score] = page;
+            this->maxScore = std::max(this->maxScore, score);
+        }
+
+        void unlink(uint32_t page)
+        {
+            if (this->scores[page] == 0) {
+                return;
+            }
+            if (this->previous[page] != none) {
+                this->next[this->previous[page]] = this->next[page];
+            } else {
+                this->heads[this->scores[page]] = this->next[page];
+            }
+            if (this->next[page] != none) {
+                this->previous[this->next[page]] = this->previous[page];
+            }
+        }
+    };
+
+    // Forward (page -> link targets) CSR of the graph
+    struct OutEdges {
+        std::vector<uint64_t> offsets;
+        std::vector<uint32_t> targets;
+    };
+
+    static uint64_t inDegree(CsrGraph const& graph, uint32_t page)
+    {
+        return graph.offsets[page + 1] - graph.offsets[page];
+    }
+
+    static OutEdges buildOutEdges(CsrGraph const& graph)
+    {
+        OutEdges out;
+        out.offsets.assign(graph.size + 1, 0);
+        for (uint64_t e = 0; e < graph.numEdges; ++e) {
+            out.offsets[graph.sources[e] + 1]++;
+        }
+        for (uint32_t page = 0; page < graph.size; ++page) {
+            out.offsets[page + 1] += out.offsets[page];
+        }
+
+        std::vector<uint64_t> position(out.offsets.begin(), out.offsets.end() - 1);
+        out.targets.resize(graph.numEdges);
+        for (uint32_t page = 0; page < graph.size; ++page) {
+            for (uint64_t e = graph.offsets[page]; e < graph.offsets[page + 1]; ++e) {
+                out.targets[position[graph.sources[e]]++] = page;
+            }
+        }
+        return out;
+    }
+
+    static std::vector<uint32_t> inDegreeOrder(CsrGraph const& graph)
+    {
+        std::vector<uint32_t> order = computeOrder(graph, ReorderStrategy::None);
+        std::stable_sort(order.begin(), order.end(), [&graph](uint32_t a, uint32_t b) {
+            return inDegree(graph, a) > inDegree(graph, b);
+        });
+        return order;
+    }
+
+    static std::vector<uint32_t> reverseCuthillMcKeeOrder(CsrGraph const& graph)
+    {
+        OutEdges out = buildOutEdges(graph);
+        std::vector<uint64_t> degrees(graph.size);
+        for (uint32_t page = 0; page < graph.size; ++page) {
+            degrees[page] = inDegree(graph, page) + out.offsets[page + 1] - out.offsets[page];
+        }
+        auto byDegree = [&degrees](uint32_t a, uint32_t b) {
+            return degrees[a] < degrees[b] || (degrees[a] == degrees[b] && a < b);
+        };
+
+        // Every connected component is traversed from its unvisited page of the lowest degree
+        std::vector<uint32_t> starts = computeOrder(graph, ReorderStrategy::None);
+        std::sort(starts.begin(), starts.end(), byDegree);
+
+        std::vector<uint32_t> order;
+        order.reserve(graph.size);
+        std::vector<bool> visited(graph.size, false);
+        std::vector<uint32_t> neighbours;
+        for (uint32_t start : starts) {
+            if (visited[start]) {
+                continue;
+            }
+            visited[start] = true;
+            order.push_back(start);
+
+            for (size_t next = order.size() - 1; next < order.size(); ++next) {
+                uint32_t page = order[next];
+                neighbours.clear();
+                for (uint64_t e = graph.offsets[page]; e < graph.offsets[page + 1]; ++e) {
+                    if (not visited[graph.sources[e]]) {
+                        visited[graph.sources[e]] = true;
+                        neighbours.push_back(graph.sources[e]);
+                    }
+                }
+                for (uint64_t e = out.offsets[page]; e < out.offsets[page + 1]; ++e) {
+                    if (not visited[out.targets[e]]) {
+                        visited[out.targets[e]] = true;
+                        neighbours.push_back(out.targets[e]);
+                    }
+                }
+                std::sort(neighbours.begin(), neighbours.end(), byDegree);
+                order.insert(order.end(), neighbours.begin(), neighbours.end());
+            }
+        }
+
+        std::reverse(order.begin(), order.end());
+        return order;
+    }
+
+    // Greedy variant of Gorder: the next page is the one with the highest score
+    // against the last windowSize placed pages, where a pair scores for every
+    // link between the pages and for every in-neighbour they share. Shared
+    // in-neighbours of hubs (out-degree above sqrt(size)) are not counted, they
+    // dominate the cost and stay in cache anyway.
+    static std::vector<uint32_t> cacheWindowOrder(CsrGraph const& graph)
+    {
+        OutEdges out = buildOutEdges(graph);
+        uint64_t maxSiblingSourceDegree = static_cast<uint64_t>(std::sqrt(static_cast<double>(graph.size))) + 1;
+
+        ScoreBuckets scores(graph.size);
+        std::vector<bool> placed(graph.size, false);
+
+        auto bump = [&](uint32_t page, bool increase) {
+            if (not placed[page]) {
+                scores.update(page, increase);
+            }
+        };
+        auto updateScores = [&](uint32_t page, bool increase) {
+            for (uint64_t e = out.offsets[page]; e < out.offsets[page + 1]; ++e) {
+                bump(out.targets[e], increase);
+            }
+            for (uint64_t e = graph.offsets[page]; e < graph.offsets[page + 1]; ++e) {
+                uint32_t source = graph.sources[e];
+                bump(source, increase);
+                if (out.offsets[source + 1] - out.offsets[source] <= maxSiblingSourceDegree) {
+                    for (uint64_t s = out.offsets[source]; s < out.offsets[source + 1]; ++s) {
+                        bump(out.targets[s], increase);
+                    }
+                }
+            }
+        };
+
+        // Used when no page is related to the window, hubs first
+        std::vector<uint32_t> fallback = inDegreeOrder(graph);
+        size_t nextFallback = 0;
+
+        std::vector<uint32_t> order;
+        order.reserve(graph.size);
+        while (order.size() < graph.size) {
+            uint32_t page = scores.getMax();
+            if (page == ScoreBuckets::none) {
+                while (placed[fallback[nextFallback]]) {
+                    nextFallback++;
+                }
+                page = fallback[nextFallback];
+            }
+
+            placed[page] = true;
+            scores.remove(page);
+            order.push_back(page);
+            updateScores(page, true);
+            if (order.size() > windowSize) {
+                updateScores(order[order.size() - windowSize - 1], false);
+            }
+        }
+        return order;
+    }
+};
+
+#endif /* SRC_GRAPHREORDERING_HPP_ */
@@ -2,13 +2,61 @@
 #define SRC_IMMUTABLE_IDGENERATOR_HPP_
 
 #include <string>
+#include <vector>
 
 #include "pageId.hpp"
 
+// Content of a page, not owned.
+class PageContent {
+public:
+    PageContent(char const* dataArg, size_t sizeArg)
+        : first(dataArg)
+        , length(sizeArg)
+    {
+    }
+
+    char const* data() const
+    {
+        return this->first;
+    }
+
+    size_t size() const
+    {
+        return this->length;
+    }
+
+private:
+    char const* first;
+    size_t length;
+};
+
 class IdGenerator {
 public:
     virtual PageId generateId(std::string const& content) const = 0;
 
+    // Batch entry point, generators able to hash many contents at once override it.
+    virtual std::vector<PageId> generateIds(std::vector<PageContent> const& contents) const
+    {
+        std::vector<PageId> result;
+        result.reserve(contents.size());
+        std::string buffer;
+        for (auto const& content : contents) {
+            buffer.assign(content.data(), content.size());
+            result.push_back(this->generateId(buffer));
+        }
+        return result;
+    }
+
+    std::vector<PageId> generateIds(std::vector<std::string const*> const& contents) const
+    {
+        std::vector<PageContent> views;
+        views.reserve(contents.size());
+        for (auto content : contents) {
+            views.push_back(PageContent(content->data(), content->size()));
+        }
+        return this->generateIds(views);
+    }
+
     virtual ~IdGenerator() {};
 };
 
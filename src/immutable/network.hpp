@@ -1,22 +1,64 @@
 #ifndef SRC_IMMUTABLE_NETWORK_HPP_
 #define SRC_IMMUTABLE_NETWORK_HPP_
 
+#include <utility>
 #include <vector>
 
 #include "common.hpp"
 #include "page.hpp"
+#include "pageArena.hpp"
 
 class Network {
 public:
     Network(IdGenerator const& idGeneratorArg)
-        : pages()
+        : arena()
+        , pages()
         , idGenerator(idGeneratorArg)
     {
     }
 
+    // Copies share the contents and links of the pages.
+    Network(Network const& other)
+        : arena(other.arena)
+        , pages()
+        , idGenerator(other.idGenerator)
+    {
+        this->pages.reserve(other.pages.size());
+        for (auto const& page : other.pages) {
+            this->pages.push_back(Page(page.content, page.contentSize, page.links, page.numLinks));
+            this->pages.back().id = page.id;
+            this->pages.back().isIdComputed = page.isIdComputed;
+        }
+    }
+
+    Network(Network&&) = default;
+
+    // The content and links of the page are copied into the arena of the network.
     void addPage(Page const& page)
     {
-        this->pages.push_back(page);
+        this->pages.push_back(this->arena.addPage(page));
+    }
+
+    // Moving would not avoid the copy, pages keep their own storage until copied into the arena
+    void addPage(Page&& page) = delete;
+
+    // Adds a page without building a Page first, content and links are copied.
+    void addPage(char const* content, size_t contentSize, PageId const* links, size_t numLinks)
+    {
+        this->pages.push_back(this->arena.addPage(content, contentSize, links, numLinks));
+    }
+
+    // Adds pages viewing the given arena, which the network takes over.
+    void addPages(PageArena&& pagesArena, std::vector<Page>&& arenaPages)
+    {
+        this->arena.adopt(std::move(pagesArena));
+        this->pages.insert(this->pages.end(), std::make_move_iterator(arenaPages.begin()), std::make_move_iterator(arenaPages.end()));
+        arenaPages.clear();
+    }
+
+    void reserve(size_t numPages)
+    {
+        this->pages.reserve(numPages);
     }
 
     size_t getSize() const
@@ -34,7 +76,26 @@ public:
         return this->idGenerator;
     }
 
+    // Generates ids of pages in [start, end) with a single batch call to the generator.
+    void generateIds(size_t start, size_t end) const
+    {
+        std::vector<PageContent> contents;
+        contents.reserve(end - start);
+        for (size_t i = start; i < end; ++i) {
+            ASSERT(not this->pages[i].isIdComputed, "Generating id twice");
+            contents.push_back(this->pages[i].getContent());
+        }
+
+        std::vector<PageId> ids = this->idGenerator.generateIds(contents);
+        ASSERT(ids.size() == contents.size(), "Invalid number of generated ids=" << ids.size());
+        for (size_t i = start; i < end; ++i) {
+            this->pages[i].id = ids[i - start];
+            this->pages[i].isIdComputed = true;
+        }
+    }
+
 private:
+    PageArena arena;
     std::vector<Page> pages;
     IdGenerator const& idGenerator;
 
@@ -1,8 +1,12 @@
 #ifndef SRC_IMMUTABLE_PAGE_HPP_
 #define SRC_IMMUTABLE_PAGE_HPP_
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -10,20 +14,115 @@
 #include "idGenerator.hpp"
 #include "pageId.hpp"
 
+// Read-only range of link ids of a page.
+class PageLinks {
+public:
+    PageLinks(PageId const* firstArg, size_t sizeArg)
+        : first(firstArg)
+        , count(sizeArg)
+    {
+    }
+
+    PageId const* begin() const
+    {
+        return this->first;
+    }
+
+    PageId const* end() const
+    {
+        return this->first + this->count;
+    }
+
+    size_t size() const
+    {
+        return this->count;
+    }
+
+    bool empty() const
+    {
+        return this->count == 0;
+    }
+
+    PageId const& operator[](size_t index) const
+    {
+        return this->first[index];
+    }
+
+    bool operator==(PageLinks const& other) const
+    {
+        return this->count == other.count && std::equal(this->begin(), this->end(), other.begin());
+    }
+
+private:
+    PageId const* first;
+    size_t count;
+};
+
+// A page either owns its content and links (one allocation, links first) or,
+// when it belongs to a network, views them in the arena of the network.
 class Page {
 public:
     Page(std::string const& contentArg)
-        : id("")
+        : id()
+        , storage()
+        , content(nullptr)
+        , links(nullptr)
+        , contentSize(static_cast<uint32_t>(contentArg.size()))
+        , numLinks(0)
+        , linksCapacity(0)
         , isIdComputed(false)
-        , content(contentArg)
-        , links()
     {
+        this->allocate(0);
+        std::memcpy(this->mutableContent(), contentArg.data(), contentArg.size());
+    }
+
+    Page(Page const& other)
+        : id(other.id)
+        , storage()
+        , content(nullptr)
+        , links(nullptr)
+        , contentSize(other.contentSize)
+        , numLinks(other.numLinks)
+        , linksCapacity(0)
+        , isIdComputed(other.isIdComputed)
+    {
+        this->allocate(other.numLinks);
+        std::copy(other.links, other.links + other.numLinks, this->mutableLinks());
+        std::memcpy(this->mutableContent(), other.content, other.contentSize);
+    }
+
+    Page(Page&& other)
+        : id(other.id)
+        , storage(std::move(other.storage))
+        , content(other.content)
+        , links(other.links)
+        , contentSize(other.contentSize)
+        , numLinks(other.numLinks)
+        , linksCapacity(other.linksCapacity)
+        , isIdComputed(other.isIdComputed)
+    {
+        other.content = nullptr;
+        other.links = nullptr;
+        other.contentSize = other.numLinks = other.linksCapacity = 0;
+    }
+
+    Page& operator=(Page other)
+    {
+        std::swap(this->id, other.id);
+        std::swap(this->storage, other.storage);
+        std::swap(this->content, other.content);
+        std::swap(this->links, other.links);
+        std::swap(this->contentSize, other.contentSize);
+        std::swap(this->numLinks, other.numLinks);
+        std::swap(this->linksCapacity, other.linksCapacity);
+        std::swap(this->isIdComputed, other.isIdComputed);
+        return *this;
     }
 
     void generateId(IdGenerator const& idGenerator) const
     {
         ASSERT(not this->isIdComputed, "Generating id twice");
-        this->id = idGenerator.generateId(this->content);
+        this->id = idGenerator.generateId(std::string(this->content, this->contentSize));
         this->isIdComputed = true;
     }
 
@@ -35,33 +134,101 @@ public:
 
     void addLink(PageId const& link)
     {
-        this->links.push_back(link);
+        this->addLinks(&link, &link + 1);
     }
 
-    std::vector<PageId> const& getLinks() const
+    template <typename Iterator>
+    void addLinks(Iterator first, Iterator last)
     {
-        return this->links;
+        size_t added = std::distance(first, last);
+        if (this->numLinks + added > this->linksCapacity) {
+            this->allocate(std::max<size_t>({ this->numLinks + added, 2 * this->linksCapacity, minLinksCapacity }));
+        }
+        std::copy(first, last, this->mutableLinks() + this->numLinks);
+        this->numLinks += static_cast<uint32_t>(added);
+    }
+
+    PageLinks getLinks() const
+    {
+        return PageLinks(this->links, this->numLinks);
+    }
+
+    PageContent getContent() const
+    {
+        return PageContent(this->content, this->contentSize);
     }
 
 private:
+    enum : size_t { minLinksCapacity = 4 };
+
     mutable PageId id;
+    std::unique_ptr<PageId[]> storage; // Owned links and content, empty for pages viewing an arena
+    char const* content;
+    PageId const* links;
+    uint32_t contentSize;
+    uint32_t numLinks;
+    uint32_t linksCapacity;
     mutable bool isIdComputed; // No std::optional in C++14
 
-    std::string content;
-    std::vector<PageId> links;
+    // Page viewing content and links kept alive by its owner
+    Page(char const* contentArg, uint32_t contentSizeArg, PageId const* linksArg, uint32_t numLinksArg)
+        : id()
+        , storage()
+        , content(contentArg)
+        , links(linksArg)
+        , contentSize(contentSizeArg)
+        , numLinks(numLinksArg)
+        , linksCapacity(0)
+        , isIdComputed(false)
+    {
+    }
+
+    PageId* mutableLinks()
+    {
+        return this->storage.get();
+    }
+
+    char* mutableContent()
+    {
+        return reinterpret_cast<char*>(this->storage.get() + this->linksCapacity);
+    }
+
+    // Moves the links and the content into owned storage with room for the given number of links
+    void allocate(size_t capacity)
+    {
+        size_t contentIds = (this->contentSize + sizeof(PageId) - 1) / sizeof(PageId);
+        std::unique_ptr<PageId[]> allocated(new PageId[capacity + contentIds]);
+        char* allocatedContent = reinterpret_cast<char*>(allocated.get() + capacity);
+        if (this->content != nullptr) {
+            std::copy(this->links, this->links + this->numLinks, allocated.get());
+            std::memcpy(allocatedContent, this->content, this->contentSize);
+        }
+        this->storage = std::move(allocated);
+        this->links = this->storage.get();
+        this->content = allocatedContent;
+        this->linksCapacity = static_cast<uint32_t>(capacity);
+    }
 
     friend std::ostream& operator<<(std::ostream& out, Page const& page);
+    friend class Network;
+    friend class PageArena;
 };
 
 std::ostream& operator<<(std::ostream& out, Page const& page)
 {
     out << "(";
-    out << (page.isIdComputed ? page.id : std::string("NO_ID"));
+    if (page.isIdComputed) {
+        out << page.id;
+    } else {
+        out << "NO_ID";
+    }
 
-    out << ", \"" << page.content << "\"";
+    out << ", \"";
+    out.write(page.content, page.contentSize);
+    out << "\"";
 
     out << ", [";
-    printContainer(out, page.links);
+    printContainer(out, page.getLinks());
     out << "])";
 
     return out;
@@ -0,0 +1,136 @@
+#ifndef SRC_IMMUTABLE_PAGEARENA_HPP_
+#define SRC_IMMUTABLE_PAGEARENA_HPP_
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "common.hpp"
+#include "page.hpp"
+
+// Append-only storage of contents and link ids of the pages of a network.
+// Pages are bump allocated from blocks of growing size and created as views
+// of the arena, so a page costs no allocation of its own. Blocks are shared
+// by copies of the arena and freed with the last of them, a copy never writes
+// into the blocks it shares.
+class PageArena {
+public:
+    PageArena()
+        : blocks()
+        , position(nullptr)
+        , remaining(0)
+        , nextBlockSize(minBlockSize)
+        , allocatedBytes(0)
+    {
+    }
+
+    PageArena(PageArena const& other)
+        : blocks(other.blocks)
+        , position(nullptr)
+        , remaining(0)
+        , nextBlockSize(minBlockSize)
+        , allocatedBytes(other.allocatedBytes)
+    {
+    }
+
+    PageArena(PageArena&& other)
+        : blocks(std::move(other.blocks))
+        , position(other.position)
+        , remaining(other.remaining)
+        , nextBlockSize(other.nextBlockSize)
+        , allocatedBytes(other.allocatedBytes)
+    {
+        other.position = nullptr;
+        other.remaining = 0;
+        other.allocatedBytes = 0;
+    }
+
+    // Copies content and links into the arena, the returned page views them.
+    Page addPage(char const* content, size_t contentSize, PageId const* links, size_t numLinks)
+    {
+        char* bytes = this->allocate(numLinks * sizeof(PageId) + contentSize);
+        PageId* pageLinks = reinterpret_cast<PageId*>(bytes);
+        std::copy(links, links + numLinks, pageLinks);
+        char* pageContent = bytes + numLinks * sizeof(PageId);
+        std::memcpy(pageContent, content, contentSize);
+        return Page(pageContent, static_cast<uint32_t>(contentSize), pageLinks, static_cast<uint32_t>(numLinks));
+    }
+
+    // Room for the links of a page being parsed, the caller writes at most maxLinks
+    // of them and then adds the page with commitPage.
+    PageId* beginPage(size_t maxLinks, size_t contentSize)
+    {
+        this->ensure(maxLinks * sizeof(PageId) + contentSize);
+        return reinterpret_cast<PageId*>(this->position);
+    }
+
+    // Adds the page started by beginPage with the first numLinks links written there.
+    Page commitPage(size_t numLinks, char const* content, size_t contentSize)
+    {
+        char* bytes = this->allocate(numLinks * sizeof(PageId) + contentSize);
+        char* pageContent = bytes + numLinks * sizeof(PageId);
+        std::memcpy(pageContent, content, contentSize);
+        return Page(pageContent, static_cast<uint32_t>(contentSize), reinterpret_cast<PageId const*>(bytes), static_cast<uint32_t>(numLinks));
+    }
+
+    Page addPage(Page const& page)
+    {
+        Page result = this->addPage(page.content, page.contentSize, page.links, page.numLinks);
+        result.id = page.id;
+        result.isIdComputed = page.isIdComputed;
+        return result;
+    }
+
+    // Takes over the blocks of another arena, pages viewing them stay valid.
+    void adopt(PageArena&& other)
+    {
+        this->blocks.insert(this->blocks.end(), other.blocks.begin(), other.blocks.end());
+        this->allocatedBytes += other.allocatedBytes;
+        other.blocks.clear();
+        other.position = nullptr;
+        other.remaining = 0;
+        other.allocatedBytes = 0;
+    }
+
+    size_t getAllocatedBytes() const
+    {
+        return this->allocatedBytes;
+    }
+
+private:
+    enum : size_t {
+        minBlockSize = 64 << 10,
+        maxBlockSize = 16 << 20
+    };
+
+    std::vector<std::shared_ptr<char>> blocks;
+    char* position;
+    size_t remaining;
+    size_t nextBlockSize;
+    size_t allocatedBytes;
+
+    char* allocate(size_t size)
+    {
+        this->ensure(size);
+        char* result = this->position;
+        this->position += size;
+        this->remaining -= size;
+        return result;
+    }
+
+    // Starts a new block unless the current one has room for the given size
+    void ensure(size_t size)
+    {
+        if (size > this->remaining) {
+            size_t blockSize = std::max<size_t>(size, this->nextBlockSize);
+            this->nextBlockSize = std::min<size_t>(2 * this->nextBlockSize, maxBlockSize);
+            this->blocks.push_back(std::shared_ptr<char>(new char[blockSize], std::default_delete<char[]>()));
+            this->position = this->blocks.back().get();
+            this->remaining = blockSize;
+            this->allocatedBytes += blockSize;
+        }
+    }
+};
+
+#endif /* SRC_IMMUTABLE_PAGEARENA_HPP_ */
@@ -1,22 +1,149 @@
 #ifndef PAGE_ID_HPP_
 #define PAGE_ID_HPP_
 
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
 #include <string>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "common.hpp"
+
+// 256-bit page id (a SHA-256 digest) kept in binary form. Hex text is only
+// parsed and produced at the I/O boundaries.
 class PageId {
 public:
+    static size_t const numBytes = 32;
+    static size_t const hexLength = 2 * numBytes;
+
+    PageId()
+        : id()
+    {
+    }
+
     PageId(std::string const& idArg)
-        : id(idArg)
+        : PageId(idArg.data(), idArg.size())
+    {
+    }
+
+    PageId(char const* hex, size_t length)
+        : id()
+    {
+        ASSERT(length == hexLength && parseHex(hex, this->id.data()),
+            "Invalid PageId, expected " << hexLength << " hex digits, got=" << std::string(hex, length));
+    }
+
+    static PageId fromBytes(uint8_t const* bytes)
     {
+        PageId pageId;
+        std::memcpy(pageId.id.data(), bytes, numBytes);
+        return pageId;
     }
 
     bool operator==(PageId const& other) const
     {
-        return this->id == other.id;
+        return std::memcmp(this->id.data(), other.id.data(), numBytes) == 0;
+    }
+
+    std::array<uint8_t, numBytes> const& getBytes() const
+    {
+        return this->id;
+    }
+
+    std::string toHex() const
+    {
+        std::string result(hexLength, '0');
+        formatHex(this->id.data(), &result[0]);
+        return result;
     }
 
 private:
-    std::string id;
+    std::array<uint8_t, numBytes> id;
+
+    static bool parseHex(char const* hex, uint8_t* bytes)
+    {
+#ifdef __SSE2__
+        // 16 hex digits -> 8 bytes per step
+        for (size_t step = 0; step < hexLength / 16; ++step) {
+            __m128i text = _mm_loadu_si128(reinterpret_cast<__m128i const*>(hex + 16 * step));
+            __m128i lower = _mm_or_si128(text, _mm_set1_epi8(0x20));
+
+            __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(text, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(text, _mm_set1_epi8('9' + 1)));
+            __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+            if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xffff) {
+                return false;
+            }
+
+            __m128i nibbles = _mm_or_si128(
+                _mm_and_si128(isDigit, _mm_sub_epi8(text, _mm_set1_epi8('0'))),
+                _mm_andnot_si128(isDigit, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+
+            // Each 16-bit lane holds (high digit, low digit), merge them into one byte
+            __m128i high = _mm_and_si128(_mm_slli_epi16(nibbles, 4), _mm_set1_epi16(0x00f0));
+            __m128i low = _mm_srli_epi16(nibbles, 8);
+            __m128i packed = _mm_packus_epi16(_mm_or_si128(high, low), _mm_setzero_si128());
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(bytes + 8 * step), packed);
+        }
+        return true;
+#else
+        for (size_t i = 0; i < numBytes; ++i) {
+            int high = hexValue(hex[2 * i]);
+            int low = hexValue(hex[2 * i + 1]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            bytes[i] = static_cast<uint8_t>(high << 4 | low);
+        }
+        return true;
+#endif
+    }
+
+    static void formatHex(uint8_t const* bytes, char* hex)
+    {
+#ifdef __SSE2__
+        // 16 bytes -> 32 hex digits per step
+        for (size_t step = 0; step < numBytes / 16; ++step) {
+            __m128i data = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bytes + 16 * step));
+            __m128i high = _mm_and_si128(_mm_srli_epi16(data, 4), _mm_set1_epi8(0x0f));
+            __m128i low = _mm_and_si128(data, _mm_set1_epi8(0x0f));
+
+            // '0' + nibble, plus the distance between '9' + 1 and 'a' for letters
+            __m128i highChars = _mm_add_epi8(_mm_add_epi8(high, _mm_set1_epi8('0')),
+                _mm_and_si128(_mm_cmpgt_epi8(high, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '9' - 1)));
+            __m128i lowChars = _mm_add_epi8(_mm_add_epi8(low, _mm_set1_epi8('0')),
+                _mm_and_si128(_mm_cmpgt_epi8(low, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '9' - 1)));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(hex + 32 * step), _mm_unpacklo_epi8(highChars, lowChars));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(hex + 32 * step + 16), _mm_unpackhi_epi8(highChars, lowChars));
+        }
+#else
+        static char const* digits = "0123456789abcdef";
+        for (size_t i = 0; i < numBytes; ++i) {
+            hex[2 * i] = digits[bytes[i] >> 4];
+            hex[2 * i + 1] = digits[bytes[i] & 0xf];
+        }
+#endif
+    }
+
+#ifndef __SSE2__
+    static int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+#endif
 
     friend std::ostream& operator<<(std::ostream& out, PageId const& pageId);
 
@@ -29,13 +156,19 @@ class PageIdHash {
 public:
     std::size_t operator()(PageId const& pageId) const
     {
-        return std::hash<std::string> {}(pageId.id);
+        // Fold the digest into one word and mix it, ids made by test generators are not uniformly distributed
+        uint64_t words[4];
+        std::memcpy(words, pageId.id.data(), PageId::numBytes);
+        uint64_t folded = words[0] ^ words[1] ^ words[2] ^ words[3];
+        return static_cast<std::size_t>((folded ^ (folded >> 29)) * 0x9e3779b97f4a7c15ull);
     };
 };
 
 std::ostream& operator<<(std::ostream& out, PageId const& pageId)
 {
-    out << pageId.id;
+    char hex[PageId::hexLength];
+    PageId::formatHex(pageId.id.data(), hex);
+    out.write(hex, PageId::hexLength);
     return out;
 }
 
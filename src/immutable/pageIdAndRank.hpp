@@ -20,6 +20,16 @@ public:
     {
     }
 
+    PageId const& getPageId() const
+    {
+        return this->pageId;
+    }
+
+    PageRank getPageRank() const
+    {
+        return this->pageRank;
+    }
+
 private:
     PageId pageId;
     PageRank pageRank;
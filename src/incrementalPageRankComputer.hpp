@@ -0,0 +1,576 @@
+#ifndef SRC_INCREMENTALPAGERANKCOMPUTER_HPP_
+#define SRC_INCREMENTALPAGERANKCOMPUTER_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "immutable/network.hpp"
+#include "immutable/pageIdAndRank.hpp"
+#include "immutable/pageRankComputer.hpp"
+
+#include "networkDelta.hpp"
+#include "pageIdMap.hpp"
+
+// PageRank that can be updated after small changes of the network.
+//
+// The PageRank vector is a scaled solution of the dangling-free system
+// s = alpha * A * s + 1 (A[w][v] = 1 / outDegree(v) for a link v -> w):
+// rank = u * s with u = (1 - alpha) / (n - alpha * sum of s over dangling pages).
+// s has no global terms, so it is solved with local residual pushes
+// (Gauss-Southwell). After a delta, only residuals of pages around the
+// changed links are non-zero, and pushing them costs time proportional to the
+// affected region rather than to the whole graph.
+//
+// The computer keeps the graph and s between calls: updateForNetwork applies
+// a delta to the network of the previous computeForNetwork/updateForNetwork call.
+class IncrementalPageRankComputer : public PageRankComputer {
+public:
+    class View;
+
+    IncrementalPageRankComputer()
+        : state(new State()) {};
+
+    // A copy running on the same state would invalidate the views of the original
+    IncrementalPageRankComputer(IncrementalPageRankComputer const&) = delete;
+    IncrementalPageRankComputer& operator=(IncrementalPageRankComputer const&) = delete;
+
+    std::vector<PageIdAndRank> computeForNetwork(Network const& network, double alpha, uint32_t iterations, double tolerance) const
+    {
+        return this->computeViewForNetwork(network, alpha, iterations, tolerance).toVector();
+    }
+
+    View computeViewForNetwork(Network const& network, double alpha, uint32_t iterations, double tolerance) const
+    {
+        network.generateIds(0, network.getSize());
+
+        State& state = *this->state;
+        uint64_t epoch = state.epoch;
+        state = State();
+        state.epoch = epoch + 1;
+        state.alpha = alpha;
+        state.ids.reserve(network.getSize());
+
+        for (auto const& page : network.getPages()) {
+            state.addPage(page.getId(), page.getLinks());
+        }
+        for (uint32_t page = 0; page < state.pages.size(); ++page) {
+            if (state.alive[page]) {
+                state.resolvePendingLinks(page, nullptr);
+                state.addContributions(page);
+            }
+        }
+
+        this->solve(iterations, tolerance);
+        return View(this->state);
+    }
+
+    // previousResult is the result of the last run (possibly persisted and
+    // loaded back); ranks that differ from the computer's own state are
+    // re-seeded from it and their difference is propagated. Reading and
+    // returning all ranks costs time proportional to the network, updateView
+    // does not.
+    std::vector<PageIdAndRank> updateForNetwork(std::vector<PageIdAndRank> const& previousResult, NetworkDelta const& delta, double alpha, uint32_t iterations, double tolerance) const
+    {
+        State& state = *this->state;
+        ASSERT(state.alpha == alpha, "Incremental update needs the alpha of the previous run, previous=" << state.alpha << ", alpha=" << alpha);
+        state.beginUpdate();
+        state.warmStart(previousResult);
+        this->applyDelta(delta);
+        this->solve(iterations, tolerance);
+        return View(this->state).toVector();
+    }
+
+    // Update of the view returned by the last run of this computer: its ranks are
+    // the computer's own state, so nothing is re-seeded and the work is
+    // proportional to the delta and to the pages it affects.
+    View updateView(View const& previous, NetworkDelta const& delta, double alpha, uint32_t iterations, double tolerance) const
+    {
+        State& state = *this->state;
+        ASSERT(previous.state == this->state && previous.epoch == state.epoch, "View of epoch=" << previous.epoch << " is not the last result of the computer");
+        ASSERT(state.alpha == alpha, "Incremental update needs the alpha of the previous run, previous=" << state.alpha << ", alpha=" << alpha);
+        state.beginUpdate();
+        this->applyDelta(delta);
+        this->solve(iterations, tolerance);
+        return View(this->state);
+    }
+
+    std::string getName() const
+    {
+        return "IncrementalPageRankComputer";
+    }
+
+    // Number of residual pushes made by the last run
+    uint64_t getLastNumPushes() const
+    {
+        return this->state->numPushes;
+    }
+
+private:
+    struct State {
+        double alpha = 0.0;
+
+        // Every id seen, of pages and of targets of links, has an index. Ids are
+        // never erased: a removed page keeps its index and is no longer alive, a
+        // page added again gets its old index back.
+        PageIdMap ids { 0 };
+        std::vector<PageId> pages;
+        std::vector<bool> alive;
+        std::vector<bool> touched;
+        std::vector<std::vector<uint32_t>> links; // all links, by index of the target
+        std::vector<std::vector<uint32_t>> outTargets; // links to pages of the network
+        std::vector<std::vector<uint32_t>> inSources;
+        // Sources of links to an id while it is not a page of the network
+        std::vector<std::vector<uint32_t>> pendingSources;
+
+        std::vector<double> solution; // s
+        std::vector<double> residuals; // 1 + alpha * A * s - s
+        double residualSum = 0.0; // L1 norm of residuals
+        double danglingSum = 0.0; // sum of s over dangling pages
+        uint32_t numAlive = 0;
+
+        std::vector<uint32_t> active; // pages that may have a residual above the push threshold
+        std::vector<bool> queued;
+        double threshold = 0.0; // residuals above it are queued in active
+        uint64_t numPushes = 0;
+
+        uint64_t epoch = 0; // number of the last run
+        std::vector<uint32_t> changed; // pages whose s changed in the last run
+        std::vector<bool> isChanged;
+
+        void beginUpdate()
+        {
+            this->epoch++;
+            for (uint32_t page : this->changed) {
+                this->isChanged[page] = false;
+            }
+            this->changed.clear();
+        }
+
+        double scale() const
+        {
+            return (1.0 - this->alpha) / (this->numAlive - this->alpha * this->danglingSum);
+        }
+
+        void addResidual(uint32_t page, double value)
+        {
+            double& residual = this->residuals[page];
+            this->residualSum += std::abs(residual + value) - std::abs(residual);
+            residual += value;
+            if (not this->queued[page] && std::abs(residual) > this->threshold) {
+                this->queued[page] = true;
+                this->active.push_back(page);
+            }
+        }
+
+        void push(uint32_t page)
+        {
+            double value = this->residuals[page];
+            this->numPushes++;
+            this->residualSum -= std::abs(value);
+            this->residuals[page] = 0.0;
+            this->addToSolution(page, value);
+        }
+
+        // Queues every page above the threshold and sums residuals again from scratch
+        void requeue()
+        {
+            this->residualSum = 0.0;
+            for (uint32_t page = 0; page < this->pages.size(); ++page) {
+                if (this->alive[page]) {
+                    this->residualSum += std::abs(this->residuals[page]);
+                    if (not this->queued[page] && std::abs(this->residuals[page]) > this->threshold) {
+                        this->queued[page] = true;
+                        this->active.push_back(page);
+                    }
+                }
+            }
+        }
+
+        // Changes s of the page by value and updates residuals of its out-neighbours
+        void addToSolution(uint32_t page, double value)
+        {
+            this->solution[page] += value;
+            if (not this->isChanged[page]) {
+                this->isChanged[page] = true;
+                this->changed.push_back(page);
+            }
+            if (this->links[page].empty()) {
+                this->danglingSum += value;
+                return;
+            }
+            double share = this->alpha * value / this->links[page].size();
+            for (uint32_t target : this->outTargets[page]) {
+                this->addResidual(target, share);
+            }
+        }
+
+        void addContributions(uint32_t page)
+        {
+            this->addContributions(page, 1.0);
+        }
+
+        void removeContributions(uint32_t page)
+        {
+            this->addContributions(page, -1.0);
+        }
+
+        void addContributions(uint32_t page, double sign)
+        {
+            double value = sign * this->solution[page];
+            if (this->links[page].empty()) {
+                this->danglingSum += value;
+                return;
+            }
+            double share = this->alpha * value / this->links[page].size();
+            for (uint32_t target : this->outTargets[page]) {
+                this->addResidual(target, share);
+            }
+        }
+
+        // Index of a page of the network, notFound for other ids
+        uint32_t findPage(PageId const& pageId) const
+        {
+            uint32_t index = this->ids.find(pageId);
+            return index != PageIdMap::notFound && this->alive[index] ? index : PageIdMap::notFound;
+        }
+
+        uint32_t intern(PageId const& pageId)
+        {
+            if (this->ids.getSize() == this->ids.getMaxSize()) {
+                this->ids.reserve(2 * this->ids.getMaxSize() + 16);
+            }
+            auto interned = this->ids.insertOrGet(pageId);
+            if (interned.second) {
+                this->pages.push_back(pageId);
+                this->alive.push_back(false);
+                this->touched.push_back(false);
+                this->links.push_back(std::vector<uint32_t>());
+                this->outTargets.push_back(std::vector<uint32_t>());
+                this->inSources.push_back(std::vector<uint32_t>());
+                this->pendingSources.push_back(std::vector<uint32_t>());
+                this->solution.push_back(0.0);
+                this->residuals.push_back(0.0);
+                this->queued.push_back(false);
+                this->isChanged.push_back(false);
+            }
+            return interned.first;
+        }
+
+        uint32_t addPage(PageId const& pageId, PageLinks const& pageLinks)
+        {
+            uint32_t index = this->intern(pageId);
+            ASSERT(not this->alive[index], "Page added twice: " << pageId);
+            this->alive[index] = true;
+            this->numAlive++;
+
+            for (auto const& link : pageLinks) {
+                this->addLink(index, link);
+            }
+            // Constant term of the equation, s is 0 so far
+            this->addResidual(index, 1.0);
+            return index;
+        }
+
+        // Turns links pointing to the page while it was not in the network into edges.
+        // Sources marked in skipContributions add their contributions later themselves.
+        void resolvePendingLinks(uint32_t page, std::vector<bool> const* skipContributions)
+        {
+            for (uint32_t source : this->pendingSources[page]) {
+                this->outTargets[source].push_back(page);
+                this->inSources[page].push_back(source);
+                if (skipContributions != nullptr && not(*skipContributions)[source]) {
+                    this->addResidual(page, this->alpha * this->solution[source] / this->links[source].size());
+                }
+            }
+            std::vector<uint32_t>().swap(this->pendingSources[page]);
+        }
+
+        void removePage(PageId const& pageId)
+        {
+            uint32_t page = this->findPage(pageId);
+            ASSERT(page != PageIdMap::notFound, "Removing unknown page: " << pageId);
+
+            while (not this->links[page].empty()) {
+                this->removeLink(page, this->links[page].back());
+            }
+            for (uint32_t source : this->inSources[page]) {
+                eraseOne(this->outTargets[source], page);
+                this->pendingSources[page].push_back(source);
+            }
+            std::vector<uint32_t>().swap(this->inSources[page]);
+
+            // Contributions of the page (and its share of the dangling sum) were retracted before
+            this->residualSum -= std::abs(this->residuals[page]);
+            this->residuals[page] = 0.0;
+            this->solution[page] = 0.0;
+            this->alive[page] = false;
+            this->numAlive--;
+        }
+
+        void addLink(PageId const& from, PageId const& to)
+        {
+            uint32_t page = this->findPage(from);
+            ASSERT(page != PageIdMap::notFound, "Adding link from unknown page: " << from);
+            this->addLink(page, to);
+        }
+
+        void addLink(uint32_t page, PageId const& to)
+        {
+            uint32_t target = this->intern(to);
+            this->links[page].push_back(target);
+            if (this->alive[target]) {
+                this->outTargets[page].push_back(target);
+                this->inSources[target].push_back(page);
+            } else {
+                this->pendingSources[target].push_back(page);
+            }
+        }
+
+        void removeLink(PageId const& from, PageId const& to)
+        {
+            uint32_t page = this->findPage(from);
+            ASSERT(page != PageIdMap::notFound, "Removing link from unknown page: " << from);
+            uint32_t target = this->ids.find(to);
+            ASSERT(target != PageIdMap::notFound, "Removing unknown link: " << from << " -> " << to);
+            this->removeLink(page, target);
+        }
+
+        void removeLink(uint32_t page, uint32_t target)
+        {
+            auto link = std::find(this->links[page].begin(), this->links[page].end(), target);
+            ASSERT(link != this->links[page].end(), "Removing unknown link: " << this->pages[page] << " -> " << this->pages[target]);
+            this->links[page].erase(link);
+
+            if (this->alive[target]) {
+                eraseOne(this->outTargets[page], target);
+                eraseOne(this->inSources[target], page);
+            } else {
+                eraseOne(this->pendingSources[target], page);
+            }
+        }
+
+        // Re-seeds s from ranks of the previous run: s = rank / u, with u computed
+        // from the previous ranks themselves.
+        void warmStart(std::vector<PageIdAndRank> const& previousResult)
+        {
+            ASSERT(previousResult.size() == this->numAlive, "Previous result size=" << previousResult.size() << " does not match the network size=" << this->numAlive);
+
+            std::vector<uint32_t> pageIndices;
+            pageIndices.reserve(previousResult.size());
+            double danglingRanks = 0.0;
+            for (auto const& pageIdAndRank : previousResult) {
+                uint32_t page = this->findPage(pageIdAndRank.getPageId());
+                ASSERT(page != PageIdMap::notFound, "Previous result contains unknown page: " << pageIdAndRank.getPageId());
+                pageIndices.push_back(page);
+                if (this->links[page].empty()) {
+                    danglingRanks += pageIdAndRank.getPageRank();
+                }
+            }
+            double previousScale = ((1.0 - this->alpha) + this->alpha * danglingRanks) / this->numAlive;
+
+            for (size_t i = 0; i < previousResult.size(); ++i) {
+                uint32_t page = pageIndices[i];
+                double difference = previousResult[i].getPageRank() / previousScale - this->solution[page];
+                // Ranks produced by this computer come back with rounding noise only
+                if (std::abs(difference) > 1e-12 * std::abs(this->solution[page])) {
+                    this->addResidual(page, -difference);
+                    this->addToSolution(page, difference);
+                }
+            }
+        }
+
+        static void eraseOne(std::vector<uint32_t>& values, uint32_t value)
+        {
+            auto found = std::find(values.begin(), values.end(), value);
+            ASSERT(found != values.end(), "Missing edge endpoint " << value);
+            *found = values.back();
+            values.pop_back();
+        }
+    };
+
+public:
+    // Result of a run, valid until the next run of the computer. Ranks are read
+    // from the computer's own state, rank = scale * s. Pages whose s changed in
+    // the run are listed, ranks of the other pages changed only by the ratio of
+    // the scales of the two runs, so reading an update costs time proportional
+    // to the pages it changed.
+    class View {
+    public:
+        // Number of the run of the computer that produced the view
+        uint64_t getEpoch() const
+        {
+            return this->epoch;
+        }
+
+        uint32_t getSize() const
+        {
+            this->checkCurrent();
+            return this->state->numAlive;
+        }
+
+        double getScale() const
+        {
+            return this->scale;
+        }
+
+        double getRank(PageId const& pageId) const
+        {
+            this->checkCurrent();
+            uint32_t page = this->state->findPage(pageId);
+            ASSERT(page != PageIdMap::notFound, "Rank of unknown page: " << pageId);
+            return this->scale * this->state->solution[page];
+        }
+
+        // Pages of the network whose s changed in the run, with their new ranks
+        std::vector<PageIdAndRank> getChangedRanks() const
+        {
+            this->checkCurrent();
+            std::vector<PageIdAndRank> result;
+            result.reserve(this->state->changed.size());
+            for (uint32_t page : this->state->changed) {
+                if (this->state->alive[page]) {
+                    result.push_back(PageIdAndRank(this->state->pages[page], this->scale * this->state->solution[page]));
+                }
+            }
+            return result;
+        }
+
+        // Classic result: every page of the network with its rank
+        std::vector<PageIdAndRank> toVector() const
+        {
+            this->checkCurrent();
+            std::vector<PageIdAndRank> result;
+            result.reserve(this->state->numAlive);
+            for (uint32_t page = 0; page < this->state->pages.size(); ++page) {
+                if (this->state->alive[page]) {
+                    result.push_back(PageIdAndRank(this->state->pages[page], this->scale * this->state->solution[page]));
+                }
+            }
+            return result;
+        }
+
+    private:
+        friend class IncrementalPageRankComputer;
+
+        std::shared_ptr<State const> state;
+        uint64_t epoch;
+        double scale;
+
+        View(std::shared_ptr<State const> stateArg)
+            : state(std::move(stateArg))
+            , epoch(this->state->epoch)
+            , scale(this->state->scale())
+        {
+        }
+
+        void checkCurrent() const
+        {
+            ASSERT(this->state->epoch == this->epoch, "View of epoch=" << this->epoch << " was replaced by epoch=" << this->state->epoch);
+        }
+    };
+
+private:
+    // Shared only with the views handed out by this computer
+    std::shared_ptr<State> state;
+
+    // Contributions of every page whose out-links change are retracted with the
+    // old out-degree and added back with the new one once the delta is applied
+    void applyDelta(NetworkDelta const& delta) const
+    {
+        State& state = *this->state;
+        std::vector<uint32_t> touched;
+        auto touch = [&state, &touched](PageId const& pageId) {
+            uint32_t index = state.findPage(pageId);
+            if (index != PageIdMap::notFound && not state.touched[index]) {
+                state.touched[index] = true;
+                state.removeContributions(index);
+                touched.push_back(index);
+            }
+        };
+        for (auto const& pageId : delta.getRemovedPages()) {
+            touch(pageId);
+        }
+        for (auto const& link : delta.getRemovedLinks()) {
+            touch(link.first);
+        }
+        for (auto const& link : delta.getAddedLinks()) {
+            touch(link.first);
+        }
+
+        for (auto const& pageId : delta.getRemovedPages()) {
+            state.removePage(pageId);
+        }
+        for (auto const& page : delta.getAddedPages()) {
+            uint32_t index = state.addPage(page.getId(), page.getLinks());
+            state.touched[index] = true;
+            touched.push_back(index);
+        }
+        for (uint32_t index : touched) {
+            if (state.alive[index]) {
+                state.resolvePendingLinks(index, &state.touched);
+            }
+        }
+        for (auto const& link : delta.getRemovedLinks()) {
+            state.removeLink(link.first, link.second);
+        }
+        for (auto const& link : delta.getAddedLinks()) {
+            state.addLink(link.first, link.second);
+        }
+
+        for (uint32_t index : touched) {
+            state.touched[index] = false;
+            if (state.alive[index]) {
+                state.addContributions(index);
+            }
+        }
+    }
+
+    // Pushes queued residuals until their scaled L1 norm is below tolerance. Only
+    // pages queued by the changes are visited: the threshold is lowered (with a
+    // scan of all pages) only when the network grew enough to need it.
+    void solve(uint32_t iterations, double tolerance) const
+    {
+        State& state = *this->state;
+        state.numPushes = 0;
+
+        for (uint32_t round = 0; round <= iterations; ++round) {
+            double scale = state.scale();
+            if (state.residualSum * scale < tolerance) {
+                return;
+            }
+            if (round == iterations) {
+                break;
+            }
+
+            // Once every residual is below the threshold, the scaled L1 norm is below tolerance / 2
+            double needed = tolerance / (2.0 * scale * state.numAlive);
+            if (state.threshold == 0.0 || state.threshold < needed / 4.0) {
+                // Pages above a higher threshold are a subset of the queued ones
+                state.threshold = needed / 2.0;
+            } else if (state.threshold > needed || state.active.empty()) {
+                // Residuals below the old threshold may be above the new one. An empty queue
+                // without convergence comes from rounding of the running residual sum.
+                state.threshold = std::min(state.threshold, needed) / 2.0;
+                state.requeue();
+            }
+
+            std::vector<uint32_t> current;
+            current.swap(state.active);
+            for (uint32_t page : current) {
+                state.queued[page] = false;
+            }
+            for (uint32_t page : current) {
+                if (state.alive[page] && std::abs(state.residuals[page]) > state.threshold) {
+                    state.push(page);
+                }
+            }
+        }
+
+        ASSERT(false, "Not able to find result in iterations=" << iterations);
+    }
+};
+
+#endif /* SRC_INCREMENTALPAGERANKCOMPUTER_HPP_ */
@@ -0,0 +1,10 @@
+#ifndef SRC_ITERATIONMODE_HPP_
+#define SRC_ITERATIONMODE_HPP_
+
+// Which ranks of other pages an iteration reads
+enum class IterationMode {
+    Jacobi, // only ranks of the previous iteration
+    InPlace // the current ranks: Gauss-Seidel with one thread, asynchronous with more
+};
+
+#endif /* SRC_ITERATIONMODE_HPP_ */
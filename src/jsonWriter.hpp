@@ -0,0 +1,173 @@
+#ifndef SRC_JSONWRITER_HPP_
+#define SRC_JSONWRITER_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "immutable/common.hpp"
+
+// Streaming writer of JSON documents. Objects and arrays are opened and closed
+// explicitly, commas are inserted automatically; inside an object every value
+// has to be preceded by key().
+class JsonWriter {
+public:
+    JsonWriter(std::ostream& outArg)
+        : out(outArg)
+        , hasValues()
+        , afterKey(false)
+    {
+    }
+
+    JsonWriter& beginObject()
+    {
+        this->beginValue();
+        this->out << '{';
+        this->hasValues.push_back(false);
+        return *this;
+    }
+
+    JsonWriter& endObject()
+    {
+        return this->end('}');
+    }
+
+    JsonWriter& beginArray()
+    {
+        this->beginValue();
+        this->out << '[';
+        this->hasValues.push_back(false);
+        return *this;
+    }
+
+    JsonWriter& endArray()
+    {
+        return this->end(']');
+    }
+
+    JsonWriter& key(std::string const& name)
+    {
+        ASSERT(not this->hasValues.empty() && not this->afterKey, "Misplaced JSON key " << name);
+        this->separate();
+        this->writeString(name);
+        this->out << ':';
+        this->afterKey = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::string const& text)
+    {
+        this->beginValue();
+        this->writeString(text);
+        return *this;
+    }
+
+    JsonWriter& value(char const* text)
+    {
+        return this->value(std::string(text));
+    }
+
+    JsonWriter& value(double number)
+    {
+        this->beginValue();
+        if (std::isfinite(number)) {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.9g", number);
+            this->out << buffer;
+        } else {
+            this->out << "null";
+        }
+        return *this;
+    }
+
+    JsonWriter& value(uint64_t number)
+    {
+        this->beginValue();
+        this->out << number;
+        return *this;
+    }
+
+    JsonWriter& value(uint32_t number)
+    {
+        return this->value(static_cast<uint64_t>(number));
+    }
+
+    JsonWriter& value(bool flag)
+    {
+        this->beginValue();
+        this->out << (flag ? "true" : "false");
+        return *this;
+    }
+
+    template <typename T>
+    JsonWriter& field(std::string const& name, T const& fieldValue)
+    {
+        return this->key(name).value(fieldValue);
+    }
+
+private:
+    std::ostream& out;
+    std::vector<bool> hasValues; // for every open object or array
+    bool afterKey;
+
+    void separate()
+    {
+        if (not this->hasValues.empty()) {
+            if (this->hasValues.back()) {
+                this->out << ',';
+            }
+            this->hasValues.back() = true;
+        }
+    }
+
+    void beginValue()
+    {
+        if (this->afterKey) {
+            this->afterKey = false;
+        } else {
+            this->separate();
+        }
+    }
+
+    JsonWriter& end(char bracket)
+    {
+        ASSERT(not this->hasValues.empty() && not this->afterKey, "Unbalanced JSON " << bracket);
+        this->hasValues.pop_back();
+        this->out << bracket;
+        return *this;
+    }
+
+    void writeString(std::string const& text)
+    {
+        static char const* digits = "0123456789abcdef";
+        this->out << '"';
+        for (unsigned char c : text) {
+            switch (c) {
+            case '"':
+                this->out << "\\\"";
+                break;
+            case '\\':
+                this->out << "\\\\";
+                break;
+            case '\n':
+                this->out << "\\n";
+                break;
+            case '\t':
+                this->out << "\\t";
+                break;
+            default:
+                if (c < 0x20) {
+                    this->out << "\\u00" << digits[c >> 4] << digits[c & 0xf];
+                } else {
+                    this->out << c;
+                }
+            }
+        }
+        this->out << '"';
+    }
+};
+
+#endif /* SRC_JSONWRITER_HPP_ */
@@ -2,172 +2,550 @@
 #define SRC_MULTITHREADEDPAGERANKCOMPUTER_HPP_
 
 #include <atomic>
-#include <mutex>
-#include <thread>
-
-#include <unordered_map>
-#include <unordered_set>
+#include <chrono>
+#include <cmath>
+#include <memory>
 #include <vector>
 
 #include "immutable/network.hpp"
 #include "immutable/pageIdAndRank.hpp"
 #include "immutable/pageRankComputer.hpp"
 
+#include "compiledNetwork.hpp"
+#include "computationStats.hpp"
+#include "edgeBalancedScheduler.hpp"
+#include "iterationMode.hpp"
+#include "numaTopology.hpp"
+#include "phaseTimes.hpp"
+#include "rankView.hpp"
+#include "workerPool.hpp"
+
 class MultiThreadedPageRankComputer : public PageRankComputer {
 public:
+    enum class ExecutionMode {
+        Shared,
+        // Threads are pinned to the CPUs of NUMA nodes and work on rank and edge
+        // slices first touched by themselves, only gathers of contributions of
+        // other pages cross nodes. Falls back to Shared on single-node machines.
+        Numa
+    };
+
     MultiThreadedPageRankComputer(uint32_t numThreadsArg)
-        : numThreads(numThreadsArg) {};
+        : MultiThreadedPageRankComputer(numThreadsArg, ExecutionMode::Shared) {};
+
+    MultiThreadedPageRankComputer(uint32_t numThreadsArg, ExecutionMode modeArg)
+        : MultiThreadedPageRankComputer(numThreadsArg, modeArg, NumaTopology::detect()) {};
+
+    MultiThreadedPageRankComputer(uint32_t numThreadsArg, ExecutionMode modeArg, NumaTopology const& topologyArg)
+        : MultiThreadedPageRankComputer(numThreadsArg, modeArg, topologyArg, IterationMode::Jacobi) {};
+
+    // IterationMode::InPlace runs asynchronously: threads update a shared rank
+    // vector and read whatever ranks of other pages are current. It uses the
+    // shared memory layout whatever the execution mode.
+    MultiThreadedPageRankComputer(uint32_t numThreadsArg, IterationMode iterationModeArg)
+        : MultiThreadedPageRankComputer(numThreadsArg, ExecutionMode::Shared, NumaTopology::detect(), iterationModeArg) {};
+
+    MultiThreadedPageRankComputer(uint32_t numThreadsArg, ExecutionMode modeArg, NumaTopology const& topologyArg, IterationMode iterationModeArg)
+        : numThreads(numThreadsArg)
+        , mode(modeArg)
+        , topology(topologyArg)
+        , iterationMode(iterationModeArg)
+        , pool(new WorkerPool(numThreadsArg))
+        , lastBusyTimes()
+        , lastIterations(0)
+        , lastPhaseTimes() {};
 
     std::vector<PageIdAndRank> computeForNetwork(Network const& network, double alpha, uint32_t iterations, double tolerance) const
     {
-        std::unordered_map<PageId, PageRank, PageIdHash> pageHashMap;
-        std::unordered_map<PageId, uint32_t, PageIdHash> numLinks;
-        std::vector<PageId> danglingNodes;
-    	std::unordered_map<PageId, std::vector<PageId>, PageIdHash> edges;
-
-        auto& pages = network.getPages();
-        auto idGeneratorWorker = [
-            &network, &pages
-        ](size_t start, size_t end) {
-            for (size_t i = start; i < end; i++) {
-                pages[i].generateId(network.getGenerator());
-            }
-        };
+        RankView view = this->computeViewForNetwork(network, alpha, iterations, tolerance);
+        PhaseStopwatch stopwatch(this->stats.get());
+        std::vector<PageIdAndRank> result = view.toVector();
+        this->lastPhaseTimes.output = stopwatch.lap("output");
 
-        std::thread threads[numThreads];
-        size_t last_index = 0;
-        for (uint32_t i = 0; i < numThreads; i++) {
-            threads[i] = std::thread {
-                idGeneratorWorker,
-                last_index,
-                last_index + network.getSize() / numThreads + (i < network.getSize() % numThreads ? 1 : 0)
-            };
+        ASSERT(result.size() == network.getSize(), "Invalid result size=" << result.size() << ", for network" << network);
 
-            last_index += network.getSize() / numThreads + (i < network.getSize() % numThreads ? 1 : 0);
-        }
-        for (uint32_t i = 0; i < numThreads; i++) {
-            threads[i].join();
+        return result;
+    }
+
+    RankView computeViewForNetwork(Network const& network, double alpha, uint32_t iterations, double tolerance) const
+    {
+        if (this->stats) {
+            this->stats->begin(this->getName(), this->numThreads, iterations);
         }
+        PhaseStopwatch stopwatch(this->stats.get());
+        this->pool->run([this, &network](uint32_t thread) {
+            auto range = WorkerPool::range(network.getSize(), thread, this->numThreads);
+            network.generateIds(range.first, range.second);
+        });
+        this->lastPhaseTimes.hashing = stopwatch.lap("generateIds");
 
-        for (auto const& page : network.getPages()) {
-            pageHashMap[page.getId()] = 1.0 / network.getSize();
+        std::shared_ptr<CompiledNetwork> compiled(new CompiledNetwork(network, *this->pool));
+        this->lastPhaseTimes.build = stopwatch.lap("build");
+        if (this->stats) {
+            this->stats->addBytesAllocated(compiled->getAllocatedBytes());
         }
 
-        for (auto page : network.getPages()) {
-            numLinks[page.getId()] = page.getLinks().size();
+        std::vector<double> ranks;
+        if (this->iterationMode == IterationMode::InPlace) {
+            ranks = this->computeAsynchronousRanks(compiled->getGraph(), alpha, iterations, tolerance);
+        } else if (this->isNumaActive()) {
+            ranks = this->computeNumaRanks(*compiled, alpha, iterations, tolerance);
+        } else {
+            ranks = this->computeSharedRanks(*compiled, alpha, iterations, tolerance);
         }
+        this->lastPhaseTimes.iterations = stopwatch.lap("iterations");
+        this->lastPhaseTimes.output = 0.0;
+        return RankView(compiled, std::move(ranks));
+    }
+
+    std::string getName() const
+    {
+        std::string mode = this->iterationMode == IterationMode::InPlace ? ", async" : (this->isNumaActive() ? ", numa" : "");
+        return "MultiThreadedPageRankComputer[" + std::to_string(this->numThreads) + mode + "]";
+    }
+
+    // Number of iterations the last computation needed to converge
+    uint32_t getLastIterations() const
+    {
+        return this->lastIterations;
+    }
+
+    // Seconds every thread spent computing ranks (waiting at barriers excluded) in the last computation
+    std::vector<double> const& getLastBusyTimes() const
+    {
+        return this->lastBusyTimes;
+    }
+
+    // Durations of the phases of the last computation
+    PhaseTimes getLastPhaseTimes() const
+    {
+        return this->lastPhaseTimes;
+    }
+
+    // Every following computation fills the given stats object, nullptr stops the collection
+    void attachStats(std::shared_ptr<ComputationStats> statsArg)
+    {
+        this->stats = statsArg;
+    }
+
+private:
+    struct Partials {
+        double difference;
+        double dangleSum;
+    };
 
-        for (auto page : network.getPages()) {
-            if (page.getLinks().size() == 0) {
-                danglingNodes.push_back(page.getId());
+    // Incoming edges of the pages owned by a thread, copied by that thread
+    struct PartitionSlice {
+        size_t firstPage;
+        std::vector<uint64_t> offsets; // relative to the start of sources
+        std::vector<uint32_t> sources;
+        std::vector<double> inverseOutDegrees;
+
+        PartitionSlice(CsrGraph const& graph, size_t start, size_t end)
+            : firstPage(start)
+            , offsets(end - start + 1)
+            , sources(graph.sources + graph.offsets[start], graph.sources + graph.offsets[end])
+            , inverseOutDegrees(graph.inverseOutDegrees + start, graph.inverseOutDegrees + end)
+        {
+            for (size_t page = start; page <= end; ++page) {
+                this->offsets[page - start] = graph.offsets[page] - graph.offsets[start];
             }
         }
+    };
 
-        for (auto page : network.getPages()) {
-            for (auto link : page.getLinks()) {
-                edges[link].push_back(page.getId());
-            }
+    uint32_t numThreads;
+    ExecutionMode mode;
+    NumaTopology topology;
+    IterationMode iterationMode;
+    std::shared_ptr<WorkerPool> pool;
+    // Written by every computation, a computer runs one computation at a time
+    mutable std::vector<double> lastBusyTimes;
+    mutable uint32_t lastIterations;
+    mutable PhaseTimes lastPhaseTimes;
+    std::shared_ptr<ComputationStats> stats;
+
+    bool isNumaActive() const
+    {
+        return this->mode == ExecutionMode::Numa && this->topology.isMultiNode();
+    }
+
+    void storeStatistics(std::vector<ThreadSlot<double>> const& busyTimes, uint32_t finalIteration) const
+    {
+        this->lastBusyTimes.clear();
+        for (auto const& busyTime : busyTimes) {
+            this->lastBusyTimes.push_back(busyTime.value);
         }
+        this->lastIterations = finalIteration;
+    }
 
-        std::unordered_map<PageId, PageRank, PageIdHash> previousPageHashMap;
-        double dangleSum;
-        double difference;
+    double iterationStart() const
+    {
+        return this->stats ? this->stats->now() : 0.0;
+    }
+
+    // Records an iteration that processed all edges, called by the first thread only
+    void recordIteration(uint32_t thread, double start, double residual, uint64_t numEdges) const
+    {
+        if (this->stats && thread == 0) {
+            this->stats->addIteration(start, this->stats->now(), residual);
+            this->stats->addEdgesProcessed(numEdges);
+        }
+    }
 
-        std::mutex dangleSumMutex;
-        std::mutex differenceMutex;
+    void recordAllocation(uint64_t bytes) const
+    {
+        if (this->stats) {
+            this->stats->addBytesAllocated(bytes);
+        }
+    }
 
-        auto dangleSumWorker = [&dangleSum, &dangleSumMutex, &pageHashMap, &danglingNodes](size_t start, size_t end) {
-            double localDangleSum = 0.0;
-            for (size_t i = start; i < end; i++) {
-                localDangleSum += pageHashMap[danglingNodes[i]];
-            }
-            {
-                std::lock_guard<std::mutex> lock(dangleSumMutex);
-                dangleSum += localDangleSum;
-            }
-        };
+    std::vector<double> computeSharedRanks(CompiledNetwork const& compiled, double alpha, uint32_t iterations, double tolerance) const
+    {
+        uint32_t size = compiled.getSize();
+        auto const& offsets = compiled.getOffsets();
+        auto const& sources = compiled.getSources();
+        auto const& inverseOutDegrees = compiled.getInverseOutDegrees();
+        auto const& danglingNodes = compiled.getDanglingNodes();
+
+        // Ranks of iteration i are kept in rankBuffers[i % 2], the other buffer holds the previous ones
+        std::vector<double> rankBuffers[2] = { std::vector<double>(size, 1.0 / size), std::vector<double>(size) };
+        std::vector<ThreadSlot<double>> dangleSums(this->numThreads);
+        std::vector<ThreadSlot<double>> differences(this->numThreads);
+        std::vector<ThreadSlot<double>> busyTimes(this->numThreads);
+        uint32_t finalIteration = 0; // stays 0 when the computation did not converge
+
+        this->recordAllocation(2 * size * sizeof(double));
+
+        EdgeBalancedScheduler scheduler(compiled.getGraph(), this->numThreads);
+        SpinBarrier barrier(this->numThreads);
+        this->pool->run([&](uint32_t thread) {
+            auto danglingRange = WorkerPool::range(danglingNodes.size(), thread, this->numThreads);
+            busyTimes[thread].value = 0.0;
+            ThreadTimeline timeline(this->stats.get(), thread);
+
+            for (uint32_t i = 1; i <= iterations; i++) {
+                double start = this->iterationStart();
+                std::vector<double> const& previousRanks = rankBuffers[(i + 1) % 2];
+                std::vector<double>& ranks = rankBuffers[i % 2];
+
+                double localDangleSum = 0.0;
+                for (size_t d = danglingRange.first; d < danglingRange.second; d++) {
+                    localDangleSum += previousRanks[danglingNodes[d]];
+                }
+                dangleSums[thread].value = localDangleSum;
+                timeline.busy("dangleSum", i);
+                barrier.arriveAndWait();
+                timeline.wait(i);
 
-        auto pageRankWorker = [
-            &network, &pages, &alpha, &dangleSum, &difference, &differenceMutex,
-            &pageHashMap, &previousPageHashMap, &edges, &numLinks
-        ](size_t start, size_t end) {
-            double localDifference = 0.0;
-            for (size_t i = start; i < end; i++) {
-                PageId pageId = pages[i].getId();
+                // Every thread reduces the partial sums in the same order, so all of them see the same value
+                double dangleSum = 0.0;
+                for (auto const& partial : dangleSums) {
+                    dangleSum += partial.value;
+                }
+                dangleSum *= alpha;
+
+                double danglingWeight = 1.0 / size;
+                double baseRank = dangleSum * danglingWeight + (1.0 - alpha) / size;
 
-                double danglingWeight = 1.0 / network.getSize();
-                pageHashMap[pageId] = dangleSum * danglingWeight + (1.0 - alpha) / network.getSize();
+                auto busyStart = std::chrono::steady_clock::now();
+                double localDifference = 0.0;
+                scheduler.forEachChunk(thread, i, [&](size_t start, size_t end, uint32_t) {
+                    for (size_t page = start; page < end; page++) {
+                        double rank = baseRank;
+                        for (uint64_t e = offsets[page]; e < offsets[page + 1]; ++e) {
+                            rank += alpha * previousRanks[sources[e]] * inverseOutDegrees[sources[e]];
+                        }
+                        ranks[page] = rank;
 
-                if (edges.count(pageId) > 0) {
-                    for (auto link : edges[pageId]) {
-                        pageHashMap[pageId] += alpha * previousPageHashMap[link] / numLinks[link];
+                        localDifference += std::abs(previousRanks[page] - rank);
                     }
+                });
+                differences[thread].value = localDifference;
+                busyTimes[thread].value += std::chrono::duration<double>(std::chrono::steady_clock::now() - busyStart).count();
+                timeline.busy("ranks", i);
+                barrier.arriveAndWait();
+                timeline.wait(i);
+
+                double difference = 0.0;
+                for (auto const& partial : differences) {
+                    difference += partial.value;
                 }
+                this->recordIteration(thread, start, difference, sources.size());
 
-                localDifference += std::abs(previousPageHashMap[pages[i].getId()] - pageHashMap[pages[i].getId()]);
-            }
-            {
-                std::lock_guard<std::mutex> lock(differenceMutex);
-                difference += localDifference;
+                if (difference < tolerance) {
+                    if (thread == 0) {
+                        finalIteration = i;
+                    }
+                    return;
+                }
             }
-        };
+        });
 
-        for (uint32_t i = 0; i < iterations; i++) {
-            previousPageHashMap = pageHashMap;
-            dangleSum = 0;
-            difference = 0;
+        this->storeStatistics(busyTimes, finalIteration);
 
-            last_index = 0;
-            for (uint32_t t = 0; t < numThreads; t++) {
-                threads[t] = std::thread {
-                    dangleSumWorker,
-                    last_index,
-                    last_index + danglingNodes.size() / numThreads + (t < danglingNodes.size() % numThreads ? 1 : 0)
-                };
+        if (finalIteration > 0) {
+            return rankBuffers[finalIteration % 2];
+        }
 
-                last_index += danglingNodes.size() / numThreads + (t < danglingNodes.size() % numThreads ? 1 : 0);
-            }
-            for (uint32_t t = 0; t < numThreads; t++) {
-                threads[t].join();
-            }
-            dangleSum *= alpha;
+        ASSERT(false, "Not able to find result in iterations=" << iterations);
+        return {};
+    }
 
-            last_index = 0;
-            for (uint32_t t = 0; t < numThreads; t++) {
-                threads[t] = std::thread {
-                    pageRankWorker,
-                    last_index,
-                    last_index + network.getSize() / numThreads + (t < network.getSize() % numThreads ? 1 : 0)
-                };
+    // Pins every thread of the pool to its CPU and saves its previous affinity. When
+    // any thread cannot be pinned (e.g. in a restricted cpuset) the pinned ones get
+    // their affinity back and false is returned.
+    bool pinThreads(std::vector<cpu_set_t>& previousAffinities) const
+    {
+        std::vector<uint32_t> threadCpus = this->topology.assignCpus(this->numThreads);
+        std::vector<ThreadSlot<bool>> pinned(this->numThreads);
+        this->pool->run([&](uint32_t thread) {
+            pinned[thread].value = pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &previousAffinities[thread]) == 0
+                && NumaTopology::pinCurrentThread(threadCpus[thread]);
+        });
 
-                last_index += network.getSize() / numThreads + (t < network.getSize() % numThreads ? 1 : 0);
-            }
-            for (uint32_t t = 0; t < numThreads; t++) {
-                threads[t].join();
+        bool allPinned = true;
+        for (auto const& slot : pinned) {
+            allPinned = allPinned && slot.value;
+        }
+        if (!allPinned) {
+            this->pool->run([&](uint32_t thread) {
+                if (pinned[thread].value) {
+                    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &previousAffinities[thread]);
+                }
+            });
+        }
+        return allPinned;
+    }
+
+    // Falls back to the shared layout when the threads cannot be pinned, first
+    // touch from unpinned threads would not place the pages on their nodes
+    std::vector<double> computeNumaRanks(CompiledNetwork const& compiled, double alpha, uint32_t iterations, double tolerance) const
+    {
+        std::vector<cpu_set_t> previousAffinities(this->numThreads);
+        if (!this->pinThreads(previousAffinities)) {
+            return this->computeSharedRanks(compiled, alpha, iterations, tolerance);
+        }
+
+        CsrGraph graph = compiled.getGraph();
+        uint32_t size = graph.size;
+        // Threads steal chunks only from threads of the same node
+        EdgeBalancedScheduler scheduler(graph, this->numThreads, this->topology.assignNodes(this->numThreads));
+
+        // Left uninitialized, every page is first touched by the thread owning it
+        std::unique_ptr<double[]> ranks(new double[size]);
+        // Contributions (rank / out-degree) of iteration i are kept in contributionBuffers[i % 2]
+        std::unique_ptr<double[]> contributionBuffers[2] = { std::unique_ptr<double[]>(new double[size]), std::unique_ptr<double[]>(new double[size]) };
+        std::vector<std::unique_ptr<PartitionSlice>> slices(this->numThreads);
+        std::vector<ThreadSlot<Partials>> partialBuffers[2] = {
+            std::vector<ThreadSlot<Partials>>(this->numThreads), std::vector<ThreadSlot<Partials>>(this->numThreads)
+        };
+        std::vector<ThreadSlot<double>> busyTimes(this->numThreads);
+        uint32_t finalIteration = 0; // stays 0 when the computation did not converge
+        // Ranks, both contribution buffers and the slices copied by the threads
+        this->recordAllocation(3 * size * sizeof(double) + graph.numEdges * sizeof(uint32_t)
+            + (size + this->numThreads) * sizeof(uint64_t) + size * sizeof(double));
+
+        SpinBarrier barrier(this->numThreads);
+        this->pool->run([&](uint32_t thread) {
+            ThreadTimeline timeline(this->stats.get(), thread);
+
+            auto owned = scheduler.getOwnedPages(thread);
+            slices[thread].reset(new PartitionSlice(graph, owned.first, owned.second));
+            for (size_t page = owned.first; page < owned.second; ++page) {
+                ranks[page] = 1.0 / size;
+                contributionBuffers[0][page] = ranks[page] * graph.inverseOutDegrees[page];
+                contributionBuffers[1][page] = 0.0;
             }
+            busyTimes[thread].value = 0.0;
+            timeline.busy("firstTouch", 0);
+            barrier.arriveAndWait();
+            timeline.wait(0);
 
-            if (difference < tolerance) {
-                std::vector<PageIdAndRank> result;
-                for (auto iter : pageHashMap) {
-                    result.push_back(PageIdAndRank(iter.first, iter.second));
-                }
+            double dangleSum = graph.numDanglingNodes * (1.0 / size);
+            for (uint32_t i = 1; i <= iterations; i++) {
+                double start = this->iterationStart();
+                auto busyStart = std::chrono::steady_clock::now();
+                double const* previous = contributionBuffers[(i + 1) % 2].get();
+                double* next = contributionBuffers[i % 2].get();
+                double baseRank = (alpha * dangleSum + (1.0 - alpha)) / size;
+
+                Partials partials = { 0.0, 0.0 };
+                scheduler.forEachChunk(thread, i, [&](size_t start, size_t end, uint32_t owner) {
+                    PartitionSlice const& slice = *slices[owner];
+                    for (size_t page = start; page < end; page++) {
+                        size_t local = page - slice.firstPage;
+                        double inSum = 0.0;
+                        for (uint64_t e = slice.offsets[local]; e < slice.offsets[local + 1]; ++e) {
+                            inSum += previous[slice.sources[e]];
+                        }
 
-                ASSERT(result.size() == network.getSize(), "Invalid result size=" << result.size() << ", for network" << network);
+                        double rank = baseRank + alpha * inSum;
+                        double inverseOutDegree = slice.inverseOutDegrees[local];
+                        partials.difference += std::abs(ranks[page] - rank);
+                        partials.dangleSum += inverseOutDegree == 0.0 ? rank : 0.0;
+                        ranks[page] = rank;
+                        next[page] = rank * inverseOutDegree;
+                    }
+                });
+                partialBuffers[i % 2][thread].value = partials;
+                busyTimes[thread].value += std::chrono::duration<double>(std::chrono::steady_clock::now() - busyStart).count();
+                timeline.busy("ranks", i);
+                barrier.arriveAndWait();
+                timeline.wait(i);
+
+                double difference = 0.0;
+                dangleSum = 0.0;
+                for (auto const& partial : partialBuffers[i % 2]) {
+                    difference += partial.value.difference;
+                    dangleSum += partial.value.dangleSum;
+                }
+                this->recordIteration(thread, start, difference, graph.numEdges);
 
-                return result;
+                if (difference < tolerance) {
+                    if (thread == 0) {
+                        finalIteration = i;
+                    }
+                    break;
+                }
             }
+
+            // Every thread, the calling one included, gets its affinity back for later runs on the pool
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &previousAffinities[thread]);
+        });
+        this->storeStatistics(busyTimes, finalIteration);
+
+        if (finalIteration > 0) {
+            return std::vector<double>(ranks.get(), ranks.get() + size);
         }
 
         ASSERT(false, "Not able to find result in iterations=" << iterations);
+        return {};
     }
 
-    std::string getName() const
+    // Sums over the pages a thread updated in an asynchronous sweep
+    struct SweepPartials {
+        double difference;
+        double rankSum;
+        double keptSum;
+        double dangleSum;
+    };
+
+    // Asynchronous counterpart of the Gauss-Seidel iteration of SingleThreadedPageRankComputer:
+    // threads update ranks in place and read whatever ranks of other pages are current.
+    // The dangling mass changes made by a thread are published as they happen. Every
+    // sweep ends with scaling ranks to the mass implied by them, which needs two barriers.
+    std::vector<double> computeAsynchronousRanks(CsrGraph const& graph, double alpha, uint32_t iterations, double tolerance) const
     {
-        return "MultiThreadedPageRankComputer[" + std::to_string(this->numThreads) + "]";
-    }
+        uint32_t size = graph.size;
+        // Read and written by all threads without synchronization, relaxed atomics
+        // compile to plain loads and stores but keep the races defined
+        std::unique_ptr<std::atomic<double>[]> ranks(new std::atomic<double>[size]);
+        // Part of the rank of every page passed along links to pages within the network
+        std::vector<double> keptFractions(size, 0.0);
+        for (uint32_t page = 0; page < size; ++page) {
+            ranks[page].store(1.0 / size, std::memory_order_relaxed);
+            for (uint64_t e = graph.offsets[page]; e < graph.offsets[page + 1]; ++e) {
+                keptFractions[graph.sources[e]] += graph.inverseOutDegrees[graph.sources[e]];
+            }
+        }
+        // Change of the dangling mass made by every thread in the current sweep, only written by its owner
+        std::vector<ThreadSlot<std::atomic<double>>> dangleChanges(this->numThreads);
+        for (auto& dangleChange : dangleChanges) {
+            dangleChange.value.store(0.0, std::memory_order_relaxed);
+        }
+        std::vector<ThreadSlot<SweepPartials>> partials(this->numThreads);
+        std::vector<ThreadSlot<double>> busyTimes(this->numThreads);
+        uint32_t finalIteration = 0; // stays 0 when the computation did not converge
 
-private:
-    uint32_t numThreads;
+        this->recordAllocation(2 * size * sizeof(double));
+
+        EdgeBalancedScheduler scheduler(graph, this->numThreads);
+        SpinBarrier barrier(this->numThreads);
+        this->pool->run([&](uint32_t thread) {
+            auto scaleRange = WorkerPool::range(size, thread, this->numThreads);
+            double sweepDangleSum = graph.numDanglingNodes * (1.0 / size);
+            busyTimes[thread].value = 0.0;
+            ThreadTimeline timeline(this->stats.get(), thread);
+
+            for (uint32_t i = 1; i <= iterations; i++) {
+                double start = this->iterationStart();
+                auto busyStart = std::chrono::steady_clock::now();
+                SweepPartials local = { 0.0, 0.0, 0.0, 0.0 };
+                scheduler.forEachChunk(thread, i, [&](size_t start, size_t end, uint32_t) {
+                    double dangleSum = sweepDangleSum;
+                    for (auto const& dangleChange : dangleChanges) {
+                        dangleSum += dangleChange.value.load(std::memory_order_relaxed);
+                    }
+                    double baseRank = (alpha * dangleSum + (1.0 - alpha)) / size;
+
+                    double localDangleChange = 0.0;
+                    for (size_t page = start; page < end; page++) {
+                        double rank = baseRank;
+                        for (uint64_t e = graph.offsets[page]; e < graph.offsets[page + 1]; ++e) {
+                            uint32_t source = graph.sources[e];
+                            rank += alpha * ranks[source].load(std::memory_order_relaxed) * graph.inverseOutDegrees[source];
+                        }
+
+                        double previousRank = ranks[page].load(std::memory_order_relaxed);
+                        if (graph.inverseOutDegrees[page] == 0.0) {
+                            localDangleChange += rank - previousRank;
+                            local.dangleSum += rank;
+                        }
+                        local.difference += std::abs(previousRank - rank);
+                        local.rankSum += rank;
+                        local.keptSum += rank * keptFractions[page];
+                        ranks[page].store(rank, std::memory_order_relaxed);
+                    }
+                    double dangleChange = dangleChanges[thread].value.load(std::memory_order_relaxed);
+                    dangleChanges[thread].value.store(dangleChange + localDangleChange, std::memory_order_relaxed);
+                });
+                partials[thread].value = local;
+                timeline.busy("sweep", i);
+                barrier.arriveAndWait();
+                timeline.wait(i);
+
+                SweepPartials total = { 0.0, 0.0, 0.0, 0.0 };
+                for (auto const& partial : partials) {
+                    total.difference += partial.value.difference;
+                    total.rankSum += partial.value.rankSum;
+                    total.keptSum += partial.value.keptSum;
+                    total.dangleSum += partial.value.dangleSum;
+                }
+                double scale = (1.0 - alpha) / (total.rankSum - alpha * (total.keptSum + total.dangleSum));
+                for (size_t page = scaleRange.first; page < scaleRange.second; ++page) {
+                    ranks[page].store(ranks[page].load(std::memory_order_relaxed) * scale, std::memory_order_relaxed);
+                }
+                sweepDangleSum = total.dangleSum * scale;
+                dangleChanges[thread].value.store(0.0, std::memory_order_relaxed);
+                busyTimes[thread].value += std::chrono::duration<double>(std::chrono::steady_clock::now() - busyStart).count();
+                timeline.busy("scale", i);
+                barrier.arriveAndWait();
+                timeline.wait(i);
+
+                // Scaling changes the ranks by |scale - 1| * rankSum in total
+                double difference = total.difference + std::abs(scale - 1.0) * total.rankSum;
+                this->recordIteration(thread, start, difference, graph.numEdges);
+                if (difference < tolerance) {
+                    if (thread == 0) {
+                        finalIteration = i;
+                    }
+                    return;
+                }
+            }
+        });
+        this->storeStatistics(busyTimes, finalIteration);
+
+        if (finalIteration > 0) {
+            std::vector<double> result(size);
+            for (uint32_t page = 0; page < size; ++page) {
+                result[page] = ranks[page].load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+        ASSERT(false, "Not able to find result in iterations=" << iterations);
+        return {};
+    }
 };
 
 #endif /* SRC_MULTITHREADEDPAGERANKCOMPUTER_HPP_ */
@@ -0,0 +1,77 @@
+#ifndef SRC_NETWORKDELTA_HPP_
+#define SRC_NETWORKDELTA_HPP_
+
+#include <utility>
+#include <vector>
+
+#include "immutable/idGenerator.hpp"
+#include "immutable/page.hpp"
+
+// Changes applied to a network between two PageRank runs. Added pages get
+// their ids generated when they are added. Changes are applied in the order:
+// removed pages, added pages, removed links, added links.
+class NetworkDelta {
+public:
+    typedef std::pair<PageId, PageId> Link;
+
+    NetworkDelta(IdGenerator const& idGeneratorArg)
+        : idGenerator(idGeneratorArg)
+    {
+    }
+
+    void addPage(Page const& page)
+    {
+        this->addedPages.push_back(page);
+        this->addedPages.back().generateId(this->idGenerator);
+    }
+
+    void removePage(PageId const& pageId)
+    {
+        this->removedPages.push_back(pageId);
+    }
+
+    void addLink(PageId const& from, PageId const& to)
+    {
+        this->addedLinks.push_back(Link(from, to));
+    }
+
+    void removeLink(PageId const& from, PageId const& to)
+    {
+        this->removedLinks.push_back(Link(from, to));
+    }
+
+    std::vector<Page> const& getAddedPages() const
+    {
+        return this->addedPages;
+    }
+
+    std::vector<PageId> const& getRemovedPages() const
+    {
+        return this->removedPages;
+    }
+
+    std::vector<Link> const& getAddedLinks() const
+    {
+        return this->addedLinks;
+    }
+
+    std::vector<Link> const& getRemovedLinks() const
+    {
+        return this->removedLinks;
+    }
+
+    size_t getSize() const
+    {
+        return this->addedPages.size() + this->removedPages.size() + this->addedLinks.size() + this->removedLinks.size();
+    }
+
+private:
+    IdGenerator const& idGenerator;
+
+    std::vector<Page> addedPages;
+    std::vector<PageId> removedPages;
+    std::vector<Link> addedLinks;
+    std::vector<Link> removedLinks;
+};
+
+#endif /* SRC_NETWORKDELTA_HPP_ */
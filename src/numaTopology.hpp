@@ -0,0 +1,131 @@
+#ifndef SRC_NUMATOPOLOGY_HPP_
+#define SRC_NUMATOPOLOGY_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "immutable/common.hpp"
+
+// NUMA nodes and their CPUs as listed in /sys/devices/system/node. Machines
+// without that directory (or without NUMA) are reported as a single node
+// holding all CPUs.
+class NumaTopology {
+public:
+    struct Node {
+        uint32_t id;
+        std::vector<uint32_t> cpus;
+    };
+
+    NumaTopology(std::vector<Node> const& nodesArg)
+        : nodes(nodesArg)
+    {
+        ASSERT(not nodesArg.empty(), "Topology without nodes");
+        for (auto const& node : nodesArg) {
+            ASSERT(not node.cpus.empty(), "Node " << node.id << " has no CPUs");
+        }
+    }
+
+    static NumaTopology detect(std::string const& root = "/sys/devices/system/node")
+    {
+        std::vector<Node> nodes;
+        for (uint32_t id : parseList(readFile(root + "/online"))) {
+            std::vector<uint32_t> cpus = parseList(readFile(root + "/node" + std::to_string(id) + "/cpulist"));
+            // Memory-only nodes cannot run threads
+            if (not cpus.empty()) {
+                nodes.push_back(Node { id, cpus });
+            }
+        }
+
+        if (nodes.empty()) {
+            std::vector<uint32_t> cpus;
+            for (uint32_t cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+                cpus.push_back(cpu);
+            }
+            nodes.push_back(Node { 0, cpus });
+        }
+        return NumaTopology(nodes);
+    }
+
+    std::vector<Node> const& getNodes() const
+    {
+        return this->nodes;
+    }
+
+    bool isMultiNode() const
+    {
+        return this->nodes.size() > 1;
+    }
+
+    // Node of every thread: threads are split into equal blocks, one block per node
+    std::vector<uint32_t> assignNodes(uint32_t numThreads) const
+    {
+        std::vector<uint32_t> threadNodes;
+        for (uint32_t thread = 0; thread < numThreads; ++thread) {
+            threadNodes.push_back(static_cast<uint32_t>(static_cast<uint64_t>(thread) * this->nodes.size() / numThreads));
+        }
+        return threadNodes;
+    }
+
+    // CPU of every thread, CPUs of a node are reused when it gets more threads than it has
+    std::vector<uint32_t> assignCpus(uint32_t numThreads) const
+    {
+        std::vector<uint32_t> threadNodes = this->assignNodes(numThreads);
+        std::vector<uint32_t> threadsOnNode(this->nodes.size(), 0);
+        std::vector<uint32_t> threadCpus;
+        for (uint32_t node : threadNodes) {
+            auto const& cpus = this->nodes[node].cpus;
+            threadCpus.push_back(cpus[threadsOnNode[node]++ % cpus.size()]);
+        }
+        return threadCpus;
+    }
+
+    // Restricts the calling thread to one CPU, returns false when the CPU is not available
+    static bool pinCurrentThread(uint32_t cpu)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+    // Parses lists as "0-3,8,10-11"
+    static std::vector<uint32_t> parseList(std::string const& list)
+    {
+        std::vector<uint32_t> values;
+        std::stringstream in(list);
+        std::string part;
+        while (std::getline(in, part, ',')) {
+            size_t dash = part.find('-');
+            if (part.find_first_of("0123456789") == std::string::npos) {
+                continue;
+            }
+            uint32_t first = std::stoul(part.substr(0, dash));
+            uint32_t last = dash == std::string::npos ? first : std::stoul(part.substr(dash + 1));
+            for (uint32_t value = first; value <= last; ++value) {
+                values.push_back(value);
+            }
+        }
+        return values;
+    }
+
+private:
+    std::vector<Node> nodes;
+
+    static std::string readFile(std::string const& path)
+    {
+        std::ifstream in(path);
+        std::string content;
+        std::getline(in, content);
+        return content;
+    }
+};
+
+#endif /* SRC_NUMATOPOLOGY_HPP_ */
@@ -0,0 +1,77 @@
+#ifndef SRC_PAGEIDINDEX_HPP_
+#define SRC_PAGEIDINDEX_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "immutable/pageId.hpp"
+
+#include "swissTable.hpp"
+#include "workerPool.hpp"
+
+// Index of every page id in an array of page ids, the array has to outlive
+// the index. A SwissControl table over positions in the array: 5 bytes per
+// slot with at most 7/8 of the slots taken, no id is stored twice and misses
+// rarely touch the ids. Of repeated ids the first is found.
+class PageIdIndex {
+public:
+    enum : uint32_t { notFound = UINT32_MAX };
+
+    PageIdIndex(PageId const* idsArg, uint32_t sizeArg)
+        : ids(idsArg)
+        , control(sizeArg)
+        , slots(new std::atomic<uint32_t>[this->control.getCapacity()])
+    {
+        for (uint32_t i = 0; i < sizeArg; ++i) {
+            this->insert(i);
+        }
+    }
+
+    // Ids are inserted by all threads of the pool at once
+    PageIdIndex(PageId const* idsArg, uint32_t sizeArg, WorkerPool& pool)
+        : ids(idsArg)
+        , control(sizeArg)
+        , slots(new std::atomic<uint32_t>[this->control.getCapacity()])
+    {
+        pool.run([this, sizeArg, &pool](uint32_t thread) {
+            auto range = WorkerPool::range(sizeArg, thread, pool.getNumThreads());
+            for (size_t i = range.first; i < range.second; ++i) {
+                this->insert(static_cast<uint32_t>(i));
+            }
+        });
+    }
+
+    uint32_t find(PageId const& pageId) const
+    {
+        size_t slot = this->control.find(PageIdHash()(pageId), [this, &pageId](size_t slot) {
+            return this->ids[this->slots[slot].load(std::memory_order_relaxed)] == pageId;
+        });
+        return slot == SwissControl::notFound ? notFound : this->slots[slot].load(std::memory_order_relaxed);
+    }
+
+private:
+    PageId const* ids;
+    SwissControl control;
+    std::unique_ptr<std::atomic<uint32_t>[]> slots;
+
+    void insert(uint32_t index)
+    {
+        PageId const& pageId = this->ids[index];
+        auto inserted = this->control.insert(
+            PageIdHash()(pageId),
+            [this, &pageId](size_t slot) {
+                return this->ids[this->slots[slot].load(std::memory_order_relaxed)] == pageId;
+            },
+            [this, index](size_t slot) {
+                this->slots[slot].store(index, std::memory_order_relaxed);
+            });
+
+        // Threads may insert repeated ids in any order
+        uint32_t current = this->slots[inserted.first].load(std::memory_order_relaxed);
+        while (index < current && not this->slots[inserted.first].compare_exchange_weak(current, index, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+#endif /* SRC_PAGEIDINDEX_HPP_ */
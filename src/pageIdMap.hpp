@@ -0,0 +1,132 @@
+#ifndef SRC_PAGEIDMAP_HPP_
+#define SRC_PAGEIDMAP_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "immutable/common.hpp"
+#include "immutable/pageId.hpp"
+
+#include "swissTable.hpp"
+
+// Interns page ids: every distinct id gets the next dense index, ids are never
+// erased. Many threads can intern ids at once as long as the table has room for
+// them, lookups by find() and growing by reserve() must not run together with
+// insertOrGet().
+class PageIdMap {
+public:
+    enum : uint32_t { notFound = UINT32_MAX };
+
+    PageIdMap(uint32_t maxSizeArg)
+        : maxSize(maxSizeArg)
+        , control(maxSizeArg)
+        , keys(new PageId[this->control.getCapacity()])
+        , values(new uint32_t[this->control.getCapacity()])
+        , size(0)
+    {
+    }
+
+    PageIdMap(PageIdMap&& other)
+        : maxSize(other.maxSize)
+        , control(std::move(other.control))
+        , keys(std::move(other.keys))
+        , values(std::move(other.values))
+        , size(other.size.load(std::memory_order_relaxed))
+    {
+    }
+
+    PageIdMap& operator=(PageIdMap&& other)
+    {
+        this->maxSize = other.maxSize;
+        this->control = std::move(other.control);
+        this->keys = std::move(other.keys);
+        this->values = std::move(other.values);
+        this->size.store(other.size.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    // Index of the id and whether this call interned it
+    std::pair<uint32_t, bool> insertOrGet(PageId const& pageId)
+    {
+        auto inserted = this->control.insert(
+            PageIdHash()(pageId),
+            [this, &pageId](size_t slot) {
+                return this->keys[slot] == pageId;
+            },
+            [this, &pageId](size_t slot) {
+                uint32_t index = this->size.fetch_add(1, std::memory_order_relaxed);
+                ASSERT(index < this->maxSize, "Page id map is full, maxSize=" << this->maxSize);
+                this->keys[slot] = pageId;
+                this->values[slot] = index;
+            });
+        return std::make_pair(this->values[inserted.first], inserted.second);
+    }
+
+    uint32_t find(PageId const& pageId) const
+    {
+        size_t slot = this->control.find(PageIdHash()(pageId), [this, &pageId](size_t slot) {
+            return this->keys[slot] == pageId;
+        });
+        return slot == SwissControl::notFound ? notFound : this->values[slot];
+    }
+
+    uint32_t getSize() const
+    {
+        return this->size.load(std::memory_order_relaxed);
+    }
+
+    uint32_t getMaxSize() const
+    {
+        return this->maxSize;
+    }
+
+    // Rebuilds the table with room for maxSize ids, indices of interned ids stay the same
+    void reserve(uint32_t maxSizeArg)
+    {
+        if (maxSizeArg <= this->maxSize) {
+            return;
+        }
+        PageIdMap bigger(maxSizeArg);
+        for (size_t slot = 0; slot < this->control.getCapacity(); ++slot) {
+            if (this->control.isFull(slot)) {
+                PageId const& pageId = this->keys[slot];
+                uint32_t index = this->values[slot];
+                bigger.control.insert(
+                    PageIdHash()(pageId),
+                    [](size_t) {
+                        return false;
+                    },
+                    [&bigger, &pageId, index](size_t newSlot) {
+                        bigger.keys[newSlot] = pageId;
+                        bigger.values[newSlot] = index;
+                    });
+            }
+        }
+        bigger.size.store(this->getSize(), std::memory_order_relaxed);
+        *this = std::move(bigger);
+    }
+
+    // Interned ids by index, for when interning is over
+    std::vector<PageId> getPageIds() const
+    {
+        std::vector<PageId> ids(this->getSize());
+        for (size_t slot = 0; slot < this->control.getCapacity(); ++slot) {
+            if (this->control.isFull(slot)) {
+                ids[this->values[slot]] = this->keys[slot];
+            }
+        }
+        return ids;
+    }
+
+private:
+    uint32_t maxSize;
+    SwissControl control;
+    std::unique_ptr<PageId[]> keys;
+    std::unique_ptr<uint32_t[]> values;
+    std::atomic<uint32_t> size;
+};
+
+#endif /* SRC_PAGEIDMAP_HPP_ */
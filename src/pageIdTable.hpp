@@ -0,0 +1,22 @@
+#ifndef SRC_PAGEIDTABLE_HPP_
+#define SRC_PAGEIDTABLE_HPP_
+
+#include <cstdint>
+
+#include "immutable/pageId.hpp"
+
+// Page ids of a compiled network by dense page index, with the mapping from
+// the order of the network the pages were read in.
+class PageIdTable {
+public:
+    virtual uint32_t getSize() const = 0;
+
+    virtual PageId getPageId(uint32_t page) const = 0;
+
+    // Dense index of the i-th page of the network
+    virtual uint32_t getCompiledIndex(uint32_t networkIndex) const = 0;
+
+    virtual ~PageIdTable() {};
+};
+
+#endif /* SRC_PAGEIDTABLE_HPP_ */
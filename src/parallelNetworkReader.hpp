@@ -0,0 +1,226 @@
+#ifndef SRC_PARALLELNETWORKREADER_HPP_
+#define SRC_PARALLELNETWORKREADER_HPP_
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "immutable/network.hpp"
+
+#include "workerPool.hpp"
+
+// Multi-threaded reader of the text format understood by TextNetworkReader.
+// The whole input is kept in one buffer (or a mapping of the input file) and
+// split at page boundaries (even line numbers) into chunks. Workers parse the
+// chunks independently, every page is parsed directly into the arena of its chunk.
+class ParallelNetworkReader {
+public:
+    ParallelNetworkReader(uint32_t numThreadsArg)
+        : numThreads(numThreadsArg)
+        , pool(new WorkerPool(numThreadsArg))
+    {
+    }
+
+    Network readStream(std::istream& in, IdGenerator const& idGenerator) const
+    {
+        std::vector<char> buffer;
+        size_t size = 0;
+        while (in) {
+            buffer.resize(size + blockSize);
+            in.read(buffer.data() + size, blockSize);
+            size += static_cast<size_t>(in.gcount());
+        }
+        return this->parse(buffer.data(), size, idGenerator);
+    }
+
+    Network readFile(std::string const& path, IdGenerator const& idGenerator) const
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        ASSERT(fd >= 0, "Cannot open network " << path);
+
+        struct stat fileStat;
+        ASSERT(fstat(fd, &fileStat) == 0, "Cannot stat network " << path);
+        size_t size = static_cast<size_t>(fileStat.st_size);
+        ASSERT(size > 0, "Network " << path << " is empty");
+
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        ASSERT(mapped != MAP_FAILED, "Cannot map network " << path);
+        madvise(mapped, size, MADV_SEQUENTIAL);
+
+        Network network = this->parse(static_cast<char const*>(mapped), size, idGenerator);
+        munmap(mapped, size);
+        return network;
+    }
+
+    Network parse(char const* data, size_t size, IdGenerator const& idGenerator) const
+    {
+        char const* end = data + size;
+        char const* headerEnd = lineEnd(data, end);
+        uint32_t numberOfNodes = std::stoul(std::string(data, headerEnd));
+        char const* body = headerEnd == end ? end : headerEnd + 1;
+
+        std::vector<Chunk> chunks = this->splitIntoChunks(body, end);
+        std::vector<PageArena> chunkArenas(chunks.size());
+        std::vector<std::vector<Page>> chunkPages(chunks.size());
+        std::atomic<size_t> nextChunk(0);
+        this->pool->run([&](uint32_t) {
+            for (size_t chunk = nextChunk++; chunk < chunks.size(); chunk = nextChunk++) {
+                // Lines after the declared number of pages are ignored, as by std::getline based reading
+                if (chunks[chunk].firstPage < numberOfNodes) {
+                    chunkPages[chunk] = parseChunk(chunks[chunk], numberOfNodes - chunks[chunk].firstPage, chunkArenas[chunk]);
+                }
+            }
+        });
+
+        Network network(idGenerator);
+        network.reserve(numberOfNodes);
+        for (size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+            network.addPages(std::move(chunkArenas[chunk]), std::move(chunkPages[chunk]));
+        }
+        ASSERT(network.getSize() == numberOfNodes, "Input has pages=" << network.getSize() << ", declared=" << numberOfNodes);
+
+        return network;
+    }
+
+private:
+    static size_t const blockSize = 64 << 20;
+    static size_t const minChunkSize = 1 << 20;
+    static uint32_t const chunksPerThread = 4;
+
+    // Whole pages of the input: both lines of every page lie in [begin, end)
+    struct Chunk {
+        char const* begin;
+        char const* end;
+        size_t firstPage;
+    };
+
+    uint32_t numThreads;
+    std::shared_ptr<WorkerPool> pool;
+
+    static char const* lineEnd(char const* position, char const* end)
+    {
+        char const* newline = static_cast<char const*>(std::memchr(position, '\n', end - position));
+        return newline == nullptr ? end : newline;
+    }
+
+    static char const* nextLine(char const* position, char const* end)
+    {
+        char const* newline = lineEnd(position, end);
+        return newline == end ? end : newline + 1;
+    }
+
+    static size_t countLines(char const* position, char const* end)
+    {
+        size_t count = 0;
+        while ((position = static_cast<char const*>(std::memchr(position, '\n', end - position))) != nullptr) {
+            ++count;
+            ++position;
+        }
+        return count;
+    }
+
+    std::vector<Chunk> splitIntoChunks(char const* body, char const* end) const
+    {
+        size_t size = end - body;
+        size_t numChunks = std::max<size_t>(1, std::min<size_t>(size / minChunkSize, this->numThreads * chunksPerThread));
+
+        // Line numbers at the approximate boundaries, newlines are counted in parallel
+        std::vector<size_t> newlines(numChunks, 0);
+        std::atomic<size_t> nextChunk(0);
+        this->pool->run([&](uint32_t) {
+            for (size_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+                newlines[chunk] = countLines(body + size * chunk / numChunks, body + size * (chunk + 1) / numChunks);
+            }
+        });
+
+        // Every boundary is moved forward to the start of the next page
+        std::vector<Chunk> chunks;
+        size_t line = 0;
+        char const* begin = body;
+        size_t beginLine = 0;
+        for (size_t chunk = 1; chunk <= numChunks; ++chunk) {
+            line += newlines[chunk - 1];
+            char const* boundary = body + size * chunk / numChunks;
+            size_t boundaryLine = line;
+            if (chunk == numChunks) {
+                boundary = end;
+            } else {
+                if (boundary[-1] != '\n') {
+                    boundary = nextLine(boundary, end);
+                    boundaryLine++;
+                }
+                if (boundaryLine % 2 == 1) {
+                    boundary = nextLine(boundary, end);
+                    boundaryLine++;
+                }
+            }
+
+            if (boundary > begin) {
+                chunks.push_back(Chunk { begin, boundary, beginLine / 2 });
+                begin = boundary;
+                beginLine = boundaryLine;
+            }
+        }
+        return chunks;
+    }
+
+    // Single pass: link ids are parsed straight into the arena, right before the content of their page
+    static std::vector<Page> parseChunk(Chunk const& chunk, size_t maxPages, PageArena& arena)
+    {
+        std::vector<Page> pages;
+        char const* position = chunk.begin;
+        while (position < chunk.end && pages.size() < maxPages) {
+            char const* content = position;
+            size_t contentSize = lineEnd(position, chunk.end) - content;
+            position = nextLine(position, chunk.end);
+
+            size_t numLinks = 0;
+            if (position < chunk.end) {
+                char const* linksEnd = lineEnd(position, chunk.end);
+                // Every link takes PageId::hexLength characters
+                PageId* links = arena.beginPage((linksEnd - position) / PageId::hexLength, contentSize);
+                while (true) {
+                    while (position < linksEnd && isSeparator(*position)) {
+                        ++position;
+                    }
+                    if (position == linksEnd) {
+                        break;
+                    }
+                    char const* token = position;
+                    // Valid ids end right after PageId::hexLength characters, other tokens are scanned to their end
+                    if (static_cast<size_t>(linksEnd - position) >= PageId::hexLength
+                        && (linksEnd - position == PageId::hexLength || isSeparator(position[PageId::hexLength]))) {
+                        position += PageId::hexLength;
+                    } else {
+                        while (position < linksEnd && not isSeparator(*position)) {
+                            ++position;
+                        }
+                    }
+                    // Checked before writing, the room of the page holds only ids of this length
+                    ASSERT(position - token == PageId::hexLength,
+                        "Invalid PageId, expected " << PageId::hexLength << " hex digits, got=" << std::string(token, position));
+                    new (links + numLinks++) PageId(token, PageId::hexLength);
+                }
+                position = nextLine(linksEnd, chunk.end);
+            }
+            pages.push_back(arena.commitPage(numLinks, content, contentSize));
+        }
+        return pages;
+    }
+
+    static bool isSeparator(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+};
+
+#endif /* SRC_PARALLELNETWORKREADER_HPP_ */
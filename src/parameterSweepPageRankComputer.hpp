@@ -0,0 +1,230 @@
+#ifndef SRC_PARAMETERSWEEPPAGERANKCOMPUTER_HPP_
+#define SRC_PARAMETERSWEEPPAGERANKCOMPUTER_HPP_
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "immutable/network.hpp"
+#include "immutable/pageIdAndRank.hpp"
+
+#include "compiledNetwork.hpp"
+#include "csrGraph.hpp"
+#include "edgeBalancedScheduler.hpp"
+#include "rankView.hpp"
+#include "workerPool.hpp"
+
+// PageRank for several (alpha, tolerance) pairs over one compiled network.
+// Ids are generated and the graph is built once, and every iteration walks the
+// edges once for all rank vectors: contributions of a page are stored as a row
+// with one value per active parameter set. A parameter set that converged
+// drops out of the rows, so that later iterations only carry the slower ones.
+class ParameterSweepPageRankComputer {
+public:
+    struct Parameters {
+        double alpha;
+        double tolerance;
+    };
+
+    ParameterSweepPageRankComputer(uint32_t numThreadsArg)
+        : numThreads(numThreadsArg)
+        , pool(new WorkerPool(numThreadsArg))
+        , lastIterations()
+    {
+    }
+
+    // Returns the ranks for every parameter set, in the order of the network
+    std::vector<std::vector<PageIdAndRank>> computeForNetwork(Network const& network, std::vector<Parameters> const& parameters, uint32_t iterations) const
+    {
+        std::vector<std::vector<PageIdAndRank>> results;
+        results.reserve(parameters.size());
+        for (auto const& view : this->computeViewsForNetwork(network, parameters, iterations)) {
+            results.push_back(view.toVector());
+        }
+        return results;
+    }
+
+    // Ranks of every parameter set as views sharing one page id table
+    std::vector<RankView> computeViewsForNetwork(Network const& network, std::vector<Parameters> const& parameters, uint32_t iterations) const
+    {
+        this->pool->run([this, &network](uint32_t thread) {
+            auto range = WorkerPool::range(network.getSize(), thread, this->numThreads);
+            network.generateIds(range.first, range.second);
+        });
+
+        std::shared_ptr<CompiledNetwork> compiled(new CompiledNetwork(network, *this->pool));
+        std::vector<RankView> views;
+        views.reserve(parameters.size());
+        for (auto& ranks : this->computeRanks(compiled->getGraph(), parameters, iterations)) {
+            views.push_back(RankView(compiled, std::move(ranks)));
+        }
+        return views;
+    }
+
+    std::vector<std::vector<double>> computeRanks(CsrGraph const& graph, std::vector<Parameters> const& parameters, uint32_t iterations) const
+    {
+        uint32_t size = graph.size;
+        std::vector<std::vector<double>> results(parameters.size());
+        this->lastIterations.assign(parameters.size(), 0);
+
+        // Parameter sets still iterated, in the order of the values in a row
+        std::vector<size_t> active;
+        for (size_t set = 0; set < parameters.size(); ++set) {
+            ASSERT(parameters[set].alpha >= 0.0 && parameters[set].alpha < 1.0, "Invalid alpha=" << parameters[set].alpha);
+            active.push_back(set);
+        }
+
+        size_t width = active.size();
+        std::vector<double> ranks(size * width, 1.0 / size);
+        std::vector<double> contributionBuffers[2] = { std::vector<double>(size * width), std::vector<double>(size * width) };
+        for (uint32_t page = 0; page < size; ++page) {
+            for (size_t lane = 0; lane < width; ++lane) {
+                contributionBuffers[0][page * width + lane] = graph.inverseOutDegrees[page] / size;
+            }
+        }
+        // Differences and dangling sums of every thread, one pair per active parameter set
+        std::vector<std::vector<double>> partials(this->numThreads);
+        std::vector<double> dangleSums(width, graph.numDanglingNodes * (1.0 / size));
+        std::vector<double> baseRanks(width);
+        for (size_t lane = 0; lane < width; ++lane) {
+            double alpha = parameters[active[lane]].alpha;
+            baseRanks[lane] = (alpha * dangleSums[lane] + (1.0 - alpha)) / size;
+        }
+        uint32_t current = 0;
+        bool unconverged = false;
+
+        EdgeBalancedScheduler scheduler(graph, this->numThreads);
+        SpinBarrier barrier(this->numThreads);
+        this->pool->run([&](uint32_t thread) {
+            for (uint32_t i = 1; not active.empty(); i++) {
+                double const* previous = contributionBuffers[current].data();
+                double* next = contributionBuffers[1 - current].data();
+                std::vector<double>& partial = partials[thread];
+                partial.assign(2 * width, 0.0);
+
+                scheduler.forEachChunk(thread, i, [&](size_t start, size_t end, uint32_t) {
+                    this->sweep(graph, parameters, active, baseRanks.data(), previous, next, ranks.data(), partial.data(), start, end);
+                });
+                barrier.arriveAndWait();
+
+                if (thread == 0) {
+                    unconverged = not this->collectConverged(parameters, iterations, i, partials, active, dangleSums, baseRanks, ranks, contributionBuffers[1 - current], results);
+                    width = active.size();
+                    current = 1 - current;
+                }
+                barrier.arriveAndWait();
+
+                if (unconverged) {
+                    return;
+                }
+            }
+        });
+
+        ASSERT(not unconverged, "Not able to find result in iterations=" << iterations);
+        return results;
+    }
+
+    std::string getName() const
+    {
+        return "ParameterSweepPageRankComputer[" + std::to_string(this->numThreads) + "]";
+    }
+
+    // Number of iterations every parameter set of the last computation needed to converge
+    std::vector<uint32_t> const& getLastIterations() const
+    {
+        return this->lastIterations;
+    }
+
+private:
+    uint32_t numThreads;
+    std::shared_ptr<WorkerPool> pool;
+    // Written by every sweep, concurrent sweeps need their own computers
+    mutable std::vector<uint32_t> lastIterations;
+
+    // Rows of pages [start, end) for every active parameter set
+    static void sweep(CsrGraph const& graph, std::vector<Parameters> const& parameters, std::vector<size_t> const& active, double const* baseRanks,
+        double const* previous, double* next, double* ranks, double* partial, size_t start, size_t end)
+    {
+        size_t width = active.size();
+        std::vector<double> sums(width);
+        for (size_t page = start; page < end; ++page) {
+            std::fill(sums.begin(), sums.end(), 0.0);
+            for (uint64_t e = graph.offsets[page]; e < graph.offsets[page + 1]; ++e) {
+                double const* row = previous + graph.sources[e] * width;
+                for (size_t lane = 0; lane < width; ++lane) {
+                    sums[lane] += row[lane];
+                }
+            }
+
+            double inverseOutDegree = graph.inverseOutDegrees[page];
+            for (size_t lane = 0; lane < width; ++lane) {
+                double rank = baseRanks[lane] + parameters[active[lane]].alpha * sums[lane];
+                partial[2 * lane] += std::abs(ranks[page * width + lane] - rank);
+                partial[2 * lane + 1] += inverseOutDegree == 0.0 ? rank : 0.0;
+                ranks[page * width + lane] = rank;
+                next[page * width + lane] = rank * inverseOutDegree;
+            }
+        }
+    }
+
+    // Sums partials of the threads, moves converged parameter sets to results and
+    // packs rows of the remaining ones. Returns false when some parameter set ran
+    // out of iterations.
+    bool collectConverged(std::vector<Parameters> const& parameters, uint32_t iterations, uint32_t iteration, std::vector<std::vector<double>> const& partials,
+        std::vector<size_t>& active, std::vector<double>& dangleSums, std::vector<double>& baseRanks,
+        std::vector<double>& ranks, std::vector<double>& contributions, std::vector<std::vector<double>>& results) const
+    {
+        size_t width = active.size();
+        size_t size = ranks.size() / width;
+
+        std::vector<size_t> kept;
+        for (size_t lane = 0; lane < width; ++lane) {
+            double difference = 0.0;
+            dangleSums[lane] = 0.0;
+            for (auto const& partial : partials) {
+                difference += partial[2 * lane];
+                dangleSums[lane] += partial[2 * lane + 1];
+            }
+
+            if (difference < parameters[active[lane]].tolerance) {
+                std::vector<double>& result = results[active[lane]];
+                result.resize(size);
+                for (size_t page = 0; page < size; ++page) {
+                    result[page] = ranks[page * width + lane];
+                }
+                this->lastIterations[active[lane]] = iteration;
+            } else {
+                kept.push_back(lane);
+            }
+        }
+
+        if (not kept.empty() && iteration == iterations) {
+            return false;
+        }
+
+        if (kept.size() < width) {
+            for (size_t page = 0; page < size; ++page) {
+                for (size_t lane = 0; lane < kept.size(); ++lane) {
+                    ranks[page * kept.size() + lane] = ranks[page * width + kept[lane]];
+                    contributions[page * kept.size() + lane] = contributions[page * width + kept[lane]];
+                }
+            }
+            for (size_t lane = 0; lane < kept.size(); ++lane) {
+                active[lane] = active[kept[lane]];
+                dangleSums[lane] = dangleSums[kept[lane]];
+            }
+            active.resize(kept.size());
+            ranks.resize(size * kept.size());
+            contributions.resize(size * kept.size());
+        }
+
+        baseRanks.resize(active.size());
+        for (size_t lane = 0; lane < active.size(); ++lane) {
+            double alpha = parameters[active[lane]].alpha;
+            baseRanks[lane] = (alpha * dangleSums[lane] + (1.0 - alpha)) / size;
+        }
+        return true;
+    }
+};
+
+#endif /* SRC_PARAMETERSWEEPPAGERANKCOMPUTER_HPP_ */
@@ -0,0 +1,338 @@
+#ifndef SRC_PERSONALIZEDPAGERANKCOMPUTER_HPP_
+#define SRC_PERSONALIZEDPAGERANKCOMPUTER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "immutable/network.hpp"
+#include "immutable/pageIdAndRank.hpp"
+
+#include "compiledNetwork.hpp"
+#include "pageIdIndex.hpp"
+#include "rankView.hpp"
+#include "vectorizedPageRankComputer.hpp"
+#include "workerPool.hpp"
+
+// Personalized PageRank for a batch of teleport vectors. A random jump (and
+// the mass of dangling pages) lands on the pages of the teleport vector of a
+// seed set instead of on all pages.
+//
+// Every thread iterates a block of batchWidth seed sets together: the ranks of
+// a page form a row of batchWidth values, so one pass over the edges updates
+// all of them and a row is summed with SIMD across the batch. Seed sets converge
+// independently; a converged one leaves its lane and the next pending seed set
+// takes it over, so that the block stays full until the batch runs out.
+class PersonalizedPageRankComputer {
+public:
+    // Pages a random jump lands on with their weights, weights are normalized to sum to 1
+    typedef std::vector<std::pair<PageId, double>> TeleportVector;
+
+    static uint32_t const batchWidth = 8;
+
+    PersonalizedPageRankComputer(uint32_t numThreadsArg)
+        : PersonalizedPageRankComputer(numThreadsArg, VectorizedPageRankComputer::detectKernel())
+    {
+    }
+
+    PersonalizedPageRankComputer(uint32_t numThreadsArg, VectorizedPageRankComputer::Kernel kernelArg)
+        : numThreads(numThreadsArg)
+        , kernel(kernelArg)
+        , pool(new WorkerPool(numThreadsArg))
+        , lastIterations()
+    {
+    }
+
+    // Returns the ranks of every seed set, in the order of the network
+    std::vector<std::vector<PageIdAndRank>> computeForNetwork(Network const& network, std::vector<TeleportVector> const& teleports, double alpha, uint32_t iterations, double tolerance) const
+    {
+        std::vector<std::vector<PageIdAndRank>> results;
+        results.reserve(teleports.size());
+        for (auto const& view : this->computeViewsForNetwork(network, teleports, alpha, iterations, tolerance)) {
+            results.push_back(view.toVector());
+        }
+        return results;
+    }
+
+    // Ranks of every seed set as views sharing one page id table
+    std::vector<RankView> computeViewsForNetwork(Network const& network, std::vector<TeleportVector> const& teleports, double alpha, uint32_t iterations, double tolerance) const
+    {
+        this->pool->run([this, &network](uint32_t thread) {
+            auto range = WorkerPool::range(network.getSize(), thread, this->numThreads);
+            network.generateIds(range.first, range.second);
+        });
+
+        std::shared_ptr<CompiledNetwork> compiled(new CompiledNetwork(network, *this->pool));
+        std::vector<RankView> views;
+        views.reserve(teleports.size());
+        for (auto& ranks : this->computeRanks(*compiled, this->resolveTeleports(*compiled, teleports), alpha, iterations, tolerance)) {
+            views.push_back(RankView(compiled, std::move(ranks)));
+        }
+        return views;
+    }
+
+    std::string getName() const
+    {
+        static char const* kernelNames[] = { "scalar", "avx2", "avx512" };
+        return "PersonalizedPageRankComputer[" + std::to_string(this->numThreads) + ", " + kernelNames[static_cast<int>(this->kernel)] + "]";
+    }
+
+    // Number of iterations every seed set of the last computation needed to converge
+    std::vector<uint32_t> const& getLastIterations() const
+    {
+        return this->lastIterations;
+    }
+
+private:
+    typedef std::vector<std::pair<uint32_t, double>> ResolvedTeleport;
+
+    struct SweepArgs {
+        uint32_t size;
+        uint64_t const* offsets;
+        uint32_t const* sources;
+        double const* inverseOutDegrees;
+        double alpha;
+    };
+
+    // Seed set iterated in one lane of a block
+    struct Lane {
+        size_t seedSet;
+        bool active;
+        uint32_t iterations;
+        double jump; // mass spread over the teleport vector by the next sweep
+    };
+
+    uint32_t numThreads;
+    VectorizedPageRankComputer::Kernel kernel;
+    std::shared_ptr<WorkerPool> pool;
+    // Written by every computation, concurrent computations need their own computers
+    mutable std::vector<uint32_t> lastIterations;
+
+    static std::vector<ResolvedTeleport> resolveTeleports(CompiledNetwork const& compiled, std::vector<TeleportVector> const& teleports)
+    {
+        PageIdIndex indices(compiled.getPageIds().data(), compiled.getSize());
+
+        std::vector<ResolvedTeleport> resolved(teleports.size());
+        for (size_t seedSet = 0; seedSet < teleports.size(); ++seedSet) {
+            std::unordered_map<uint32_t, double> weights;
+            double totalWeight = 0.0;
+            for (auto const& seed : teleports[seedSet]) {
+                uint32_t index = indices.find(seed.first);
+                ASSERT(index != PageIdIndex::notFound, "Teleport vector #" << seedSet << " has a page outside of the network=" << seed.first);
+                ASSERT(seed.second >= 0.0, "Negative teleport weight=" << seed.second);
+                weights[index] += seed.second;
+                totalWeight += seed.second;
+            }
+            ASSERT(totalWeight > 0.0, "Teleport vector #" << seedSet << " has no weight");
+
+            for (auto const& weight : weights) {
+                resolved[seedSet].push_back(std::make_pair(weight.first, weight.second / totalWeight));
+            }
+            std::sort(resolved[seedSet].begin(), resolved[seedSet].end());
+        }
+        return resolved;
+    }
+
+    std::vector<std::vector<double>> computeRanks(CompiledNetwork const& compiled, std::vector<ResolvedTeleport> const& teleports, double alpha, uint32_t iterations, double tolerance) const
+    {
+        SweepArgs args;
+        args.size = compiled.getSize();
+        args.offsets = compiled.getOffsets().data();
+        args.sources = compiled.getSources().data();
+        args.inverseOutDegrees = compiled.getInverseOutDegrees().data();
+        args.alpha = alpha;
+
+        std::vector<std::vector<double>> results(teleports.size());
+        this->lastIterations.assign(teleports.size(), 0);
+        std::atomic<size_t> nextSeedSet(0);
+
+        this->pool->run([&](uint32_t) {
+            size_t rowsSize = static_cast<size_t>(args.size) * batchWidth;
+            std::vector<double> ranks(rowsSize, 0.0);
+            // Contributions (rank / out-degree) of iteration i are kept in contributionBuffers[i % 2]
+            std::vector<double> contributionBuffers[2] = { std::vector<double>(rowsSize, 0.0), std::vector<double>(rowsSize, 0.0) };
+            std::vector<Lane> lanes(batchWidth);
+            std::vector<std::vector<double>> oldSeedRanks(batchWidth);
+            double differences[batchWidth];
+            double dangleSums[batchWidth];
+
+            for (uint32_t lane = 0; lane < batchWidth; ++lane) {
+                this->startSeedSet(args, teleports, nextSeedSet, lane, lanes[lane], ranks, contributionBuffers[0]);
+            }
+
+            for (uint32_t i = 1; std::any_of(lanes.begin(), lanes.end(), [](Lane const& lane) { return lane.active; }); ++i) {
+                double const* previous = contributionBuffers[(i + 1) % 2].data();
+                double* next = contributionBuffers[i % 2].data();
+
+                for (uint32_t lane = 0; lane < batchWidth; ++lane) {
+                    oldSeedRanks[lane].clear();
+                    if (lanes[lane].active) {
+                        for (auto const& seed : teleports[lanes[lane].seedSet]) {
+                            oldSeedRanks[lane].push_back(ranks[static_cast<size_t>(seed.first) * batchWidth + lane]);
+                        }
+                    }
+                }
+
+                std::fill(differences, differences + batchWidth, 0.0);
+                std::fill(dangleSums, dangleSums + batchWidth, 0.0);
+                this->runSweep(args, previous, next, ranks.data(), differences, dangleSums);
+
+                for (uint32_t lane = 0; lane < batchWidth; ++lane) {
+                    Lane& state = lanes[lane];
+                    if (not state.active) {
+                        continue;
+                    }
+
+                    // The sweep leaves out random jumps, they only reach the pages of the teleport vector
+                    auto const& teleport = teleports[state.seedSet];
+                    for (size_t seed = 0; seed < teleport.size(); ++seed) {
+                        size_t row = static_cast<size_t>(teleport[seed].first) * batchWidth + lane;
+                        double inverseOutDegree = args.inverseOutDegrees[teleport[seed].first];
+                        double partialRank = ranks[row];
+                        double rank = partialRank + state.jump * teleport[seed].second;
+
+                        differences[lane] += std::abs(oldSeedRanks[lane][seed] - rank) - std::abs(oldSeedRanks[lane][seed] - partialRank);
+                        dangleSums[lane] += inverseOutDegree == 0.0 ? rank - partialRank : 0.0;
+                        ranks[row] = rank;
+                        next[row] = rank * inverseOutDegree;
+                    }
+
+                    state.iterations++;
+                    if (differences[lane] < tolerance) {
+                        this->finishSeedSet(args, lane, state, ranks, results);
+                        this->startSeedSet(args, teleports, nextSeedSet, lane, state, ranks, contributionBuffers[i % 2]);
+                    } else {
+                        ASSERT(state.iterations < iterations, "Not able to find result of seed set #" << state.seedSet << " in iterations=" << iterations);
+                        state.jump = (1.0 - alpha) + alpha * dangleSums[lane];
+                    }
+                }
+            }
+        });
+
+        return results;
+    }
+
+    // Takes the next pending seed set into the lane, the lane goes idle when there is none
+    static void startSeedSet(SweepArgs const& args, std::vector<ResolvedTeleport> const& teleports, std::atomic<size_t>& nextSeedSet,
+        uint32_t lane, Lane& state, std::vector<double>& ranks, std::vector<double>& contributions)
+    {
+        for (size_t row = lane; row < ranks.size(); row += batchWidth) {
+            ranks[row] = 0.0;
+            contributions[row] = 0.0;
+        }
+
+        state.seedSet = nextSeedSet.fetch_add(1);
+        state.active = state.seedSet < teleports.size();
+        state.iterations = 0;
+        if (not state.active) {
+            return;
+        }
+
+        // Iteration starts from the teleport vector
+        double dangleSum = 0.0;
+        for (auto const& seed : teleports[state.seedSet]) {
+            size_t row = static_cast<size_t>(seed.first) * batchWidth + lane;
+            ranks[row] = seed.second;
+            contributions[row] = seed.second * args.inverseOutDegrees[seed.first];
+            dangleSum += args.inverseOutDegrees[seed.first] == 0.0 ? seed.second : 0.0;
+        }
+        state.jump = (1.0 - args.alpha) + args.alpha * dangleSum;
+    }
+
+    void finishSeedSet(SweepArgs const& args, uint32_t lane, Lane const& state, std::vector<double> const& ranks, std::vector<std::vector<double>>& results) const
+    {
+        std::vector<double>& result = results[state.seedSet];
+        result.resize(args.size);
+        for (uint32_t page = 0; page < args.size; ++page) {
+            result[page] = ranks[static_cast<size_t>(page) * batchWidth + lane];
+        }
+        this->lastIterations[state.seedSet] = state.iterations;
+    }
+
+    void runSweep(SweepArgs const& args, double const* previous, double* next, double* ranks, double* differences, double* dangleSums) const
+    {
+#ifdef PAGE_RANK_HAS_X86_GATHERS
+        if (this->kernel == VectorizedPageRankComputer::Kernel::Avx512) {
+            return sweepAvx512(args, previous, next, ranks, differences, dangleSums);
+        }
+        if (this->kernel == VectorizedPageRankComputer::Kernel::Avx2) {
+            return sweepAvx2(args, previous, next, ranks, differences, dangleSums);
+        }
+#endif
+        sweepScalar(args, previous, next, ranks, differences, dangleSums);
+    }
+
+    // Shared tail of every sweep: ranks and contributions of the row of a page without random jumps
+    static void finishRow(SweepArgs const& args, double const* sums, uint32_t page, double* next, double* ranks, double* differences, double* dangleSums)
+    {
+        size_t row = static_cast<size_t>(page) * batchWidth;
+        double inverseOutDegree = args.inverseOutDegrees[page];
+        for (uint32_t lane = 0; lane < batchWidth; ++lane) {
+            double rank = args.alpha * sums[lane];
+            differences[lane] += std::abs(ranks[row + lane] - rank);
+            ranks[row + lane] = rank;
+            next[row + lane] = rank * inverseOutDegree;
+        }
+        if (inverseOutDegree == 0.0) {
+            for (uint32_t lane = 0; lane < batchWidth; ++lane) {
+                dangleSums[lane] += ranks[row + lane];
+            }
+        }
+    }
+
+    static void sweepScalar(SweepArgs const& args, double const* previous, double* next, double* ranks, double* differences, double* dangleSums)
+    {
+        double sums[batchWidth];
+        for (uint32_t page = 0; page < args.size; ++page) {
+            std::fill(sums, sums + batchWidth, 0.0);
+            for (uint64_t e = args.offsets[page]; e < args.offsets[page + 1]; ++e) {
+                double const* row = previous + static_cast<size_t>(args.sources[e]) * batchWidth;
+                for (uint32_t lane = 0; lane < batchWidth; ++lane) {
+                    sums[lane] += row[lane];
+                }
+            }
+            finishRow(args, sums, page, next, ranks, differences, dangleSums);
+        }
+    }
+
+#ifdef PAGE_RANK_HAS_X86_GATHERS
+    // A row of 8 doubles is one cache line: two AVX2 or one AVX-512 load per link
+    __attribute__((target("avx2"))) static void sweepAvx2(SweepArgs const& args, double const* previous, double* next, double* ranks, double* differences, double* dangleSums)
+    {
+        static_assert(batchWidth == 8, "AVX2 sweep expects rows of 8 doubles");
+        double sums[batchWidth];
+        for (uint32_t page = 0; page < args.size; ++page) {
+            __m256d low = _mm256_setzero_pd();
+            __m256d high = _mm256_setzero_pd();
+            for (uint64_t e = args.offsets[page]; e < args.offsets[page + 1]; ++e) {
+                double const* row = previous + static_cast<size_t>(args.sources[e]) * batchWidth;
+                low = _mm256_add_pd(low, _mm256_loadu_pd(row));
+                high = _mm256_add_pd(high, _mm256_loadu_pd(row + 4));
+            }
+            _mm256_storeu_pd(sums, low);
+            _mm256_storeu_pd(sums + 4, high);
+            finishRow(args, sums, page, next, ranks, differences, dangleSums);
+        }
+    }
+
+    __attribute__((target("avx512f"))) static void sweepAvx512(SweepArgs const& args, double const* previous, double* next, double* ranks, double* differences, double* dangleSums)
+    {
+        static_assert(batchWidth == 8, "AVX-512 sweep expects rows of 8 doubles");
+        double sums[batchWidth];
+        for (uint32_t page = 0; page < args.size; ++page) {
+            __m512d row = _mm512_setzero_pd();
+            for (uint64_t e = args.offsets[page]; e < args.offsets[page + 1]; ++e) {
+                row = _mm512_add_pd(row, _mm512_loadu_pd(previous + static_cast<size_t>(args.sources[e]) * batchWidth));
+            }
+            _mm512_storeu_pd(sums, row);
+            finishRow(args, sums, page, next, ranks, differences, dangleSums);
+        }
+    }
+#endif
+};
+
+#endif /* SRC_PERSONALIZEDPAGERANKCOMPUTER_HPP_ */
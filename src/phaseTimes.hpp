@@ -0,0 +1,55 @@
+#ifndef SRC_PHASETIMES_HPP_
+#define SRC_PHASETIMES_HPP_
+
+#include <chrono>
+
+#include "computationStats.hpp"
+
+// Seconds the phases of the last computation took: generating page ids,
+// building the compiled graph, iterating and materializing the result vector
+// (0 when only a RankView was asked for).
+struct PhaseTimes {
+    double hashing;
+    double build;
+    double iterations;
+    double output;
+};
+
+// Measures consecutive phases with the monotonic clock, lap() returns the
+// seconds since the previous lap (or since construction). Named laps are also
+// recorded as phases of the stats object, when one is given.
+class PhaseStopwatch {
+public:
+    PhaseStopwatch()
+        : PhaseStopwatch(nullptr)
+    {
+    }
+
+    PhaseStopwatch(ComputationStats* statsArg)
+        : stats(statsArg)
+        , last(std::chrono::steady_clock::now())
+    {
+    }
+
+    double lap()
+    {
+        return this->lap(nullptr);
+    }
+
+    double lap(char const* phase)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - this->last;
+        if (this->stats != nullptr && phase != nullptr) {
+            this->stats->addPhase(phase, this->stats->toSeconds(this->last), this->stats->toSeconds(now));
+        }
+        this->last = now;
+        return elapsed.count();
+    }
+
+private:
+    ComputationStats* stats;
+    std::chrono::steady_clock::time_point last;
+};
+
+#endif /* SRC_PHASETIMES_HPP_ */
@@ -0,0 +1,70 @@
+#ifndef SRC_RANKSTORAGE_HPP_
+#define SRC_RANKSTORAGE_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+// Storage types of the values streamed by the iteration. Arithmetic is always
+// done in double, values are only rounded when stored.
+enum class RankPrecision {
+    Double,
+    Float,
+    BFloat16
+};
+
+// Upper half of an IEEE single precision float: same range, 8 bits of mantissa
+struct BFloat16 {
+    uint16_t bits;
+};
+
+template <typename Storage>
+struct RankStorage;
+
+template <>
+struct RankStorage<double> {
+    static double store(double value)
+    {
+        return value;
+    }
+
+    static double load(double value)
+    {
+        return value;
+    }
+};
+
+template <>
+struct RankStorage<float> {
+    static float store(double value)
+    {
+        return static_cast<float>(value);
+    }
+
+    static double load(float value)
+    {
+        return value;
+    }
+};
+
+template <>
+struct RankStorage<BFloat16> {
+    // Rounds to nearest even, ranks are never NaN
+    static BFloat16 store(double value)
+    {
+        float single = static_cast<float>(value);
+        uint32_t bits;
+        std::memcpy(&bits, &single, sizeof(bits));
+        bits += 0x7fff + ((bits >> 16) & 1);
+        return BFloat16 { static_cast<uint16_t>(bits >> 16) };
+    }
+
+    static double load(BFloat16 value)
+    {
+        uint32_t bits = static_cast<uint32_t>(value.bits) << 16;
+        float single;
+        std::memcpy(&single, &bits, sizeof(single));
+        return single;
+    }
+};
+
+#endif /* SRC_RANKSTORAGE_HPP_ */
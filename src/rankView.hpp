@@ -0,0 +1,145 @@
+#ifndef SRC_RANKVIEW_HPP_
+#define SRC_RANKVIEW_HPP_
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "immutable/common.hpp"
+#include "immutable/pageIdAndRank.hpp"
+
+#include "pageIdTable.hpp"
+#include "workerPool.hpp"
+
+// Result of a computation: the rank array indexed by dense page index and the
+// table of page ids it refers to. Nothing is copied per page until a consumer
+// asks for it: topK selects the best pages, forEach streams (id, rank) pairs to
+// a sink in the order of the network and toVector builds the classic result.
+class RankView {
+public:
+    RankView(std::shared_ptr<PageIdTable const> pageIdsArg, std::vector<double>&& ranksArg)
+        : pageIds(std::move(pageIdsArg))
+        , ranks(std::move(ranksArg))
+    {
+        ASSERT(this->ranks.size() == this->pageIds->getSize(), "Invalid ranks size=" << this->ranks.size() << ", pages=" << this->pageIds->getSize());
+    }
+
+    uint32_t getSize() const
+    {
+        return static_cast<uint32_t>(this->ranks.size());
+    }
+
+    std::vector<double> const& getRanks() const
+    {
+        return this->ranks;
+    }
+
+    double getRank(uint32_t page) const
+    {
+        return this->ranks[page];
+    }
+
+    PageId getPageId(uint32_t page) const
+    {
+        return this->pageIds->getPageId(page);
+    }
+
+    PageIdTable const& getPageIds() const
+    {
+        return *this->pageIds;
+    }
+
+    // Calls sink(PageId const&, double) for every page, in the order of the network
+    template <typename Sink>
+    void forEach(Sink&& sink) const
+    {
+        for (uint32_t i = 0; i < this->getSize(); ++i) {
+            uint32_t page = this->pageIds->getCompiledIndex(i);
+            sink(this->pageIds->getPageId(page), this->ranks[page]);
+        }
+    }
+
+    // The k pages with the highest ranks, best first; equal ranks keep the dense page order
+    std::vector<PageIdAndRank> topK(size_t k) const
+    {
+        return this->toPageIdsAndRanks(this->selectTop(k, 0, this->ranks.size()));
+    }
+
+    // topK with the pages split between the threads of the pool, every thread
+    // keeps its own k best pages and their union is selected from once more
+    std::vector<PageIdAndRank> topK(size_t k, WorkerPool& pool) const
+    {
+        std::vector<std::vector<Entry>> candidates(pool.getNumThreads());
+        pool.run([&](uint32_t thread) {
+            auto range = WorkerPool::range(this->ranks.size(), thread, pool.getNumThreads());
+            candidates[thread] = this->selectTop(k, range.first, range.second);
+        });
+
+        std::vector<Entry> merged;
+        for (auto const& threadCandidates : candidates) {
+            merged.insert(merged.end(), threadCandidates.begin(), threadCandidates.end());
+        }
+        size_t count = std::min(k, merged.size());
+        std::partial_sort(merged.begin(), merged.begin() + count, merged.end(), isBetter);
+        merged.resize(count);
+        return this->toPageIdsAndRanks(merged);
+    }
+
+    // Classic result: every page with its rank, in the order of the network
+    std::vector<PageIdAndRank> toVector() const
+    {
+        std::vector<PageIdAndRank> result;
+        result.reserve(this->ranks.size());
+        this->forEach([&result](PageId const& pageId, double rank) {
+            result.push_back(PageIdAndRank(pageId, rank));
+        });
+        return result;
+    }
+
+private:
+    typedef std::pair<double, uint32_t> Entry; // rank, dense page index
+
+    std::shared_ptr<PageIdTable const> pageIds;
+    std::vector<double> ranks;
+
+    static bool isBetter(Entry const& first, Entry const& second)
+    {
+        return first.first > second.first || (first.first == second.first && first.second < second.second);
+    }
+
+    // Best k pages of [start, end) sorted best first, kept in a heap with the worst of them on top
+    std::vector<Entry> selectTop(size_t k, size_t start, size_t end) const
+    {
+        std::vector<Entry> heap;
+        if (k == 0) {
+            return heap;
+        }
+        heap.reserve(std::min(k, end - start));
+        for (size_t page = start; page < end; ++page) {
+            Entry entry(this->ranks[page], static_cast<uint32_t>(page));
+            if (heap.size() < k) {
+                heap.push_back(entry);
+                std::push_heap(heap.begin(), heap.end(), isBetter);
+            } else if (isBetter(entry, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), isBetter);
+                heap.back() = entry;
+                std::push_heap(heap.begin(), heap.end(), isBetter);
+            }
+        }
+        std::sort_heap(heap.begin(), heap.end(), isBetter);
+        return heap;
+    }
+
+    std::vector<PageIdAndRank> toPageIdsAndRanks(std::vector<Entry> const& entries) const
+    {
+        std::vector<PageIdAndRank> result;
+        result.reserve(entries.size());
+        for (auto const& entry : entries) {
+            result.push_back(PageIdAndRank(this->pageIds->getPageId(entry.second), entry.first));
+        }
+        return result;
+    }
+};
+
+#endif /* SRC_RANKVIEW_HPP_ */
@@ -0,0 +1,451 @@
+#ifndef SRC_SAMPLINGPROFILER_HPP_
+#define SRC_SAMPLINGPROFILER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cxxabi.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <elf.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "immutable/common.hpp"
+
+#include "computationStats.hpp"
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+// In-process sampling profiler. Every thread of the process gets its own POSIX
+// timer delivering SIGPROF to that very thread, the signal handler stores the
+// time and the stack of the interrupted code in preallocated slots.
+// Nothing stops the process, so multi-threaded timings stay what they are.
+//
+// Stacks are walked along frame pointers from the registers of the interrupted
+// code, within the mapping holding its stack, so the handler calls no unwinder.
+// Code built without -fno-omit-frame-pointer shows up with frames missing.
+//
+// Threads started after start() are not sampled: computers create their
+// worker pools in constructors, construct them before profiling. Samples are
+// written as collapsed stacks ("root;...;leaf count") that flamegraph.pl reads
+// directly. Given the ComputationStats of the profiled computation, samples are
+// grouped under the phase they were taken in, or limited to a single phase.
+class SamplingProfiler {
+public:
+    enum class Clock {
+        // Wall time, samples also threads waiting at barriers and shows where they block
+        Wall,
+        // CPU time of every thread. The kernel checks CPU timers on scheduler
+        // ticks, so the rate is capped at CONFIG_HZ (usually 250 or 1000 Hz).
+        Cpu
+    };
+
+    SamplingProfiler(uint32_t frequencyArg)
+        : SamplingProfiler(frequencyArg, Clock::Wall, 1 << 16)
+    {
+    }
+
+    SamplingProfiler(uint32_t frequencyArg, Clock clockArg, uint32_t capacityArg)
+        : frequency(frequencyArg)
+        , clock(clockArg)
+        , capacity(capacityArg)
+        , samples(new Sample[capacityArg])
+        , numSamples(0)
+        , numDropped(0)
+        , running(false)
+        , stackRegions()
+    {
+        ASSERT(frequencyArg > 0 && frequencyArg <= 100000, "Invalid sampling frequency=" << frequencyArg);
+    }
+
+    SamplingProfiler(SamplingProfiler const&) = delete;
+    SamplingProfiler& operator=(SamplingProfiler const&) = delete;
+
+    ~SamplingProfiler()
+    {
+        if (this->running) {
+            this->stop();
+        }
+    }
+
+    // Forgets samples of a previous run and starts sampling all current threads
+    void start()
+    {
+        SamplingProfiler* expected = nullptr;
+        ASSERT(not this->running && active().compare_exchange_strong(expected, this), "Another profiler is running");
+
+        this->stackRegions = listWritableRegions();
+        this->numSamples.store(0);
+        this->numDropped.store(0);
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = &SamplingProfiler::handleSignal;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        ASSERT(sigaction(SIGPROF, &action, &this->previousAction) == 0, "Cannot install SIGPROF handler, errno=" << errno);
+
+        long interval = 1000000000l / this->frequency;
+        for (pid_t thread : listThreads()) {
+            struct sigevent event;
+            std::memset(&event, 0, sizeof(event));
+            event.sigev_notify = SIGEV_THREAD_ID;
+            event.sigev_signo = SIGPROF;
+            event.sigev_notify_thread_id = thread;
+
+            timer_t timer;
+            // Per-thread CPU clock of any thread of the process, MAKE_THREAD_CPUCLOCK(thread, CPUCLOCK_SCHED) of the kernel
+            clockid_t timerClock = this->clock == Clock::Cpu ? static_cast<clockid_t>((~static_cast<clockid_t>(thread) << 3) | 6) : CLOCK_MONOTONIC;
+            if (timer_create(timerClock, &event, &timer) != 0) {
+                continue; // the thread has just exited
+            }
+            struct itimerspec period;
+            period.it_interval.tv_sec = interval / 1000000000l;
+            period.it_interval.tv_nsec = interval % 1000000000l;
+            period.it_value = period.it_interval;
+            ASSERT(timer_settime(timer, 0, &period, nullptr) == 0, "Cannot start sampling timer, errno=" << errno);
+            this->timers.push_back(timer);
+        }
+        this->running = true;
+    }
+
+    void stop()
+    {
+        ASSERT(this->running, "Profiler is not running");
+        for (timer_t timer : this->timers) {
+            timer_delete(timer);
+        }
+        this->timers.clear();
+        // Signals still pending are discarded before the previous handler is back
+        signal(SIGPROF, SIG_IGN);
+        active().store(nullptr);
+        while (inFlight().load() > 0) {
+            std::this_thread::yield();
+        }
+        sigaction(SIGPROF, &this->previousAction, nullptr);
+        this->running = false;
+    }
+
+    uint64_t getNumSamples() const
+    {
+        return std::min<uint64_t>(this->numSamples.load(), this->capacity);
+    }
+
+    // Samples not stored because all slots were taken
+    uint64_t getNumDropped() const
+    {
+        return this->numDropped.load();
+    }
+
+    void writeCollapsedStacks(std::ostream& out) const
+    {
+        this->writeCollapsedStacks(out, nullptr, "");
+    }
+
+    // With stats, every stack starts with the phase of the computation it was
+    // sampled in ("[other]" outside of phases); a non-empty phase keeps only
+    // the samples of that phase.
+    void writeCollapsedStacks(std::ostream& out, ComputationStats const* stats, std::string const& phase) const
+    {
+        ASSERT(not this->running, "Stacks can be written once the profiler is stopped");
+        std::map<void*, std::string> names = this->symbolize();
+
+        std::map<std::string, uint64_t> stacks;
+        for (uint64_t s = 0; s < this->getNumSamples(); ++s) {
+            Sample const& sample = this->samples[s];
+            std::string stack;
+            if (stats != nullptr) {
+                std::string samplePhase = findPhase(*stats, sample.time);
+                if (not phase.empty() && samplePhase != phase) {
+                    continue;
+                }
+                stack = "[" + (samplePhase.empty() ? std::string("other") : samplePhase) + "]";
+            }
+            for (uint32_t f = sample.depth; f-- > 0;) {
+                stack += (stack.empty() ? "" : ";") + names[frameAddress(sample, f)];
+            }
+            stacks[stack]++;
+        }
+        for (auto const& stack : stacks) {
+            out << stack.first << " " << stack.second << "\n";
+        }
+    }
+
+private:
+    static uint32_t const maxDepth = 64;
+
+    struct Sample {
+        uint64_t time; // nanoseconds of the steady clock
+        uint32_t depth;
+        void* frames[maxDepth]; // the interrupted instruction, then return addresses
+    };
+
+    // Writable mapping [begin, end) of the process
+    struct Region {
+        uintptr_t begin;
+        uintptr_t end;
+    };
+
+    uint32_t const frequency;
+    Clock const clock;
+    uint32_t const capacity;
+    std::unique_ptr<Sample[]> samples;
+    std::atomic<uint64_t> numSamples;
+    std::atomic<uint64_t> numDropped;
+    std::vector<timer_t> timers;
+    bool running;
+    struct sigaction previousAction;
+    std::vector<Region> stackRegions; // sorted, read by the signal handler
+
+    static std::atomic<SamplingProfiler*>& active()
+    {
+        static std::atomic<SamplingProfiler*> profiler(nullptr);
+        return profiler;
+    }
+
+    // Signal handlers that may still use the active profiler
+    static std::atomic<uint32_t>& inFlight()
+    {
+        static std::atomic<uint32_t> count(0);
+        return count;
+    }
+
+    // Only async-signal-safe calls: atomics, clock_gettime and reads of the interrupted stack
+    static void handleSignal(int, siginfo_t*, void* context)
+    {
+        int savedErrno = errno;
+        inFlight().fetch_add(1);
+        SamplingProfiler* profiler = active().load();
+        if (profiler != nullptr) {
+            profiler->record(context);
+        }
+        inFlight().fetch_sub(1);
+        errno = savedErrno;
+    }
+
+    void record(void* context)
+    {
+        uint64_t index = this->numSamples.fetch_add(1, std::memory_order_relaxed);
+        if (index >= this->capacity) {
+            this->numDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Sample& sample = this->samples[index];
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        sample.time = static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+        sample.depth = 0;
+
+        uintptr_t pc = 0;
+        uintptr_t sp = 0;
+        uintptr_t fp = 0;
+#if defined(__x86_64__)
+        mcontext_t const& registers = static_cast<ucontext_t*>(context)->uc_mcontext;
+        pc = static_cast<uintptr_t>(registers.gregs[REG_RIP]);
+        sp = static_cast<uintptr_t>(registers.gregs[REG_RSP]);
+        fp = static_cast<uintptr_t>(registers.gregs[REG_RBP]);
+#elif defined(__aarch64__)
+        mcontext_t const& registers = static_cast<ucontext_t*>(context)->uc_mcontext;
+        pc = static_cast<uintptr_t>(registers.pc);
+        sp = static_cast<uintptr_t>(registers.sp);
+        fp = static_cast<uintptr_t>(registers.regs[29]);
+#else
+        (void)context;
+#endif
+        if (pc == 0) {
+            return;
+        }
+        sample.frames[sample.depth++] = reinterpret_cast<void*>(pc);
+
+        // Every frame holds the caller's frame pointer and the return address.
+        // Frames grow towards the end of the mapping of the stack, anything
+        // else (code without frame pointers) ends the walk.
+        uintptr_t stackEnd = this->findRegionEnd(sp);
+        while (sample.depth < maxDepth && fp >= sp && fp % sizeof(uintptr_t) == 0 && fp < stackEnd && stackEnd - fp >= 2 * sizeof(uintptr_t)) {
+            uintptr_t const* frame = reinterpret_cast<uintptr_t const*>(fp);
+            if (frame[1] == 0) {
+                break;
+            }
+            sample.frames[sample.depth++] = reinterpret_cast<void*>(frame[1]);
+            if (frame[0] <= fp) {
+                break;
+            }
+            fp = frame[0];
+        }
+    }
+
+    // End of the writable mapping holding address, 0 when there is none
+    uintptr_t findRegionEnd(uintptr_t address) const
+    {
+        size_t first = 0;
+        size_t last = this->stackRegions.size();
+        while (first < last) {
+            size_t middle = first + (last - first) / 2;
+            if (this->stackRegions[middle].end <= address) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+        return first < this->stackRegions.size() && this->stackRegions[first].begin <= address ? this->stackRegions[first].end : 0;
+    }
+
+    // Stacks of the threads are among the writable mappings listed in /proc/self/maps
+    static std::vector<Region> listWritableRegions()
+    {
+        std::vector<Region> regions;
+        std::ifstream maps("/proc/self/maps");
+        ASSERT(maps.good(), "Cannot list mappings of the process");
+        std::string line;
+        while (std::getline(maps, line)) {
+            unsigned long begin = 0;
+            unsigned long end = 0;
+            char permissions[5] = { 0 };
+            if (std::sscanf(line.c_str(), "%lx-%lx %4s", &begin, &end, permissions) == 3 && permissions[0] == 'r' && permissions[1] == 'w') {
+                regions.push_back(Region { begin, end });
+            }
+        }
+        return regions;
+    }
+
+    static std::vector<pid_t> listThreads()
+    {
+        std::vector<pid_t> threads;
+        DIR* directory = opendir("/proc/self/task");
+        ASSERT(directory != nullptr, "Cannot list threads of the process");
+        while (struct dirent* entry = readdir(directory)) {
+            if (entry->d_name[0] != '.') {
+                threads.push_back(static_cast<pid_t>(std::atoi(entry->d_name)));
+            }
+        }
+        closedir(directory);
+        return threads;
+    }
+
+    // Return addresses point after the call, the call itself is one byte before
+    static void* frameAddress(Sample const& sample, uint32_t frame)
+    {
+        char* address = static_cast<char*>(sample.frames[frame]);
+        return frame == 0 ? address : address - 1;
+    }
+
+    static std::string findPhase(ComputationStats const& stats, uint64_t time)
+    {
+        std::chrono::steady_clock::time_point sampleTime { std::chrono::nanoseconds(time) };
+        double seconds = stats.toSeconds(sampleTime);
+        for (auto const& phase : stats.getPhases()) {
+            if (phase.start <= seconds && seconds < phase.end) {
+                return phase.name;
+            }
+        }
+        return "";
+    }
+
+    // Exported symbols are found by dladdr, functions of the executable itself
+    // by addr2line; what neither finds is shown as module+offset.
+    std::map<void*, std::string> symbolize() const
+    {
+        std::map<void*, std::string> names;
+        for (uint64_t s = 0; s < this->getNumSamples(); ++s) {
+            for (uint32_t f = 0; f < this->samples[s].depth; ++f) {
+                names[frameAddress(this->samples[s], f)] = "";
+            }
+        }
+
+        Dl_info self;
+        dladdr(reinterpret_cast<void*>(&SamplingProfiler::handleSignal), &self);
+        uintptr_t executableBias = isPositionIndependentExecutable() ? reinterpret_cast<uintptr_t>(self.dli_fbase) : 0;
+        std::vector<void*> executableAddresses;
+        for (auto& name : names) {
+            Dl_info info;
+            if (dladdr(name.first, &info) == 0) {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "%p", name.first);
+                name.second = buffer;
+                continue;
+            }
+            if (info.dli_sname != nullptr) {
+                name.second = demangle(info.dli_sname);
+            } else if (info.dli_fbase == self.dli_fbase) {
+                executableAddresses.push_back(name.first);
+            }
+            if (name.second.empty()) {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "+0x%zx", static_cast<size_t>(static_cast<char*>(name.first) - static_cast<char*>(info.dli_fbase)));
+                char const* module = info.dli_fname != nullptr ? std::strrchr(info.dli_fname, '/') : nullptr;
+                name.second = std::string(module != nullptr ? module + 1 : "??") + buffer;
+            }
+        }
+
+        // addr2line prints the function and the source line of every address
+        size_t const batch = 512;
+        for (size_t first = 0; first < executableAddresses.size(); first += batch) {
+            std::ostringstream command;
+            command << "addr2line -f -C -e /proc/" << getpid() << "/exe";
+            size_t last = std::min(first + batch, executableAddresses.size());
+            for (size_t a = first; a < last; ++a) {
+                command << " " << std::hex << "0x" << reinterpret_cast<uintptr_t>(executableAddresses[a]) - executableBias;
+            }
+            command << " 2>/dev/null";
+            FILE* pipe = popen(command.str().c_str(), "r");
+            if (pipe == nullptr) {
+                break;
+            }
+            char line[4096];
+            for (size_t a = first; a < last && std::fgets(line, sizeof(line), pipe) != nullptr; ++a) {
+                std::string function(line, std::strcspn(line, "\n"));
+                if (function != "??") {
+                    names[executableAddresses[a]] = function;
+                }
+                if (std::fgets(line, sizeof(line), pipe) == nullptr) {
+                    break;
+                }
+            }
+            pclose(pipe);
+        }
+
+        // Semicolons separate frames of collapsed stacks
+        for (auto& name : names) {
+            for (char& c : name.second) {
+                c = c == ';' ? ':' : c;
+            }
+        }
+        return names;
+    }
+
+    static std::string demangle(char const* symbol)
+    {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(symbol, nullptr, nullptr, &status);
+        std::string name = status == 0 && demangled != nullptr ? demangled : symbol;
+        std::free(demangled);
+        return name;
+    }
+
+    static bool isPositionIndependentExecutable()
+    {
+        Elf64_Ehdr header;
+        std::ifstream executable("/proc/self/exe", std::ios::binary);
+        executable.read(reinterpret_cast<char*>(&header), sizeof(header));
+        return executable.good() && header.e_type == ET_DYN;
+    }
+};
+
+#endif /* SRC_SAMPLINGPROFILER_HPP_ */
@@ -0,0 +1,437 @@
+#ifndef SRC_SHA256_HPP_
+#define SRC_SHA256_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SHA256_HAS_X86_LANES 1
+#include <immintrin.h>
+#endif
+
+// In-process SHA-256 (FIPS 180-4). Single messages are hashed with a plain
+// scalar compression function, batches are hashed several messages at a time,
+// one message per 32-bit SIMD lane (4 lanes with SSE4.1, 8 lanes with AVX2).
+class Sha256 {
+public:
+    typedef std::array<uint8_t, 32> Digest;
+
+    static Digest hash(std::string const& message)
+    {
+        return hash(message.data(), message.size());
+    }
+
+    static Digest hash(char const* data, size_t length)
+    {
+        uint32_t state[8];
+        initState(state);
+
+        uint8_t const* bytes = reinterpret_cast<uint8_t const*>(data);
+        size_t fullBlocks = length / blockSize;
+        for (size_t block = 0; block < fullBlocks; ++block) {
+            compress(state, bytes + block * blockSize);
+        }
+
+        uint8_t tail[2 * blockSize];
+        size_t tailBlocks = fillTail(tail, bytes, length);
+        for (size_t block = 0; block < tailBlocks; ++block) {
+            compress(state, tail + block * blockSize);
+        }
+
+        Digest digest;
+        storeState(state, digest.data());
+        return digest;
+    }
+
+    // Hashes every message of the batch, digests[i] belongs to messages[i].
+    // Messages are std::string pointers or views with data() and size().
+    template <typename Message>
+    static std::vector<Digest> hashMany(std::vector<Message> const& messages)
+    {
+        std::vector<Digest> digests(messages.size());
+
+        // Lanes of one group run for as many blocks as the longest message
+        // in the group, so messages of similar length are grouped together.
+        std::vector<size_t> order(messages.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&messages](size_t lhs, size_t rhs) {
+            return sizeOf(messages[lhs]) < sizeOf(messages[rhs]);
+        });
+
+        size_t lanes = laneCount();
+        size_t done = 0;
+#ifdef SHA256_HAS_X86_LANES
+        for (; lanes > 1 && done + lanes <= order.size(); done += lanes) {
+            LaneGroup group;
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                group.add(dataOf(messages[order[done + lane]]), sizeOf(messages[order[done + lane]]));
+            }
+
+            if (lanes == 8) {
+                hashGroupAvx2(group);
+            } else {
+                hashGroupSse4(group);
+            }
+
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                storeState(group.state[lane], digests[order[done + lane]].data());
+            }
+        }
+#endif
+        for (; done < order.size(); ++done) {
+            digests[order[done]] = hash(dataOf(messages[order[done]]), sizeOf(messages[order[done]]));
+        }
+
+        return digests;
+    }
+
+    static std::string toHex(Digest const& digest)
+    {
+        static char const* digits = "0123456789abcdef";
+        std::string result(2 * digest.size(), '0');
+        for (size_t i = 0; i < digest.size(); ++i) {
+            result[2 * i] = digits[digest[i] >> 4];
+            result[2 * i + 1] = digits[digest[i] & 0xf];
+        }
+        return result;
+    }
+
+    // Number of messages hashed together by hashMany on this CPU.
+    static size_t laneCount()
+    {
+#ifdef SHA256_HAS_X86_LANES
+        static size_t const lanes = __builtin_cpu_supports("avx2") ? 8 : (__builtin_cpu_supports("sse4.1") ? 4 : 1);
+        return lanes;
+#else
+        return 1;
+#endif
+    }
+
+private:
+    static size_t const blockSize = 64;
+    static size_t const maxLanes = 8;
+
+    static uint32_t const* roundConstants()
+    {
+        static uint32_t const k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+        return k;
+    }
+
+    static char const* dataOf(std::string const* message)
+    {
+        return message->data();
+    }
+
+    static size_t sizeOf(std::string const* message)
+    {
+        return message->size();
+    }
+
+    template <typename Message>
+    static char const* dataOf(Message const& message)
+    {
+        return message.data();
+    }
+
+    template <typename Message>
+    static size_t sizeOf(Message const& message)
+    {
+        return message.size();
+    }
+
+    static void initState(uint32_t* state)
+    {
+        static uint32_t const initial[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+        std::memcpy(state, initial, sizeof(initial));
+    }
+
+    static void storeState(uint32_t const* state, uint8_t* out)
+    {
+        for (size_t i = 0; i < 8; ++i) {
+            out[4 * i] = static_cast<uint8_t>(state[i] >> 24);
+            out[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16);
+            out[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8);
+            out[4 * i + 3] = static_cast<uint8_t>(state[i]);
+        }
+    }
+
+    static uint32_t loadBigEndian(uint8_t const* bytes)
+    {
+        return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16)
+            | (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+    }
+
+    // Writes the last partial block, the 0x80 terminator and the bit length
+    // into tail, returns the number of blocks written (1 or 2).
+    static size_t fillTail(uint8_t* tail, uint8_t const* bytes, size_t length)
+    {
+        size_t rest = length % blockSize;
+        size_t tailBlocks = rest + 9 > blockSize ? 2 : 1;
+
+        std::memset(tail, 0, tailBlocks * blockSize);
+        if (rest > 0) {
+            std::memcpy(tail, bytes + length - rest, rest);
+        }
+        tail[rest] = 0x80;
+
+        uint64_t bitLength = static_cast<uint64_t>(length) * 8;
+        uint8_t* end = tail + tailBlocks * blockSize;
+        for (size_t i = 1; i <= 8; ++i) {
+            end[-static_cast<ptrdiff_t>(i)] = static_cast<uint8_t>(bitLength >> (8 * (i - 1)));
+        }
+
+        return tailBlocks;
+    }
+
+    static uint32_t rotr(uint32_t x, uint32_t n)
+    {
+        return (x >> n) | (x << (32 - n));
+    }
+
+    static void compress(uint32_t* state, uint8_t const* block)
+    {
+        uint32_t const* k = roundConstants();
+        uint32_t w[64];
+        for (size_t t = 0; t < 16; ++t) {
+            w[t] = loadBigEndian(block + 4 * t);
+        }
+        for (size_t t = 16; t < 64; ++t) {
+            uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+            uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+            w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (size_t t = 0; t < 64; ++t) {
+            uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t temp1 = h + s1 + ch + k[t] + w[t];
+            uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t temp2 = s0 + maj;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+
+#ifdef SHA256_HAS_X86_LANES
+    // Messages hashed together, one per SIMD lane.
+    struct LaneGroup {
+        size_t size = 0;
+        size_t maxBlocks = 0;
+        uint8_t const* data[maxLanes];
+        size_t fullBlocks[maxLanes];
+        size_t totalBlocks[maxLanes];
+        uint8_t tail[maxLanes][2 * blockSize];
+        uint32_t state[maxLanes][8];
+
+        void add(char const* message, size_t length)
+        {
+            uint8_t const* bytes = reinterpret_cast<uint8_t const*>(message);
+            this->data[this->size] = bytes;
+            this->fullBlocks[this->size] = length / blockSize;
+            this->totalBlocks[this->size] = this->fullBlocks[this->size] + fillTail(this->tail[this->size], bytes, length);
+            this->maxBlocks = std::max(this->maxBlocks, this->totalBlocks[this->size]);
+            initState(this->state[this->size]);
+            this->size++;
+        }
+
+        // Block of the given lane, or nullptr when the lane is already finished.
+        uint8_t const* block(size_t lane, size_t index) const
+        {
+            if (index < this->fullBlocks[lane]) {
+                return this->data[lane] + index * blockSize;
+            }
+            if (index < this->totalBlocks[lane]) {
+                return this->tail[lane] + (index - this->fullBlocks[lane]) * blockSize;
+            }
+            return nullptr;
+        }
+
+        // Transposes message words so that words[t][lane] is word t of the lane's block,
+        // active[lane] is all ones for lanes that still have blocks to process.
+        void transpose(size_t index, uint32_t (*words)[maxLanes], uint32_t* active) const
+        {
+            for (size_t lane = 0; lane < this->size; ++lane) {
+                uint8_t const* bytes = this->block(lane, index);
+                active[lane] = bytes != nullptr ? 0xffffffffu : 0u;
+                for (size_t t = 0; t < 16; ++t) {
+                    words[t][lane] = bytes != nullptr ? loadBigEndian(bytes + 4 * t) : 0u;
+                }
+            }
+        }
+    };
+
+    __attribute__((target("sse4.1"))) static __m128i rotr128(__m128i x, int n)
+    {
+        return _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - n));
+    }
+
+    __attribute__((target("sse4.1"))) static void hashGroupSse4(LaneGroup& group)
+    {
+        uint32_t const* k = roundConstants();
+        alignas(16) uint32_t words[16][maxLanes];
+        alignas(16) uint32_t active[maxLanes];
+        alignas(16) uint32_t lanes[8][4];
+
+        __m128i state[8];
+        for (size_t i = 0; i < 8; ++i) {
+            for (size_t lane = 0; lane < 4; ++lane) {
+                lanes[i][lane] = group.state[lane][i];
+            }
+            state[i] = _mm_load_si128(reinterpret_cast<__m128i const*>(lanes[i]));
+        }
+
+        for (size_t index = 0; index < group.maxBlocks; ++index) {
+            group.transpose(index, words, active);
+
+            __m128i w[64];
+            for (size_t t = 0; t < 16; ++t) {
+                w[t] = _mm_load_si128(reinterpret_cast<__m128i const*>(words[t]));
+            }
+            for (size_t t = 16; t < 64; ++t) {
+                __m128i s0 = _mm_xor_si128(_mm_xor_si128(rotr128(w[t - 15], 7), rotr128(w[t - 15], 18)), _mm_srli_epi32(w[t - 15], 3));
+                __m128i s1 = _mm_xor_si128(_mm_xor_si128(rotr128(w[t - 2], 17), rotr128(w[t - 2], 19)), _mm_srli_epi32(w[t - 2], 10));
+                w[t] = _mm_add_epi32(_mm_add_epi32(w[t - 16], s0), _mm_add_epi32(w[t - 7], s1));
+            }
+
+            __m128i a = state[0], b = state[1], c = state[2], d = state[3];
+            __m128i e = state[4], f = state[5], g = state[6], h = state[7];
+            for (size_t t = 0; t < 64; ++t) {
+                __m128i s1 = _mm_xor_si128(_mm_xor_si128(rotr128(e, 6), rotr128(e, 11)), rotr128(e, 25));
+                __m128i ch = _mm_xor_si128(_mm_and_si128(e, f), _mm_andnot_si128(e, g));
+                __m128i temp1 = _mm_add_epi32(_mm_add_epi32(h, s1), _mm_add_epi32(ch, _mm_add_epi32(_mm_set1_epi32(static_cast<int>(k[t])), w[t])));
+                __m128i s0 = _mm_xor_si128(_mm_xor_si128(rotr128(a, 2), rotr128(a, 13)), rotr128(a, 22));
+                __m128i maj = _mm_xor_si128(_mm_xor_si128(_mm_and_si128(a, b), _mm_and_si128(a, c)), _mm_and_si128(b, c));
+                __m128i temp2 = _mm_add_epi32(s0, maj);
+
+                h = g;
+                g = f;
+                f = e;
+                e = _mm_add_epi32(d, temp1);
+                d = c;
+                c = b;
+                b = a;
+                a = _mm_add_epi32(temp1, temp2);
+            }
+
+            __m128i mask = _mm_load_si128(reinterpret_cast<__m128i const*>(active));
+            __m128i updated[8] = { a, b, c, d, e, f, g, h };
+            for (size_t i = 0; i < 8; ++i) {
+                state[i] = _mm_blendv_epi8(state[i], _mm_add_epi32(state[i], updated[i]), mask);
+            }
+        }
+
+        for (size_t i = 0; i < 8; ++i) {
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes[i]), state[i]);
+            for (size_t lane = 0; lane < 4; ++lane) {
+                group.state[lane][i] = lanes[i][lane];
+            }
+        }
+    }
+
+    __attribute__((target("avx2"))) static __m256i rotr256(__m256i x, int n)
+    {
+        return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+    }
+
+    __attribute__((target("avx2"))) static void hashGroupAvx2(LaneGroup& group)
+    {
+        uint32_t const* k = roundConstants();
+        alignas(32) uint32_t words[16][maxLanes];
+        alignas(32) uint32_t active[maxLanes];
+        alignas(32) uint32_t lanes[8][8];
+
+        __m256i state[8];
+        for (size_t i = 0; i < 8; ++i) {
+            for (size_t lane = 0; lane < 8; ++lane) {
+                lanes[i][lane] = group.state[lane][i];
+            }
+            state[i] = _mm256_load_si256(reinterpret_cast<__m256i const*>(lanes[i]));
+        }
+
+        for (size_t index = 0; index < group.maxBlocks; ++index) {
+            group.transpose(index, words, active);
+
+            __m256i w[64];
+            for (size_t t = 0; t < 16; ++t) {
+                w[t] = _mm256_load_si256(reinterpret_cast<__m256i const*>(words[t]));
+            }
+            for (size_t t = 16; t < 64; ++t) {
+                __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr256(w[t - 15], 7), rotr256(w[t - 15], 18)), _mm256_srli_epi32(w[t - 15], 3));
+                __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr256(w[t - 2], 17), rotr256(w[t - 2], 19)), _mm256_srli_epi32(w[t - 2], 10));
+                w[t] = _mm256_add_epi32(_mm256_add_epi32(w[t - 16], s0), _mm256_add_epi32(w[t - 7], s1));
+            }
+
+            __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+            __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+            for (size_t t = 0; t < 64; ++t) {
+                __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr256(e, 6), rotr256(e, 11)), rotr256(e, 25));
+                __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+                __m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(h, s1), _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(k[t])), w[t])));
+                __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr256(a, 2), rotr256(a, 13)), rotr256(a, 22));
+                __m256i maj = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)), _mm256_and_si256(b, c));
+                __m256i temp2 = _mm256_add_epi32(s0, maj);
+
+                h = g;
+                g = f;
+                f = e;
+                e = _mm256_add_epi32(d, temp1);
+                d = c;
+                c = b;
+                b = a;
+                a = _mm256_add_epi32(temp1, temp2);
+            }
+
+            __m256i mask = _mm256_load_si256(reinterpret_cast<__m256i const*>(active));
+            __m256i updated[8] = { a, b, c, d, e, f, g, h };
+            for (size_t i = 0; i < 8; ++i) {
+                state[i] = _mm256_blendv_epi8(state[i], _mm256_add_epi32(state[i], updated[i]), mask);
+            }
+        }
+
+        for (size_t i = 0; i < 8; ++i) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[i]), state[i]);
+            for (size_t lane = 0; lane < 8; ++lane) {
+                group.state[lane][i] = lanes[i][lane];
+            }
+        }
+    }
+#endif
+};
+
+#endif /* SRC_SHA256_HPP_ */
@@ -4,28 +4,25 @@
 #include "immutable/idGenerator.hpp"
 #include "immutable/pageId.hpp"
 
+#include "sha256.hpp"
+
 class Sha256IdGenerator : public IdGenerator {
 public:
+    using IdGenerator::generateIds;
+
     virtual PageId generateId(std::string const& content) const /*override*/
     {
-        return PageId(getCommandOutput("printf \"" + content + "\" | sha256sum"));
+        return PageId::fromBytes(Sha256::hash(content).data());
     }
 
-private:
-    const size_t buffer_size = 128;
-
-    std::string getCommandOutput(std::string const& command) const
+    virtual std::vector<PageId> generateIds(std::vector<PageContent> const& contents) const /*override*/
     {
-        char buffer[buffer_size];
-        std::string result = "";
-
-        FILE *file = popen(command.c_str(), "r");
-        while (fgets(buffer, buffer_size, file)) {
-            result += buffer;
+        std::vector<PageId> result;
+        result.reserve(contents.size());
+        for (auto const& digest : Sha256::hashMany(contents)) {
+            result.push_back(PageId::fromBytes(digest.data()));
         }
-        pclose(file);
-
-        return result.substr(0, result.length() - 4);
+        return result;
     }
 };
 
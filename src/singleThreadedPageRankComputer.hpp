@@ -1,88 +1,215 @@
 #ifndef SRC_SINGLETHREADEDPAGERANKCOMPUTER_HPP_
 #define SRC_SINGLETHREADEDPAGERANKCOMPUTER_HPP_
 
-#include <unordered_map>
-#include <unordered_set>
+#include <cmath>
+#include <memory>
 #include <vector>
 
 #include "immutable/network.hpp"
 #include "immutable/pageIdAndRank.hpp"
 #include "immutable/pageRankComputer.hpp"
 
+#include "compiledNetwork.hpp"
+#include "computationStats.hpp"
+#include "iterationMode.hpp"
+#include "phaseTimes.hpp"
+#include "rankView.hpp"
+
 class SingleThreadedPageRankComputer : public PageRankComputer {
 public:
-    SingleThreadedPageRankComputer() {};
+    SingleThreadedPageRankComputer()
+        : SingleThreadedPageRankComputer(IterationMode::Jacobi) {};
+
+    SingleThreadedPageRankComputer(IterationMode modeArg)
+        : mode(modeArg)
+        , lastIterations(0)
+        , lastPhaseTimes() {};
 
     std::vector<PageIdAndRank> computeForNetwork(Network const& network, double alpha, uint32_t iterations, double tolerance) const
     {
-        std::unordered_map<PageId, PageRank, PageIdHash> pageHashMap;
-        for (auto const& page : network.getPages()) {
-            page.generateId(network.getGenerator());
-            pageHashMap[page.getId()] = 1.0 / network.getSize();
-        }
+        RankView view = this->computeViewForNetwork(network, alpha, iterations, tolerance);
+        PhaseStopwatch stopwatch(this->stats.get());
+        std::vector<PageIdAndRank> result = view.toVector();
+        this->lastPhaseTimes.output = stopwatch.lap("output");
+
+        ASSERT(result.size() == network.getSize(), "Invalid result size=" << result.size() << ", for network" << network);
 
-        std::unordered_map<PageId, uint32_t, PageIdHash> numLinks;
-        for (auto page : network.getPages()) {
-            numLinks[page.getId()] = page.getLinks().size();
+        return result;
+    }
+
+    RankView computeViewForNetwork(Network const& network, double alpha, uint32_t iterations, double tolerance) const
+    {
+        if (this->stats) {
+            this->stats->begin(this->getName(), 1, iterations);
+        }
+        PhaseStopwatch stopwatch(this->stats.get());
+        network.generateIds(0, network.getSize());
+        this->lastPhaseTimes.hashing = stopwatch.lap("generateIds");
+        std::shared_ptr<CompiledNetwork> compiled(new CompiledNetwork(network));
+        this->lastPhaseTimes.build = stopwatch.lap("build");
+        if (this->stats) {
+            this->stats->addBytesAllocated(compiled->getAllocatedBytes());
         }
 
-        std::unordered_set<PageId, PageIdHash> danglingNodes;
-        for (auto page : network.getPages()) {
-            if (page.getLinks().size() == 0) {
-                danglingNodes.insert(page.getId());
-            }
+        std::vector<double> ranks = this->mode == IterationMode::InPlace
+            ? this->computeGaussSeidelRanks(*compiled, alpha, iterations, tolerance)
+            : this->computeJacobiRanks(*compiled, alpha, iterations, tolerance);
+        this->lastPhaseTimes.iterations = stopwatch.lap("iterations");
+        this->lastPhaseTimes.output = 0.0;
+        return RankView(compiled, std::move(ranks));
+    }
+
+    std::string getName() const
+    {
+        return this->mode == IterationMode::InPlace ? "SingleThreadedPageRankComputer[gauss-seidel]" : "SingleThreadedPageRankComputer";
+    }
+
+    // Number of iterations the last computation needed to converge
+    uint32_t getLastIterations() const
+    {
+        return this->lastIterations;
+    }
+
+    // Durations of the phases of the last computation
+    PhaseTimes getLastPhaseTimes() const
+    {
+        return this->lastPhaseTimes;
+    }
+
+    // Every following computation fills the given stats object, nullptr stops the collection
+    void attachStats(std::shared_ptr<ComputationStats> statsArg)
+    {
+        this->stats = statsArg;
+    }
+
+private:
+    IterationMode mode;
+    // Written by every computation, which is not reentrant
+    mutable uint32_t lastIterations;
+    mutable PhaseTimes lastPhaseTimes;
+    std::shared_ptr<ComputationStats> stats;
+
+    // Records an iteration of a single thread that processed all edges
+    void recordIteration(ThreadTimeline& timeline, uint32_t iteration, double start, double residual, uint64_t numEdges) const
+    {
+        if (this->stats) {
+            timeline.busy("sweep", iteration);
+            this->stats->addIteration(start, this->stats->now(), residual);
+            this->stats->addEdgesProcessed(numEdges);
         }
+    }
 
-        std::unordered_map<PageId, std::vector<PageId>, PageIdHash> edges;
-        for (auto page : network.getPages()) {
-            for (auto link : page.getLinks()) {
-                edges[link].push_back(page.getId());
-            }
+    std::vector<double> computeJacobiRanks(CompiledNetwork const& compiled, double alpha, uint32_t iterations, double tolerance) const
+    {
+        uint32_t size = compiled.getSize();
+        auto const& offsets = compiled.getOffsets();
+        auto const& sources = compiled.getSources();
+        auto const& inverseOutDegrees = compiled.getInverseOutDegrees();
+
+        std::vector<double> ranks(size, 1.0 / size);
+        std::vector<double> previousRanks(size);
+        ComputationStats* stats = this->stats.get();
+        ThreadTimeline timeline(stats, 0);
+        if (stats != nullptr) {
+            stats->addBytesAllocated(2 * size * sizeof(double));
         }
 
         for (uint32_t i = 0; i < iterations; ++i) {
-            std::unordered_map<PageId, PageRank, PageIdHash> previousPageHashMap = pageHashMap;
+            double iterationStart = stats != nullptr ? stats->now() : 0.0;
+            ranks.swap(previousRanks);
 
             double dangleSum = 0;
-            for (auto danglingNode : danglingNodes) {
-                dangleSum += previousPageHashMap[danglingNode];
+            for (auto danglingNode : compiled.getDanglingNodes()) {
+                dangleSum += previousRanks[danglingNode];
             }
             dangleSum = dangleSum * alpha;
 
-            double difference = 0;
-            for (auto& pageMapElem : pageHashMap) {
-                PageId pageId = pageMapElem.first;
-
-                double danglingWeight = 1.0 / network.getSize();
-                pageMapElem.second = dangleSum * danglingWeight + (1.0 - alpha) / network.getSize();
+            double danglingWeight = 1.0 / size;
+            double baseRank = dangleSum * danglingWeight + (1.0 - alpha) / size;
 
-                if (edges.count(pageId) > 0) {
-                    for (auto link : edges[pageId]) {
-                        pageMapElem.second += alpha * previousPageHashMap[link] / numLinks[link];
-                    }
+            double difference = 0;
+            for (uint32_t page = 0; page < size; ++page) {
+                double rank = baseRank;
+                for (uint64_t e = offsets[page]; e < offsets[page + 1]; ++e) {
+                    rank += alpha * previousRanks[sources[e]] * inverseOutDegrees[sources[e]];
                 }
-                difference += std::abs(previousPageHashMap[pageId] - pageHashMap[pageId]);
+                ranks[page] = rank;
+                difference += std::abs(previousRanks[page] - rank);
             }
-
+            this->recordIteration(timeline, i + 1, iterationStart, difference, sources.size());
 
             if (difference < tolerance) {
-                std::vector<PageIdAndRank> result;
-                for (auto iter : pageHashMap) {
-                    result.push_back(PageIdAndRank(iter.first, iter.second));
-                }
-
-                ASSERT(result.size() == network.getSize(), "Invalid result size=" << result.size() << ", for network" << network);
-                
-                return result;
+                this->lastIterations = i + 1;
+                return ranks;
             }
         }
 
         ASSERT(false, "Not able to find result in iterations=" << iterations);
+        return {};
     }
 
-    std::string getName() const
+    // Updates ranks in place, every page sees the new ranks of pages before it in
+    // the sweep. In-place updates do not keep the total mass consistent, an error of
+    // the mass would decay only with the rate alpha, so every sweep ends by scaling
+    // ranks to the mass implied by them: (1 - alpha) / (sum - alpha * (mass kept by
+    // links within the network + dangling mass)).
+    std::vector<double> computeGaussSeidelRanks(CompiledNetwork const& compiled, double alpha, uint32_t iterations, double tolerance) const
     {
-        return "SingleThreadedPageRankComputer";
+        uint32_t size = compiled.getSize();
+        auto const& offsets = compiled.getOffsets();
+        auto const& sources = compiled.getSources();
+        auto const& inverseOutDegrees = compiled.getInverseOutDegrees();
+
+        // Part of the rank of every page passed along links to pages within the network
+        std::vector<double> keptFractions(size, 0.0);
+        for (uint64_t e = 0; e < sources.size(); ++e) {
+            keptFractions[sources[e]] += inverseOutDegrees[sources[e]];
+        }
+
+        std::vector<double> ranks(size, 1.0 / size);
+        double dangleSum = compiled.getDanglingNodes().size() * (1.0 / size);
+        ComputationStats* stats = this->stats.get();
+        ThreadTimeline timeline(stats, 0);
+        if (stats != nullptr) {
+            stats->addBytesAllocated(2 * size * sizeof(double));
+        }
+
+        for (uint32_t i = 0; i < iterations; ++i) {
+            double iterationStart = stats != nullptr ? stats->now() : 0.0;
+            double difference = 0;
+            double rankSum = 0;
+            double keptSum = 0;
+            for (uint32_t page = 0; page < size; ++page) {
+                double rank = alpha * dangleSum / size + (1.0 - alpha) / size;
+                for (uint64_t e = offsets[page]; e < offsets[page + 1]; ++e) {
+                    rank += alpha * ranks[sources[e]] * inverseOutDegrees[sources[e]];
+                }
+                if (inverseOutDegrees[page] == 0.0) {
+                    dangleSum += rank - ranks[page];
+                }
+                difference += std::abs(ranks[page] - rank);
+                rankSum += rank;
+                keptSum += rank * keptFractions[page];
+                ranks[page] = rank;
+            }
+
+            double scale = (1.0 - alpha) / (rankSum - alpha * (keptSum + dangleSum));
+            for (auto& rank : ranks) {
+                rank *= scale;
+            }
+            dangleSum *= scale;
+            // Scaling changes the ranks by |scale - 1| * rankSum in total
+            difference += std::abs(scale - 1.0) * rankSum;
+            this->recordIteration(timeline, i + 1, iterationStart, difference, sources.size());
+
+            if (difference < tolerance) {
+                this->lastIterations = i + 1;
+                return ranks;
+            }
+        }
+
+        ASSERT(false, "Not able to find result in iterations=" << iterations);
+        return {};
     }
 };
 
@@ -0,0 +1,186 @@
+#ifndef SRC_SWISSTABLE_HPP_
+#define SRC_SWISSTABLE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Control bytes of an open-addressing table with no erase, probed a group of
+// 16 slots at a time: one byte per slot, empty, busy (claimed, entry being
+// written) or full, holding 7 bits of the hash of the entry. A probe compares
+// the tag with all bytes of a group at once and looks at entries only on a
+// match, so almost every miss is decided without touching the keys.
+// Payload of the slots is kept by the user of the table, the matches(slot)
+// and fill(slot) callbacks compare and write it.
+class SwissControl {
+public:
+    enum : uint8_t {
+        empty = 0x00,
+        busy = 0x01
+    };
+    enum : size_t { groupSize = 16 };
+    enum : size_t { notFound = SIZE_MAX };
+
+    // Room for maxSize entries with at most 7/8 of the slots taken
+    SwissControl(size_t maxSize)
+        : mask(numGroupsFor(maxSize) - 1)
+        , control(new std::atomic<uint8_t>[numGroupsFor(maxSize) * groupSize]())
+    {
+        static_assert(sizeof(std::atomic<uint8_t>) == 1, "Control bytes of a group are loaded at once");
+    }
+
+    size_t getCapacity() const
+    {
+        return (this->mask + 1) * groupSize;
+    }
+
+    bool isFull(size_t slot) const
+    {
+        return (this->control[slot].load(std::memory_order_acquire) & 0x80) != 0;
+    }
+
+    template <typename Matches>
+    size_t find(size_t hash, Matches const& matches) const
+    {
+        uint8_t tag = tagOf(hash);
+        for (Probe probe(hash, this->mask);; probe.next()) {
+            Group group(&this->control[probe.group * groupSize]);
+            for (uint32_t bits = group.match(tag); bits != 0; bits &= bits - 1) {
+                size_t slot = probe.group * groupSize + __builtin_ctz(bits);
+                if (matches(slot)) {
+                    return slot;
+                }
+            }
+            if (group.match(empty) != 0) {
+                return notFound;
+            }
+        }
+    }
+
+    // Slot of the entry for which matches(slot) holds, or a slot claimed for a
+    // new entry, written by fill(slot) before it is visible to other threads.
+    // The second member tells whether the entry is new. Safe to call from many
+    // threads at once, as long as no more than maxSize entries are inserted.
+    template <typename Matches, typename Fill>
+    std::pair<size_t, bool> insert(size_t hash, Matches const& matches, Fill const& fill)
+    {
+        uint8_t tag = tagOf(hash);
+        for (Probe probe(hash, this->mask);; probe.next()) {
+            size_t first = probe.group * groupSize;
+            while (true) {
+                // All decisions are made on one snapshot of the group. An entry being
+                // written may be the one inserted, wait for it.
+                Group group(&this->control[first]);
+                if (group.match(busy) != 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                for (uint32_t bits = group.match(tag); bits != 0; bits &= bits - 1) {
+                    size_t slot = first + __builtin_ctz(bits);
+                    if (matches(slot)) {
+                        return std::make_pair(slot, false);
+                    }
+                }
+
+                // Entries go only to the first empty slot of a group, so two threads
+                // inserting the same entry compete for the same slot
+                uint32_t empties = group.match(empty);
+                if (empties == 0) {
+                    break;
+                }
+                size_t slot = first + __builtin_ctz(empties);
+                uint8_t expected = empty;
+                if (this->control[slot].compare_exchange_strong(expected, busy, std::memory_order_acq_rel)) {
+                    fill(slot);
+                    this->control[slot].store(tag, std::memory_order_release);
+                    return std::make_pair(slot, true);
+                }
+            }
+        }
+    }
+
+private:
+    size_t mask; // number of groups - 1
+    std::unique_ptr<std::atomic<uint8_t>[]> control;
+
+    // Groups visited at triangular distances, every group of a power of two is visited
+    struct Probe {
+        size_t group;
+        size_t step;
+        size_t mask;
+
+        Probe(size_t hash, size_t maskArg)
+            : group(hash & maskArg)
+            , step(0)
+            , mask(maskArg)
+        {
+        }
+
+        void next()
+        {
+            this->step++;
+            this->group = (this->group + this->step) & this->mask;
+        }
+    };
+
+    static size_t numGroupsFor(size_t maxSize)
+    {
+        size_t numGroups = 1;
+        while (numGroups * groupSize * 7 < maxSize * 8 + 8) {
+            numGroups *= 2;
+        }
+        return numGroups;
+    }
+
+    // Highest bits of the hash, the lowest ones choose the group
+    static uint8_t tagOf(size_t hash)
+    {
+        return static_cast<uint8_t>(0x80 | (hash >> (8 * sizeof(size_t) - 7)));
+    }
+
+    // Control bytes of the 16 slots of a group, read at once
+    class Group {
+    public:
+        Group(std::atomic<uint8_t> const* control)
+#ifdef __SSE2__
+            : bytes(_mm_loadu_si128(reinterpret_cast<__m128i const*>(control)))
+#endif
+        {
+#ifndef __SSE2__
+            for (size_t i = 0; i < groupSize; ++i) {
+                this->bytes[i] = control[i].load(std::memory_order_relaxed);
+            }
+#endif
+        }
+
+        // Bit i set when the byte of the i-th slot equals value
+        uint32_t match(uint8_t value) const
+        {
+#ifdef __SSE2__
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(this->bytes, _mm_set1_epi8(static_cast<char>(value)))));
+#else
+            uint32_t bits = 0;
+            for (size_t i = 0; i < groupSize; ++i) {
+                bits |= (this->bytes[i] == value ? 1u : 0u) << i;
+            }
+            return bits;
+#endif
+        }
+
+    private:
+#ifdef __SSE2__
+        __m128i bytes;
+#else
+        uint8_t bytes[groupSize];
+#endif
+    };
+};
+
+#endif /* SRC_SWISSTABLE_HPP_ */
@@ -0,0 +1,501 @@
+#ifndef SRC_SYNTHETICGRAPHGENERATOR_HPP_
+#define SRC_SYNTHETICGRAPHGENERATOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "immutable/common.hpp"
+#include "immutable/idGenerator.hpp"
+#include "immutable/network.hpp"
+
+#include "binaryNetwork.hpp"
+#include "compiledNetwork.hpp"
+#include "workerPool.hpp"
+
+// xoshiro256** seeded by splitmix64: fast, and the same sequence on every
+// platform and standard library.
+class SyntheticRandom {
+public:
+    SyntheticRandom(uint64_t seed)
+    {
+        for (auto& word : this->state) {
+            seed += 0x9e3779b97f4a7c15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t operator()()
+    {
+        uint64_t result = rotate(this->state[1] * 5, 7) * 9;
+        uint64_t t = this->state[1] << 17;
+        this->state[2] ^= this->state[0];
+        this->state[3] ^= this->state[1];
+        this->state[1] ^= this->state[2];
+        this->state[0] ^= this->state[3];
+        this->state[2] ^= t;
+        this->state[3] = rotate(this->state[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, 1)
+    double uniform()
+    {
+        return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    uint64_t state[4];
+
+    static uint64_t rotate(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+// Synthetic graph for benchmarks, produced as a stream of edges split into
+// chunks. A chunk depends only on the seed and its number, so the graph is the
+// same however many threads generate it and in whatever order. Page i stands
+// for a page with content std::to_string(i).
+class SyntheticGraphGenerator {
+public:
+    typedef std::pair<uint32_t, uint32_t> Edge; // source (linking page), target
+
+    virtual uint32_t getNumPages() const = 0;
+
+    virtual uint64_t getNumChunks() const = 0;
+
+    // Replaces edges with the edges of the chunk
+    virtual void generateChunk(uint64_t chunk, std::vector<Edge>& edges) const = 0;
+
+    virtual std::string getName() const = 0;
+
+    virtual ~SyntheticGraphGenerator() {};
+
+protected:
+    static SyntheticRandom chunkRandom(uint64_t seed, uint64_t chunk)
+    {
+        return SyntheticRandom(seed ^ (chunk * 0xd1342543de82ef95ull));
+    }
+};
+
+// Bijection of [0, size) scattering generated page numbers over the network,
+// so that popular pages are not the ones with the lowest numbers.
+class PagePermutation {
+public:
+    PagePermutation(uint32_t sizeArg, uint64_t seed)
+        : size(std::max(1u, sizeArg))
+        , multiplier(0x9e3779b97f4a7c15ull % this->size | 1)
+        , offset(seed % this->size)
+    {
+        while (gcd(this->multiplier, this->size) != 1) {
+            this->multiplier += 2;
+        }
+    }
+
+    uint32_t operator()(uint32_t page) const
+    {
+        return static_cast<uint32_t>((page * this->multiplier + this->offset) % this->size);
+    }
+
+private:
+    uint64_t size;
+    uint64_t multiplier;
+    uint64_t offset;
+
+    static uint64_t gcd(uint64_t a, uint64_t b)
+    {
+        return b == 0 ? a : gcd(b, a % b);
+    }
+};
+
+// Stochastic Kronecker graph (Leskovec et al.): the edge of every page pair is
+// drawn by descending levels times into one cell of the n x n initiator matrix
+// of probabilities. Pages beyond numPages and self-links are drawn again.
+class KroneckerGraphGenerator : public SyntheticGraphGenerator {
+public:
+    KroneckerGraphGenerator(std::vector<double> const& initiatorArg, uint32_t numPagesArg, double edgeFactorArg, uint64_t seedArg)
+        : initiator(initiatorArg)
+        , order(static_cast<uint32_t>(std::lround(std::sqrt(initiatorArg.size()))))
+        , levels(0)
+        , numPages(numPagesArg)
+        , numEdges(static_cast<uint64_t>(edgeFactorArg * numPagesArg))
+        , seed(seedArg)
+        , permutation(numPagesArg, seedArg)
+    {
+        ASSERT(this->order >= 2 && this->order * this->order == this->initiator.size(), "Initiator has to be a square matrix, size=" << this->initiator.size());
+        ASSERT(this->numPages >= 2, "Kronecker graph needs at least two pages");
+
+        double sum = 0.0;
+        for (auto probability : this->initiator) {
+            ASSERT(probability >= 0.0, "Invalid initiator probability=" << probability);
+            sum += probability;
+        }
+        double cumulative = 0.0;
+        for (auto probability : this->initiator) {
+            cumulative += probability / sum;
+            this->thresholds.push_back(static_cast<uint32_t>(cumulative * 65536.0));
+        }
+        this->thresholds.back() = 1 << 16;
+        for (uint32_t cell = 0; cell < this->initiator.size(); ++cell) {
+            this->cellRows.push_back(cell / this->order);
+            this->cellColumns.push_back(cell % this->order);
+        }
+
+        for (uint64_t span = 1; span < this->numPages; span *= this->order) {
+            this->levels++;
+        }
+    }
+
+    virtual uint32_t getNumPages() const /*override*/
+    {
+        return this->numPages;
+    }
+
+    virtual uint64_t getNumChunks() const /*override*/
+    {
+        return (this->numEdges + edgesPerChunk - 1) / edgesPerChunk;
+    }
+
+    virtual void generateChunk(uint64_t chunk, std::vector<Edge>& edges) const /*override*/
+    {
+        SyntheticRandom random = chunkRandom(this->seed, chunk);
+        uint64_t count = std::min<uint64_t>(edgesPerChunk, this->numEdges - chunk * edgesPerChunk);
+        edges.clear();
+        edges.reserve(count);
+        while (edges.size() < count) {
+            uint64_t source = 0;
+            uint64_t target = 0;
+            // Every 64-bit random number chooses the cells of four levels
+            uint64_t bits = 0;
+            for (uint32_t level = 0; level < this->levels; ++level) {
+                bits = level % 4 == 0 ? random() : bits >> 16;
+                uint32_t u = bits & 0xffff;
+                // Counted without branches, they would be mispredicted at every level
+                uint32_t cell = 0;
+                for (size_t i = 0; i + 1 < this->thresholds.size(); ++i) {
+                    cell += u >= this->thresholds[i];
+                }
+                source = source * this->order + this->cellRows[cell];
+                target = target * this->order + this->cellColumns[cell];
+            }
+            if (source < this->numPages && target < this->numPages && source != target) {
+                edges.push_back(Edge(this->permutation(static_cast<uint32_t>(source)), this->permutation(static_cast<uint32_t>(target))));
+            }
+        }
+    }
+
+    virtual std::string getName() const /*override*/
+    {
+        return "kronecker" + std::to_string(this->order);
+    }
+
+private:
+    enum : uint64_t {
+        edgesPerChunk = 1 << 16
+    };
+
+    std::vector<double> initiator;
+    std::vector<uint32_t> thresholds; // cumulative probabilities of the cells scaled to 2^16
+    std::vector<uint32_t> cellRows;
+    std::vector<uint32_t> cellColumns;
+    uint32_t order;
+    uint32_t levels;
+    uint32_t numPages;
+    uint64_t numEdges;
+    uint64_t seed;
+    PagePermutation permutation;
+};
+
+// R-MAT (Chakrabarti et al.): Kronecker graph with a 2 x 2 initiator, the
+// defaults are the Graph500 probabilities.
+class RmatGraphGenerator : public KroneckerGraphGenerator {
+public:
+    RmatGraphGenerator(uint32_t numPagesArg, double edgeFactorArg, uint64_t seedArg, double a = 0.57, double b = 0.19, double c = 0.19)
+        : KroneckerGraphGenerator({ a, b, c, 1.0 - a - b - c }, numPagesArg, edgeFactorArg, seedArg)
+    {
+    }
+
+    virtual std::string getName() const /*override*/
+    {
+        return "rmat";
+    }
+};
+
+// Pages with power-law out-degrees (exponent outExponent > 2, average
+// averageDegree) linking to targets chosen with Zipf probabilities, which
+// gives power-law in-degrees with exponent inExponent. A danglingFraction of
+// the pages has no links. Chunks are ranges of linking pages, so edges come
+// grouped by their source.
+class PowerLawGraphGenerator : public SyntheticGraphGenerator {
+public:
+    PowerLawGraphGenerator(uint32_t numPagesArg, double averageDegreeArg, uint64_t seedArg, double outExponentArg = 2.5, double inExponentArg = 2.1,
+        double danglingFractionArg = 0.1)
+        : numPages(numPagesArg)
+        , averageDegree(averageDegreeArg)
+        , outExponent(outExponentArg)
+        , zipfExponent(1.0 / (inExponentArg - 1.0))
+        , danglingFraction(danglingFractionArg)
+        , seed(seedArg)
+        , permutation(numPagesArg, seedArg + 1)
+    {
+        ASSERT(outExponentArg > 2.0, "Out-degree exponent has to be above 2 for a finite average, exponent=" << outExponentArg);
+        ASSERT(inExponentArg > 1.0, "Invalid in-degree exponent=" << inExponentArg);
+        ASSERT(danglingFractionArg >= 0.0 && danglingFractionArg < 1.0, "Invalid fraction of dangling pages=" << danglingFractionArg);
+    }
+
+    virtual uint32_t getNumPages() const /*override*/
+    {
+        return this->numPages;
+    }
+
+    virtual uint64_t getNumChunks() const /*override*/
+    {
+        return (this->numPages + pagesPerChunk - 1) / pagesPerChunk;
+    }
+
+    virtual void generateChunk(uint64_t chunk, std::vector<Edge>& edges) const /*override*/
+    {
+        SyntheticRandom random = chunkRandom(this->seed, chunk);
+        // Pareto distribution with the given average over pages with links: minimum * (1 - u)^(-1 / (exponent - 1))
+        double minimumDegree = this->averageDegree / (1.0 - this->danglingFraction) * (this->outExponent - 2.0) / (this->outExponent - 1.0);
+        uint32_t start = static_cast<uint32_t>(chunk * pagesPerChunk);
+        uint32_t end = static_cast<uint32_t>(std::min<uint64_t>(this->numPages, start + pagesPerChunk));
+
+        edges.clear();
+        for (uint32_t source = start; source < end; ++source) {
+            if (random.uniform() < this->danglingFraction) {
+                continue;
+            }
+            double degree = minimumDegree * std::pow(1.0 - random.uniform(), -1.0 / (this->outExponent - 1.0));
+            // Rounding up with the probability of the fraction keeps the average
+            uint64_t numLinks = std::min<uint64_t>(this->numPages - 1, static_cast<uint64_t>(std::min(degree + random.uniform(), 4e9)));
+            for (uint64_t link = 0; link < numLinks;) {
+                uint32_t target = this->permutation(this->sampleRank(random));
+                if (target != source) {
+                    edges.push_back(Edge(source, target));
+                    link++;
+                }
+            }
+        }
+    }
+
+    virtual std::string getName() const /*override*/
+    {
+        return "powerlaw";
+    }
+
+private:
+    enum : uint64_t {
+        pagesPerChunk = 1 << 12
+    };
+
+    uint32_t numPages;
+    double averageDegree;
+    double outExponent;
+    double zipfExponent;
+    double danglingFraction;
+    uint64_t seed;
+    PagePermutation permutation;
+
+    // Popularity rank r in [0, numPages) with probability proportional to (r + 1)^-zipfExponent,
+    // by inverting the continuous distribution on [1, numPages + 1)
+    uint32_t sampleRank(SyntheticRandom& random) const
+    {
+        double u = random.uniform();
+        double n = this->numPages + 1.0;
+        double x = std::abs(this->zipfExponent - 1.0) < 1e-9
+            ? std::pow(n, u)
+            : std::pow((std::pow(n, 1.0 - this->zipfExponent) - 1.0) * u + 1.0, 1.0 / (1.0 - this->zipfExponent));
+        return std::min(this->numPages - 1, static_cast<uint32_t>(x - 1.0));
+    }
+};
+
+// Destinations of generated graphs: a Network, a compiled network built
+// straight from the edges, a binary network file or a raw edge list file.
+class SyntheticGraphWriter {
+public:
+    typedef SyntheticGraphGenerator::Edge Edge;
+
+    // Pages without ids, links to pages with ids of the given generator. Keeps
+    // all edges in memory, meant for networks fed to the computers.
+    static Network toNetwork(SyntheticGraphGenerator const& generator, IdGenerator const& idGenerator, WorkerPool& pool)
+    {
+        uint32_t size = generator.getNumPages();
+        std::vector<PageId> ids = generatePageIds(size, idGenerator, pool);
+
+        std::vector<std::vector<Edge>> chunks(generator.getNumChunks());
+        forEachChunk(generator, pool, [&chunks](uint64_t chunk, std::vector<Edge>& edges) {
+            chunks[chunk].swap(edges);
+        });
+
+        // Links of every page in the order they were generated
+        std::vector<uint64_t> linkOffsets(size + 1, 0);
+        for (auto const& edges : chunks) {
+            for (auto const& edge : edges) {
+                linkOffsets[edge.first + 1]++;
+            }
+        }
+        for (uint32_t page = 0; page < size; ++page) {
+            linkOffsets[page + 1] += linkOffsets[page];
+        }
+        std::vector<uint64_t> position(linkOffsets.begin(), linkOffsets.end() - 1);
+        std::vector<uint32_t> targets(linkOffsets[size]);
+        for (auto& edges : chunks) {
+            for (auto const& edge : edges) {
+                targets[position[edge.first]++] = edge.second;
+            }
+            std::vector<Edge>().swap(edges);
+        }
+
+        // Every thread fills an arena with its range of pages, the network takes them over in order
+        std::vector<PageArena> arenas(pool.getNumThreads());
+        std::vector<std::vector<Page>> pages(pool.getNumThreads());
+        pool.run([&](uint32_t thread) {
+            auto range = WorkerPool::range(size, thread, pool.getNumThreads());
+            pages[thread].reserve(range.second - range.first);
+            std::vector<PageId> links;
+            for (size_t page = range.first; page < range.second; ++page) {
+                links.clear();
+                for (uint64_t e = linkOffsets[page]; e < linkOffsets[page + 1]; ++e) {
+                    links.push_back(ids[targets[e]]);
+                }
+                std::string content = std::to_string(page);
+                pages[thread].push_back(arenas[thread].addPage(content.data(), content.size(), links.data(), links.size()));
+            }
+        });
+
+        Network network(idGenerator);
+        network.reserve(size);
+        for (uint32_t thread = 0; thread < pool.getNumThreads(); ++thread) {
+            network.addPages(std::move(arenas[thread]), std::move(pages[thread]));
+        }
+        return network;
+    }
+
+    // Builds the reverse-edge CSR without materializing the edge list: chunks
+    // are generated once to count degrees and once more to scatter the sources.
+    static std::shared_ptr<CompiledNetwork> toCompiledNetwork(SyntheticGraphGenerator const& generator, IdGenerator const& idGenerator, WorkerPool& pool)
+    {
+        uint32_t size = generator.getNumPages();
+        std::vector<std::atomic<uint64_t>> counts(size);
+        std::vector<std::atomic<uint32_t>> outDegrees(size);
+        pool.run([&](uint32_t thread) {
+            auto range = WorkerPool::range(size, thread, pool.getNumThreads());
+            for (size_t page = range.first; page < range.second; ++page) {
+                counts[page].store(0, std::memory_order_relaxed);
+                outDegrees[page].store(0, std::memory_order_relaxed);
+            }
+        });
+
+        forEachChunk(generator, pool, [&](uint64_t, std::vector<Edge>& edges) {
+            for (auto const& edge : edges) {
+                outDegrees[edge.first].fetch_add(1, std::memory_order_relaxed);
+                counts[edge.second].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        std::vector<uint64_t> offsets(size + 1, 0);
+        for (uint32_t page = 0; page < size; ++page) {
+            offsets[page + 1] = offsets[page] + counts[page].load(std::memory_order_relaxed);
+            counts[page].store(offsets[page], std::memory_order_relaxed);
+        }
+
+        std::vector<uint32_t> sources(offsets[size]);
+        forEachChunk(generator, pool, [&](uint64_t, std::vector<Edge>& edges) {
+            for (auto const& edge : edges) {
+                sources[counts[edge.second].fetch_add(1, std::memory_order_relaxed)] = edge.first;
+            }
+        });
+
+        // Sources of every page sorted, as in a network compiled from pages
+        std::vector<uint32_t> plainOutDegrees(size);
+        pool.run([&](uint32_t thread) {
+            auto range = WorkerPool::range(size, thread, pool.getNumThreads());
+            for (size_t page = range.first; page < range.second; ++page) {
+                std::sort(sources.begin() + offsets[page], sources.begin() + offsets[page + 1]);
+                plainOutDegrees[page] = outDegrees[page].load(std::memory_order_relaxed);
+            }
+        });
+
+        return std::shared_ptr<CompiledNetwork>(new CompiledNetwork(generatePageIds(size, idGenerator, pool), std::move(offsets), std::move(sources), std::move(plainOutDegrees)));
+    }
+
+    static void writeBinaryNetwork(SyntheticGraphGenerator const& generator, IdGenerator const& idGenerator, WorkerPool& pool, std::string const& path)
+    {
+        BinaryNetwork::write(*toCompiledNetwork(generator, idGenerator, pool), path);
+    }
+
+    // Streams the edges to path as native (little endian) uint32_t pairs
+    // (source, target), one round of chunks per pool run. Returns the number of edges.
+    static uint64_t writeEdgeList(SyntheticGraphGenerator const& generator, WorkerPool& pool, std::string const& path)
+    {
+        static_assert(sizeof(Edge) == 2 * sizeof(uint32_t), "Edges have to be written as two uint32_t");
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        ASSERT(out.good(), "Cannot open " << path << " for writing");
+
+        uint32_t numThreads = pool.getNumThreads();
+        uint64_t numChunks = generator.getNumChunks();
+        std::vector<std::vector<Edge>> buffers(numThreads);
+        uint64_t numEdges = 0;
+        for (uint64_t first = 0; first < numChunks; first += numThreads) {
+            pool.run([&](uint32_t thread) {
+                buffers[thread].clear();
+                if (first + thread < numChunks) {
+                    generator.generateChunk(first + thread, buffers[thread]);
+                }
+            });
+            for (auto const& edges : buffers) {
+                out.write(reinterpret_cast<char const*>(edges.data()), static_cast<std::streamsize>(edges.size() * sizeof(Edge)));
+                numEdges += edges.size();
+            }
+        }
+
+        ASSERT(out.good(), "Writing " << path << " failed");
+        return numEdges;
+    }
+
+private:
+    // Calls consume(chunk, edges) for every chunk, chunks are taken by the threads dynamically
+    template <typename Consume>
+    static void forEachChunk(SyntheticGraphGenerator const& generator, WorkerPool& pool, Consume const& consume)
+    {
+        std::atomic<uint64_t> nextChunk(0);
+        pool.run([&](uint32_t) {
+            std::vector<Edge> edges;
+            for (uint64_t chunk = nextChunk++; chunk < generator.getNumChunks(); chunk = nextChunk++) {
+                generator.generateChunk(chunk, edges);
+                consume(chunk, edges);
+            }
+        });
+    }
+
+    static std::vector<PageId> generatePageIds(uint32_t size, IdGenerator const& idGenerator, WorkerPool& pool)
+    {
+        std::vector<PageId> ids(size);
+        pool.run([&](uint32_t thread) {
+            auto range = WorkerPool::range(size, thread, pool.getNumThreads());
+            std::vector<std::string> contents;
+            contents.reserve(range.second - range.first);
+            std::vector<std::string const*> pointers;
+            for (size_t page = range.first; page < range.second; ++page) {
+                contents.push_back(std::to_string(page));
+                pointers.push_back(&contents.back());
+            }
+            std::vector<PageId> rangeIds = idGenerator.generateIds(pointers);
+            std::copy(rangeIds.begin(), rangeIds.end(), ids.begin() + range.first);
+        });
+        return ids;
+    }
+};
+
+#endif /* SRC_SYNTHETICGRAPHGENERATOR_HPP_ */
@@ -0,0 +1,63 @@
+#ifndef SRC_TEXTNETWORKREADER_HPP_
+#define SRC_TEXTNETWORKREADER_HPP_
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "immutable/network.hpp"
+
+// Reads the line-oriented text format of the e2e tests: the number of pages,
+// then two lines per page, its content and its space separated links (hex page ids).
+class TextNetworkReader {
+public:
+    static uint32_t readSize(std::istream& in)
+    {
+        std::string numberOfNodesStr;
+        std::getline(in, numberOfNodesStr);
+        return std::stoul(numberOfNodesStr);
+    }
+
+    static Network readPages(std::istream& in, uint32_t numberOfNodes, IdGenerator const& idGenerator)
+    {
+        Network network(idGenerator);
+        network.reserve(numberOfNodes);
+
+        // Lines and links are parsed into buffers reused by every page
+        std::string content;
+        std::string edges;
+        std::vector<PageId> links;
+        for (uint32_t i = 0; i < numberOfNodes; ++i) {
+            // Failed reads at the end of input leave the buffers untouched
+            content.clear();
+            edges.clear();
+            std::getline(in, content);
+            std::getline(in, edges);
+
+            links.clear();
+            size_t position = 0;
+            while (true) {
+                position = edges.find_first_not_of(" \t\r", position);
+                if (position == std::string::npos) {
+                    break;
+                }
+                size_t end = std::min(edges.find_first_of(" \t\r", position), edges.size());
+                links.push_back(PageId(edges.data() + position, end - position));
+                position = end;
+            }
+            network.addPage(content.data(), content.size(), links.data(), links.size());
+        }
+
+        return network;
+    }
+
+    static Network read(std::istream& in, IdGenerator const& idGenerator)
+    {
+        uint32_t numberOfNodes = readSize(in);
+        return readPages(in, numberOfNodes, idGenerator);
+    }
+};
+
+#endif /* SRC_TEXTNETWORKREADER_HPP_ */
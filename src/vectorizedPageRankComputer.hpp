@@ -0,0 +1,471 @@
+#ifndef SRC_VECTORIZEDPAGERANKCOMPUTER_HPP_
+#define SRC_VECTORIZEDPAGERANKCOMPUTER_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PAGE_RANK_HAS_X86_GATHERS 1
+#include <immintrin.h>
+#endif
+
+#include "immutable/network.hpp"
+#include "immutable/pageIdAndRank.hpp"
+#include "immutable/pageRankComputer.hpp"
+
+#include "binaryNetwork.hpp"
+#include "compiledNetwork.hpp"
+#include "computationStats.hpp"
+#include "csrGraph.hpp"
+#include "edgeBalancedScheduler.hpp"
+#include "graphReordering.hpp"
+#include "phaseTimes.hpp"
+#include "rankStorage.hpp"
+#include "rankView.hpp"
+#include "workerPool.hpp"
+
+// Pull-based computer that makes a single pass over the pages per iteration.
+// The pass gathers contributions (rank / out-degree) of in-neighbours and in
+// the same loop produces the next contributions, the L1 residual and the
+// dangling mass used by the next iteration. Gathers use AVX-512 or AVX2 when
+// the CPU supports them.
+class VectorizedPageRankComputer : public PageRankComputer {
+public:
+    enum class Kernel {
+        Scalar,
+        Avx2,
+        Avx512
+    };
+
+    VectorizedPageRankComputer(uint32_t numThreadsArg)
+        : VectorizedPageRankComputer(numThreadsArg, detectKernel())
+    {
+    }
+
+    VectorizedPageRankComputer(uint32_t numThreadsArg, Kernel kernelArg)
+        : VectorizedPageRankComputer(numThreadsArg, kernelArg, ReorderStrategy::None)
+    {
+    }
+
+    VectorizedPageRankComputer(uint32_t numThreadsArg, Kernel kernelArg, ReorderStrategy reorderStrategyArg)
+        : VectorizedPageRankComputer(numThreadsArg, kernelArg, reorderStrategyArg, RankPrecision::Double)
+    {
+    }
+
+    // Contributions gathered by the iteration are stored with the given precision,
+    // ranks, residuals and dangling sums stay in double.
+    VectorizedPageRankComputer(uint32_t numThreadsArg, Kernel kernelArg, ReorderStrategy reorderStrategyArg, RankPrecision precisionArg)
+        : numThreads(numThreadsArg)
+        , kernel(kernelArg)
+        , reorderStrategy(reorderStrategyArg)
+        , precision(precisionArg)
+        , pool(new WorkerPool(numThreadsArg))
+        , lastBusyTimes()
+        , lastIterations(0)
+        , lastPhaseTimes()
+    {
+    }
+
+    std::vector<PageIdAndRank> computeForNetwork(Network const& network, double alpha, uint32_t iterations, double tolerance) const
+    {
+        RankView view = this->computeViewForNetwork(network, alpha, iterations, tolerance);
+        PhaseStopwatch stopwatch(this->stats.get());
+        std::vector<PageIdAndRank> result = view.toVector();
+        this->lastPhaseTimes.output = stopwatch.lap("output");
+
+        ASSERT(result.size() == network.getSize(), "Invalid result size=" << result.size() << ", for network" << network);
+
+        return result;
+    }
+
+    RankView computeViewForNetwork(Network const& network, double alpha, uint32_t iterations, double tolerance) const
+    {
+        if (this->stats) {
+            this->stats->begin(this->getName(), this->numThreads, iterations);
+        }
+        PhaseStopwatch stopwatch(this->stats.get());
+        this->pool->run([this, &network](uint32_t thread) {
+            auto range = WorkerPool::range(network.getSize(), thread, this->numThreads);
+            network.generateIds(range.first, range.second);
+        });
+        this->lastPhaseTimes.hashing = stopwatch.lap("generateIds");
+
+        std::shared_ptr<CompiledNetwork> compiled(new CompiledNetwork(network, *this->pool, this->reorderStrategy));
+        this->lastPhaseTimes.build = stopwatch.lap("build");
+        if (this->stats) {
+            this->stats->addBytesAllocated(compiled->getAllocatedBytes());
+        }
+
+        std::vector<double> ranks = this->computeRanks(compiled->getGraph(), alpha, iterations, tolerance);
+        this->lastPhaseTimes.iterations = stopwatch.lap("iterations");
+        this->lastPhaseTimes.output = 0.0;
+        return RankView(compiled, std::move(ranks));
+    }
+
+    // Runs directly on a memory-mapped binary network, no Network is built
+    std::vector<PageIdAndRank> computeForMappedNetwork(MappedNetwork const& mapped, double alpha, uint32_t iterations, double tolerance) const
+    {
+        return this->computeViewForMappedNetwork(mapped, alpha, iterations, tolerance).toVector();
+    }
+
+    // The view refers to page ids of the mapped file, the mapped network has to outlive it
+    RankView computeViewForMappedNetwork(MappedNetwork const& mapped, double alpha, uint32_t iterations, double tolerance) const
+    {
+        if (this->stats) {
+            this->stats->begin(this->getName(), this->numThreads, iterations);
+        }
+        PhaseStopwatch stopwatch(this->stats.get());
+        std::shared_ptr<PageIdTable const> pageIds(&mapped, [](PageIdTable const*) {});
+        std::vector<double> ranks = this->computeRanks(mapped.getGraph(), alpha, iterations, tolerance);
+        stopwatch.lap("iterations");
+        return RankView(pageIds, std::move(ranks));
+    }
+
+    std::vector<double> computeRanks(CsrGraph const& graph, double alpha, uint32_t iterations, double tolerance) const
+    {
+        switch (this->precision) {
+        case RankPrecision::Float:
+            return this->computeRanksAs<float>(graph, alpha, iterations, tolerance);
+        case RankPrecision::BFloat16:
+            return this->computeRanksAs<BFloat16>(graph, alpha, iterations, tolerance);
+        case RankPrecision::Double:
+            break;
+        }
+        return this->computeRanksAs<double>(graph, alpha, iterations, tolerance);
+    }
+
+    template <typename Storage>
+    std::vector<double> computeRanksAs(CsrGraph const& graph, double alpha, uint32_t iterations, double tolerance) const
+    {
+        uint32_t size = graph.size;
+        ASSERT(size < (1u << 31), "Too many pages for 32-bit gather indices, size=" << size);
+
+        KernelArgs args;
+        args.offsets = graph.offsets;
+        args.sources = graph.sources;
+        args.inverseOutDegrees = graph.inverseOutDegrees;
+        args.alpha = alpha;
+        args.baseRank = 0.0;
+
+        std::vector<double> ranks(size, 1.0 / size);
+        // Contributions of iteration i are kept in contributionBuffers[i % 2]
+        std::vector<Storage> contributionBuffers[2] = { std::vector<Storage>(size), std::vector<Storage>(size) };
+        for (uint32_t page = 0; page < size; ++page) {
+            contributionBuffers[0][page] = RankStorage<Storage>::store(ranks[page] * args.inverseOutDegrees[page]);
+        }
+        // Partial sums of iteration i are kept in partials[i % 2], so that a thread
+        // starting the next iteration never overwrites values others still read
+        std::vector<ThreadSlot<Partials>> partialBuffers[2] = {
+            std::vector<ThreadSlot<Partials>>(this->numThreads), std::vector<ThreadSlot<Partials>>(this->numThreads)
+        };
+        double initialDangleSum = graph.numDanglingNodes * (1.0 / size);
+        std::vector<ThreadSlot<double>> busyTimes(this->numThreads);
+        uint32_t finalIteration = 0; // stays 0 when the computation did not converge
+        ComputationStats* stats = this->stats.get();
+        if (stats != nullptr) {
+            stats->addBytesAllocated(size * (sizeof(double) + 2 * sizeof(Storage)));
+        }
+
+        EdgeBalancedScheduler scheduler(graph, this->numThreads);
+        SpinBarrier barrier(this->numThreads);
+        this->pool->run([&](uint32_t thread) {
+            KernelArgs threadArgs = args;
+            double dangleSum = initialDangleSum;
+            busyTimes[thread].value = 0.0;
+            ThreadTimeline timeline(stats, thread);
+
+            for (uint32_t i = 1; i <= iterations; i++) {
+                double iterationStart = stats != nullptr ? stats->now() : 0.0;
+                auto busyStart = std::chrono::steady_clock::now();
+                threadArgs.baseRank = (alpha * dangleSum + (1.0 - alpha)) / size;
+                Partials partials = { 0.0, 0.0 };
+                scheduler.forEachChunk(thread, i, [&](size_t start, size_t end, uint32_t) {
+                    Partials chunkPartials = this->runKernel(threadArgs, contributionBuffers[(i + 1) % 2].data(), contributionBuffers[i % 2].data(), ranks.data(), start, end);
+                    partials.difference += chunkPartials.difference;
+                    partials.dangleSum += chunkPartials.dangleSum;
+                });
+                partialBuffers[i % 2][thread].value = partials;
+                busyTimes[thread].value += std::chrono::duration<double>(std::chrono::steady_clock::now() - busyStart).count();
+                timeline.busy("ranks", i);
+                barrier.arriveAndWait();
+                timeline.wait(i);
+
+                double difference = 0.0;
+                dangleSum = 0.0;
+                for (auto const& partial : partialBuffers[i % 2]) {
+                    difference += partial.value.difference;
+                    dangleSum += partial.value.dangleSum;
+                }
+                if (stats != nullptr && thread == 0) {
+                    stats->addIteration(iterationStart, stats->now(), difference);
+                    stats->addEdgesProcessed(graph.numEdges);
+                }
+
+                if (difference < tolerance) {
+                    if (thread == 0) {
+                        finalIteration = i;
+                    }
+                    return;
+                }
+            }
+        });
+
+        this->lastBusyTimes.clear();
+        for (auto const& busyTime : busyTimes) {
+            this->lastBusyTimes.push_back(busyTime.value);
+        }
+        this->lastIterations = finalIteration;
+
+        if (finalIteration > 0) {
+            return ranks;
+        }
+
+        ASSERT(false, "Not able to find result in iterations=" << iterations);
+        return {};
+    }
+
+    std::string getName() const
+    {
+        static char const* kernelNames[] = { "scalar", "avx2", "avx512" };
+        static char const* precisionNames[] = { "", ", float", ", bf16" };
+        std::string reorder = this->reorderStrategy == ReorderStrategy::None ? "" : ", " + GraphReordering::getName(this->reorderStrategy);
+        return "VectorizedPageRankComputer[" + std::to_string(this->numThreads) + ", " + kernelNames[static_cast<int>(this->kernel)] + reorder
+            + precisionNames[static_cast<int>(this->precision)] + "]";
+    }
+
+    // Seconds every thread spent computing ranks (waiting at barriers excluded) in the last computation
+    std::vector<double> const& getLastBusyTimes() const
+    {
+        return this->lastBusyTimes;
+    }
+
+    // Number of iterations the last computation needed to converge
+    uint32_t getLastIterations() const
+    {
+        return this->lastIterations;
+    }
+
+    // Durations of the phases of the last computation
+    PhaseTimes getLastPhaseTimes() const
+    {
+        return this->lastPhaseTimes;
+    }
+
+    // Every following computation fills the given stats object, nullptr stops the collection
+    void attachStats(std::shared_ptr<ComputationStats> statsArg)
+    {
+        this->stats = statsArg;
+    }
+
+    static bool isKernelSupported(Kernel kernel)
+    {
+#ifdef PAGE_RANK_HAS_X86_GATHERS
+        switch (kernel) {
+        case Kernel::Avx512:
+            return __builtin_cpu_supports("avx512f");
+        case Kernel::Avx2:
+            return __builtin_cpu_supports("avx2");
+        case Kernel::Scalar:
+            return true;
+        }
+#endif
+        return kernel == Kernel::Scalar;
+    }
+
+    static Kernel detectKernel()
+    {
+        for (Kernel kernel : { Kernel::Avx512, Kernel::Avx2 }) {
+            if (isKernelSupported(kernel)) {
+                return kernel;
+            }
+        }
+        return Kernel::Scalar;
+    }
+
+private:
+    struct KernelArgs {
+        uint64_t const* offsets;
+        uint32_t const* sources;
+        double const* inverseOutDegrees;
+        double alpha;
+        double baseRank;
+    };
+
+    struct Partials {
+        double difference;
+        double dangleSum;
+    };
+
+    uint32_t numThreads;
+    Kernel kernel;
+    ReorderStrategy reorderStrategy;
+    RankPrecision precision;
+    std::shared_ptr<WorkerPool> pool;
+    // Written by every computation, a computer runs one computation at a time
+    mutable std::vector<double> lastBusyTimes;
+    mutable uint32_t lastIterations;
+    mutable PhaseTimes lastPhaseTimes;
+    std::shared_ptr<ComputationStats> stats;
+
+    Partials runKernel(KernelArgs const& args, double const* previous, double* next, double* ranks, size_t start, size_t end) const
+    {
+#ifdef PAGE_RANK_HAS_X86_GATHERS
+        if (this->kernel == Kernel::Avx512) {
+            return kernelAvx512(args, previous, next, ranks, start, end);
+        }
+        if (this->kernel == Kernel::Avx2) {
+            return kernelAvx2(args, previous, next, ranks, start, end);
+        }
+#endif
+        return kernelScalar(args, previous, next, ranks, start, end);
+    }
+
+    // Float contributions are gathered 8 at a time with AVX2 also when AVX-512 is available
+    Partials runKernel(KernelArgs const& args, float const* previous, float* next, double* ranks, size_t start, size_t end) const
+    {
+#ifdef PAGE_RANK_HAS_X86_GATHERS
+        if (this->kernel != Kernel::Scalar) {
+            return kernelAvx2(args, previous, next, ranks, start, end);
+        }
+#endif
+        return kernelScalar(args, previous, next, ranks, start, end);
+    }
+
+    template <typename Storage>
+    Partials runKernel(KernelArgs const& args, Storage const* previous, Storage* next, double* ranks, size_t start, size_t end) const
+    {
+        return kernelScalar(args, previous, next, ranks, start, end);
+    }
+
+    // Shared tail of every kernel: stores the new rank and contribution of the page
+    // and accumulates the residual and the dangling mass.
+    template <typename Storage>
+    static void finishPage(KernelArgs const& args, double inSum, Storage* next, double* ranks, size_t page, Partials& partials)
+    {
+        double rank = args.baseRank + args.alpha * inSum;
+        double inverseOutDegree = args.inverseOutDegrees[page];
+
+        partials.difference += std::abs(ranks[page] - rank);
+        partials.dangleSum += inverseOutDegree == 0.0 ? rank : 0.0;
+        ranks[page] = rank;
+        next[page] = RankStorage<Storage>::store(rank * inverseOutDegree);
+    }
+
+    template <typename Storage>
+    static Partials kernelScalar(KernelArgs const& args, Storage const* previous, Storage* next, double* ranks, size_t start, size_t end)
+    {
+        Partials partials = { 0.0, 0.0 };
+        for (size_t page = start; page < end; ++page) {
+            double inSum = 0.0;
+            for (uint64_t e = args.offsets[page]; e < args.offsets[page + 1]; ++e) {
+                inSum += RankStorage<Storage>::load(previous[args.sources[e]]);
+            }
+            finishPage(args, inSum, next, ranks, page, partials);
+        }
+        return partials;
+    }
+
+#ifdef PAGE_RANK_HAS_X86_GATHERS
+    __attribute__((target("avx2"))) static Partials kernelAvx2(KernelArgs const& args, double const* previous, double* next, double* ranks, size_t start, size_t end)
+    {
+        Partials partials = { 0.0, 0.0 };
+        for (size_t page = start; page < end; ++page) {
+            uint64_t e = args.offsets[page];
+            uint64_t last = args.offsets[page + 1];
+
+            // Most pages have only a few in-links, they are not worth the horizontal reduction
+            double inSum = 0.0;
+            if (last - e >= 4) {
+                __m256d allLanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+                __m256d sums = _mm256_setzero_pd();
+                for (; e + 4 <= last; e += 4) {
+                    __m128i indices = _mm_loadu_si128(reinterpret_cast<__m128i const*>(args.sources + e));
+                    sums = _mm256_add_pd(sums, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), previous, indices, allLanes, 8));
+                }
+                __m128d halves = _mm_add_pd(_mm256_castpd256_pd128(sums), _mm256_extractf128_pd(sums, 1));
+                inSum = _mm_cvtsd_f64(_mm_add_sd(halves, _mm_unpackhi_pd(halves, halves)));
+            }
+            for (; e < last; ++e) {
+                inSum += previous[args.sources[e]];
+            }
+
+            finishPage(args, inSum, next, ranks, page, partials);
+        }
+        return partials;
+    }
+
+    __attribute__((target("avx512f"))) static Partials kernelAvx512(KernelArgs const& args, double const* previous, double* next, double* ranks, size_t start, size_t end)
+    {
+        Partials partials = { 0.0, 0.0 };
+        for (size_t page = start; page < end; ++page) {
+            uint64_t e = args.offsets[page];
+            uint64_t last = args.offsets[page + 1];
+
+            // Most pages have only a few in-links, they are not worth the horizontal reduction
+            double inSum = 0.0;
+            if (last - e >= 8) {
+                __m512d sums = _mm512_setzero_pd();
+                for (; e + 8 <= last; e += 8) {
+                    __m256i indices = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(args.sources + e));
+                    sums = _mm512_add_pd(sums, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xff, indices, previous, 8));
+                }
+                if (e < last) {
+                    // Masked gather of the remaining 1-7 edges
+                    alignas(32) uint32_t tail[8] = { 0 };
+                    std::copy(args.sources + e, args.sources + last, tail);
+                    __mmask8 mask = static_cast<__mmask8>((1u << (last - e)) - 1);
+                    __m256i indices = _mm256_load_si256(reinterpret_cast<__m256i const*>(tail));
+                    sums = _mm512_add_pd(sums, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), mask, indices, previous, 8));
+                    e = last;
+                }
+                alignas(64) double lanes[8];
+                _mm512_store_pd(lanes, sums);
+                for (double lane : lanes) {
+                    inSum += lane;
+                }
+            }
+            for (; e < last; ++e) {
+                inSum += previous[args.sources[e]];
+            }
+
+            finishPage(args, inSum, next, ranks, page, partials);
+        }
+        return partials;
+    }
+
+    __attribute__((target("avx2"))) static Partials kernelAvx2(KernelArgs const& args, float const* previous, float* next, double* ranks, size_t start, size_t end)
+    {
+        Partials partials = { 0.0, 0.0 };
+        for (size_t page = start; page < end; ++page) {
+            uint64_t e = args.offsets[page];
+            uint64_t last = args.offsets[page + 1];
+
+            // Gathered floats are widened before summing, sums of hubs keep double precision
+            double inSum = 0.0;
+            if (last - e >= 8) {
+                __m256 allLanes = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                __m256d sums = _mm256_setzero_pd();
+                for (; e + 8 <= last; e += 8) {
+                    __m256i indices = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(args.sources + e));
+                    __m256 values = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), previous, indices, allLanes, 4);
+                    sums = _mm256_add_pd(sums, _mm256_cvtps_pd(_mm256_castps256_ps128(values)));
+                    sums = _mm256_add_pd(sums, _mm256_cvtps_pd(_mm256_extractf128_ps(values, 1)));
+                }
+                __m128d halves = _mm_add_pd(_mm256_castpd256_pd128(sums), _mm256_extractf128_pd(sums, 1));
+                inSum = _mm_cvtsd_f64(_mm_add_sd(halves, _mm_unpackhi_pd(halves, halves)));
+            }
+            for (; e < last; ++e) {
+                inSum += previous[args.sources[e]];
+            }
+
+            finishPage(args, inSum, next, ranks, page, partials);
+        }
+        return partials;
+    }
+#endif
+};
+
+#endif /* SRC_VECTORIZEDPAGERANKCOMPUTER_HPP_ */
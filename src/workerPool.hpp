@@ -0,0 +1,147 @@
+#ifndef SRC_WORKERPOOL_HPP_
+#define SRC_WORKERPOOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "immutable/common.hpp"
+
+// Reusable barrier. Waiting threads spin for a short while (phases of the
+// computers are usually short) and then park on a condition variable.
+class SpinBarrier {
+public:
+    SpinBarrier(uint32_t countArg)
+        : count(countArg)
+        , waiting(0)
+        , generation(0)
+    {
+    }
+
+    void arriveAndWait()
+    {
+        uint32_t arrivedGeneration = this->generation.load(std::memory_order_acquire);
+        if (this->waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == this->count) {
+            this->waiting.store(0, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->generation.fetch_add(1, std::memory_order_release);
+            }
+            this->condition.notify_all();
+            return;
+        }
+
+        for (uint32_t spin = 0; spin < spinLimit; ++spin) {
+            if (this->generation.load(std::memory_order_acquire) != arrivedGeneration) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->condition.wait(lock, [this, arrivedGeneration] {
+            return this->generation.load(std::memory_order_acquire) != arrivedGeneration;
+        });
+    }
+
+private:
+    static uint32_t const spinLimit = 1024;
+
+    uint32_t const count;
+    std::atomic<uint32_t> waiting;
+    std::atomic<uint32_t> generation;
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+// Per-thread accumulator padded so that slots of different threads never share a cache line.
+template <typename T>
+struct ThreadSlot {
+    T value;
+    char padding[128 - sizeof(T)];
+};
+
+// Long-lived threads owned by a computer. run() executes a task on all
+// threads (the calling thread takes index 0) and returns once every thread
+// has finished it; the same workers serve every call.
+class WorkerPool {
+public:
+    WorkerPool(uint32_t numThreadsArg)
+        : numThreads(numThreadsArg)
+        , startBarrier(numThreadsArg)
+        , doneBarrier(numThreadsArg)
+        , task(nullptr)
+        , stopping(false)
+    {
+        ASSERT(numThreadsArg > 0, "Worker pool needs at least one thread");
+
+        for (uint32_t i = 1; i < numThreadsArg; ++i) {
+            this->workers.emplace_back(&WorkerPool::workerLoop, this, i);
+        }
+    }
+
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    ~WorkerPool()
+    {
+        this->stopping = true;
+        this->startBarrier.arriveAndWait();
+        for (auto& worker : this->workers) {
+            worker.join();
+        }
+    }
+
+    uint32_t getNumThreads() const
+    {
+        return this->numThreads;
+    }
+
+    void run(std::function<void(uint32_t)> const& taskArg)
+    {
+        std::lock_guard<std::mutex> lock(this->runMutex);
+
+        this->task = &taskArg;
+        this->startBarrier.arriveAndWait();
+        taskArg(0);
+        this->doneBarrier.arriveAndWait();
+        this->task = nullptr;
+    }
+
+    // Part [start, end) of size elements assigned to the given thread.
+    static std::pair<size_t, size_t> range(size_t size, uint32_t thread, uint32_t numThreads)
+    {
+        size_t start = size / numThreads * thread + std::min<size_t>(thread, size % numThreads);
+        return std::make_pair(start, start + size / numThreads + (thread < size % numThreads ? 1 : 0));
+    }
+
+private:
+    uint32_t const numThreads;
+    std::vector<std::thread> workers;
+
+    std::mutex runMutex;
+    SpinBarrier startBarrier;
+    SpinBarrier doneBarrier;
+    std::function<void(uint32_t)> const* task;
+    bool stopping;
+
+    void workerLoop(uint32_t thread)
+    {
+        while (true) {
+            this->startBarrier.arriveAndWait();
+            if (this->stopping) {
+                return;
+            }
+            (*this->task)(thread);
+            this->doneBarrier.arriveAndWait();
+        }
+    }
+};
+
+#endif /* SRC_WORKERPOOL_HPP_ */
@@ -0,0 +1,56 @@
+#include <cstdio>
+#include <string>
+
+#include "lib/networkGenerator.hpp"
+#include "lib/resultVerificator.hpp"
+#include "lib/simpleIdGenerator.hpp"
+
+#include "../src/immutable/common.hpp"
+
+#include "../src/binaryNetwork.hpp"
+#include "../src/compiledNetwork.hpp"
+#include "../src/singleThreadedPageRankComputer.hpp"
+#include "../src/vectorizedPageRankComputer.hpp"
+
+void verifyLayout(CompiledNetwork const& compiled, MappedNetwork const& mapped)
+{
+    ASSERT(mapped.getSize() == compiled.getSize(), "Invalid size=" << mapped.getSize());
+    ASSERT(mapped.getNumEdges() == compiled.getNumEdges(), "Invalid number of edges=" << mapped.getNumEdges());
+
+    CsrGraph graph = mapped.getGraph();
+    for (uint32_t page = 0; page < compiled.getSize(); ++page) {
+        ASSERT(mapped.getPageId(page) == compiled.getPageIds()[page], "Invalid page id of page=" << page);
+        ASSERT(mapped.getOutDegrees()[page] == compiled.getOutDegrees()[page], "Invalid out-degree of page=" << page);
+        ASSERT(graph.inverseOutDegrees[page] == compiled.getInverseOutDegrees()[page], "Invalid inverse out-degree of page=" << page);
+    }
+    for (uint32_t page = 0; page <= compiled.getSize(); ++page) {
+        ASSERT(graph.offsets[page] == compiled.getOffsets()[page], "Invalid offset of page=" << page);
+    }
+    for (uint64_t e = 0; e < compiled.getNumEdges(); ++e) {
+        ASSERT(graph.sources[e] == compiled.getSources()[e], "Invalid source of edge=" << e);
+    }
+    ASSERT(graph.numDanglingNodes == compiled.getDanglingNodes().size(), "Invalid number of dangling pages=" << graph.numDanglingNodes);
+}
+
+int main()
+{
+    SimpleIdGenerator idGenerator("f1d8a95c6f5f0d2a3b8c7e1a4d6f9b0c2e5a8d1f4b7c0e3a6d9f2b5c8e1a4d7f");
+    std::string const path = "binaryNetworkTest.bin";
+
+    for (uint32_t size : { 1u, 10u, 1000u }) {
+        Network network = SimpleNetworkGenerator(idGenerator).generateNetworkOfSize(size);
+        // Computing the reference ranks generates the page ids needed for compiling
+        auto expected = SingleThreadedPageRankComputer().computeForNetwork(network, 0.85, 100, 0.0000001);
+        CompiledNetwork compiled(network);
+        BinaryNetwork::write(compiled, path);
+
+        MappedNetwork mapped(path);
+        verifyLayout(compiled, mapped);
+
+        ResultVerificator::verifyRanks(VectorizedPageRankComputer(2).computeForMappedNetwork(mapped, 0.85, 100, 0.0000001), expected, 1e-9, 0.0);
+        std::cout << "Binary network of size=" << size << " passed" << std::endl;
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
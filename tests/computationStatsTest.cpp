@@ -0,0 +1,166 @@
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "../src/immutable/common.hpp"
+#include "../src/immutable/pageIdAndRank.hpp"
+
+#include "../src/acceleratedPageRankComputer.hpp"
+#include "../src/compiledNetwork.hpp"
+#include "../src/computationStats.hpp"
+#include "../src/multiThreadedPageRankComputer.hpp"
+#include "../src/singleThreadedPageRankComputer.hpp"
+#include "../src/vectorizedPageRankComputer.hpp"
+
+#include "./lib/networkGenerator.hpp"
+#include "./lib/performanceTimer.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+double const alpha = 0.85;
+double const tolerance = 0.0000001;
+
+size_t countOccurrences(std::string const& text, std::string const& pattern)
+{
+    size_t count = 0;
+    for (size_t position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1)) {
+        count++;
+    }
+    return count;
+}
+
+uint64_t expectedEdgesProcessed(PageRankComputer const&, ComputationStats const& stats, uint64_t numEdges)
+{
+    return stats.getIterations().size() * numEdges;
+}
+
+uint64_t expectedEdgesProcessed(AcceleratedPageRankComputer const& computer, ComputationStats const&, uint64_t)
+{
+    return computer.getLastStatistics().edgeVisits;
+}
+
+void verifyExports(ComputationStats const& stats)
+{
+    std::ostringstream json;
+    stats.writeJson(json);
+    ASSERT(countOccurrences(json.str(), "\"residual\"") == stats.getIterations().size(), "Invalid number of residuals in JSON");
+
+    std::ostringstream trace;
+    stats.writeChromeTrace(trace);
+    size_t numSpans = stats.getPhases().size() + stats.getIterations().size();
+    for (uint32_t thread = 0; thread < stats.getNumThreads(); ++thread) {
+        numSpans += stats.getThreadSpans(thread, ComputationStats::SpanKind::Busy).size();
+        numSpans += stats.getThreadSpans(thread, ComputationStats::SpanKind::Wait).size();
+    }
+    ASSERT(countOccurrences(trace.str(), "\"ph\":\"X\"") == numSpans, "Invalid number of trace events");
+    ASSERT(countOccurrences(trace.str(), "\"ph\":\"M\"") == stats.getNumThreads() + 1u, "Invalid number of trace tracks");
+    ASSERT(countOccurrences(trace.str(), "{") == countOccurrences(trace.str(), "}"), "Unbalanced trace");
+}
+
+// Collected stats describe the computation and do not change its result
+template <typename Computer>
+void testStats(Computer& computer, NetworkGenerator const& networkGenerator, uint32_t size)
+{
+    Network pristine = networkGenerator.generateNetworkOfSize(size);
+    Network plainNetwork = pristine;
+    std::vector<PageIdAndRank> plain = computer.computeForNetwork(plainNetwork, alpha, 1000, tolerance);
+
+    auto stats = std::make_shared<ComputationStats>();
+    computer.attachStats(stats);
+    Network network = pristine;
+    PerformanceTimer timer;
+    std::vector<PageIdAndRank> result = computer.computeForNetwork(network, alpha, 1000, tolerance);
+    double total = timer.getElapsedSeconds();
+    computer.attachStats(nullptr);
+
+    for (uint32_t page = 0; page < size; ++page) {
+        ASSERT(std::abs(result[page].getPageRank() - plain[page].getPageRank()) < tolerance, "Different rank of page=" << page << " with stats");
+    }
+
+    ASSERT(stats->getComputer() == computer.getName(), "Invalid computer name=" << stats->getComputer());
+    double phaseSum = 0.0;
+    for (char const* phase : { "generateIds", "build", "iterations", "output" }) {
+        ASSERT(stats->getPhaseSeconds(phase) > 0.0, "Phase " << phase << " was not recorded");
+        phaseSum += stats->getPhaseSeconds(phase);
+    }
+    ASSERT(phaseSum <= total, "Phases took longer=" << phaseSum << " than the computation=" << total);
+
+    auto const& iterations = stats->getIterations();
+    ASSERT(iterations.size() == computer.getLastIterations(), "Invalid number of iterations=" << iterations.size() << ", expected=" << computer.getLastIterations());
+    ASSERT(iterations.back().residual < tolerance, "Last residual=" << iterations.back().residual << " does not meet the tolerance");
+    for (size_t i = 0; i < iterations.size(); ++i) {
+        ASSERT(iterations[i].end >= iterations[i].start && (i == 0 || iterations[i].start >= iterations[i - 1].end), "Overlapping iteration=" << i);
+    }
+
+    Network hashed = pristine;
+    hashed.generateIds(0, hashed.getSize());
+    CompiledNetwork compiled(hashed);
+    uint64_t expectedEdges = expectedEdgesProcessed(computer, *stats, compiled.getNumEdges());
+    ASSERT(stats->getEdgesProcessed() == expectedEdges, "Invalid edges processed=" << stats->getEdgesProcessed() << ", expected=" << expectedEdges);
+    ASSERT(stats->getBytesAllocated() > compiled.getAllocatedBytes(), "Too few bytes allocated=" << stats->getBytesAllocated());
+
+    for (uint32_t thread = 0; thread < stats->getNumThreads(); ++thread) {
+        auto const& busy = stats->getThreadSpans(thread, ComputationStats::SpanKind::Busy);
+        ASSERT(busy.size() >= iterations.size(), "Missing busy spans of thread=" << thread);
+        ASSERT(stats->getThreadSeconds(thread, ComputationStats::SpanKind::Busy) > 0.0, "No busy time of thread=" << thread);
+        if (stats->getNumThreads() > 1) {
+            ASSERT(stats->getThreadSpans(thread, ComputationStats::SpanKind::Wait).size() >= iterations.size(), "Missing wait spans of thread=" << thread);
+        }
+    }
+    verifyExports(*stats);
+
+    // A detached stats object keeps the last collected computation
+    size_t numIterations = iterations.size();
+    Network detachedNetwork = pristine;
+    computer.computeForNetwork(detachedNetwork, alpha, 1000, tolerance);
+    ASSERT(stats->getIterations().size() == numIterations && stats->getComputer() == computer.getName(), "Detached stats were changed");
+
+    std::cout << "Stats [" << size << " nodes, " << computer.getName() << "]: " << numIterations << " iterations, " << stats->getEdgesProcessed()
+              << " edges, " << stats->getBytesAllocated() << " bytes, successed" << std::endl;
+}
+
+// Time of the computation with and without collecting stats
+template <typename Computer>
+void statsOverhead(Computer& computer, NetworkGenerator const& networkGenerator, uint32_t size)
+{
+    Network pristine = networkGenerator.generateNetworkOfSize(size);
+    Network warmupNetwork = pristine;
+    computer.computeForNetwork(warmupNetwork, alpha, 1000, tolerance);
+    double seconds[2];
+    for (int collect = 0; collect < 2; ++collect) {
+        computer.attachStats(collect == 1 ? std::make_shared<ComputationStats>() : nullptr);
+        Network network = pristine;
+        PerformanceTimer timer;
+        computer.computeForNetwork(network, alpha, 1000, tolerance);
+        seconds[collect] = timer.getElapsedSeconds();
+    }
+    computer.attachStats(nullptr);
+    std::cout << "Stats overhead [" << size << " nodes, " << computer.getName() << "]: " << seconds[0] << "s without, " << seconds[1] << "s with stats"
+              << std::endl;
+}
+
+int main()
+{
+    SimpleIdGenerator idGenerator("5d1e4a7c9b2f3e6a8d0c1b4f7e9a2c5d8b0e3f6a9c1d4e7b0a3f5c8e1d6b9a2f");
+    PowerLawNetworkGenerator powerLawGenerator(idGenerator);
+    RmatNetworkGenerator rmatGenerator(idGenerator);
+
+    SingleThreadedPageRankComputer single;
+    SingleThreadedPageRankComputer gaussSeidel(IterationMode::InPlace);
+    AcceleratedPageRankComputer accelerated;
+    MultiThreadedPageRankComputer multi(3);
+    MultiThreadedPageRankComputer async(3, IterationMode::InPlace);
+    VectorizedPageRankComputer vectorized(3);
+
+    testStats(single, powerLawGenerator, 2000);
+    testStats(gaussSeidel, powerLawGenerator, 2000);
+    testStats(accelerated, powerLawGenerator, 2000);
+    testStats(multi, powerLawGenerator, 2000);
+    testStats(async, rmatGenerator, 2000);
+    testStats(vectorized, rmatGenerator, 2000);
+
+    statsOverhead(single, rmatGenerator, 50000);
+    statsOverhead(vectorized, rmatGenerator, 50000);
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/immutable/common.hpp"
+
+#include "../src/binaryNetwork.hpp"
+#include "../src/blockedEdgeFile.hpp"
+#include "../src/externalPageRankComputer.hpp"
+#include "../src/syntheticGraphGenerator.hpp"
+#include "../src/vectorizedPageRankComputer.hpp"
+#include "../src/workerPool.hpp"
+
+#include "./lib/performanceTimer.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+double const alpha = 0.85;
+double const tolerance = 0.0000001;
+
+// Blocks cover all pages in order and hold the same reverse edges as the mapped network
+void verifyBlocks(BlockedEdgeFile const& file, MappedNetwork const& mapped, uint64_t blockBytes)
+{
+    CsrGraph graph = mapped.getGraph();
+    ASSERT(file.getNumPages() == graph.size && file.getNumEdges() == graph.numEdges, "Invalid size of blocked edge file");
+    ASSERT(file.getMaxBlockBytes() <= blockBytes, "Block of bytes=" << file.getMaxBlockBytes() << " exceeds the limit=" << blockBytes);
+    std::vector<uint32_t> data(file.getMaxBlockBytes() / sizeof(uint32_t));
+    uint32_t nextPage = 0;
+    for (uint32_t b = 0; b < file.getBlocks().size(); ++b) {
+        BlockedEdgeFileBlock const& block = file.getBlocks()[b];
+        ASSERT(block.firstPage == nextPage && block.numPages > 0, "Block=" << b << " does not follow the previous one");
+        file.readBlock(b, data.data(), data.size() * sizeof(uint32_t));
+        uint32_t const* offsets = data.data();
+        uint32_t const* sources = offsets + block.numPages + 1;
+        for (uint32_t page = 0; page < block.numPages; ++page) {
+            uint64_t first = graph.offsets[block.firstPage + page];
+            ASSERT(offsets[page + 1] - offsets[page] == graph.offsets[block.firstPage + page + 1] - first, "Invalid in-degree of page=" << block.firstPage + page);
+            for (uint32_t e = offsets[page]; e < offsets[page + 1]; ++e) {
+                ASSERT(sources[e] == graph.sources[first + e - offsets[page]], "Invalid source of page=" << block.firstPage + page);
+            }
+        }
+        nextPage += block.numPages;
+    }
+    ASSERT(nextPage == graph.size, "Blocks cover pages=" << nextPage << " of " << graph.size);
+    for (uint32_t page = 0; page < graph.size; ++page) {
+        ASSERT(file.getOutDegrees()[page] == mapped.getOutDegrees()[page], "Invalid out-degree of page=" << page);
+    }
+}
+
+// Any block size, number of buffers and threads gives the ranks of the in-memory computer
+void testExternal(SyntheticGraphGenerator const& generator, IdGenerator const& idGenerator, uint64_t smallBlockBytes)
+{
+    WorkerPool pool(2);
+    std::string const binaryPath = "externalPageRankTest.bin";
+    std::string const edgesPath = "externalPageRankTest.edges";
+    std::string const blockedPath = "externalPageRankTest.blocks";
+    SyntheticGraphWriter::writeBinaryNetwork(generator, idGenerator, pool, binaryPath);
+    SyntheticGraphWriter::writeEdgeList(generator, pool, edgesPath);
+    MappedNetwork mapped(binaryPath);
+    std::vector<double> expected = VectorizedPageRankComputer(2).computeRanks(mapped.getGraph(), alpha, 1000, tolerance);
+
+    for (uint64_t blockBytes : { smallBlockBytes, 16 * smallBlockBytes, uint64_t(1) << 30 }) {
+        BlockedEdgeFile::write(edgesPath, generator.getNumPages(), blockedPath, blockBytes);
+        BlockedEdgeFile file(blockedPath);
+        verifyBlocks(file, mapped, blockBytes);
+
+        uint64_t residentBytes = ExternalPageRankComputer::getResidentBytes(file);
+        for (uint32_t numBuffers : { 2, 5 }) {
+            for (uint32_t numThreads : { 1, 3 }) {
+                ExternalPageRankComputer computer(numThreads, residentBytes + numBuffers * file.getMaxBlockBytes(), numBuffers - 1);
+                std::vector<double> ranks = computer.computeForFile(file, alpha, 1000, tolerance);
+                ASSERT(computer.getLastNumBuffers() == std::min<uint64_t>(numBuffers, file.getBlocks().size() + 1), "Invalid number of buffers=" << computer.getLastNumBuffers());
+                ASSERT(computer.getLastBytesRead() >= computer.getLastIterations() * (file.getNumEdges() + file.getNumPages()) * sizeof(uint32_t),
+                    "Too few bytes read=" << computer.getLastBytesRead());
+                for (uint32_t page = 0; page < file.getNumPages(); ++page) {
+                    ASSERT(std::abs(ranks[page] - expected[page]) < tolerance, "Different rank of page=" << page << ": " << ranks[page] << ", expected=" << expected[page]);
+                }
+            }
+        }
+        std::cout << "External [" << file.getNumPages() << " nodes, " << generator.getName() << ", " << file.getBlocks().size() << " blocks] successed" << std::endl;
+    }
+
+    std::remove(binaryPath.c_str());
+    std::remove(edgesPath.c_str());
+    std::remove(blockedPath.c_str());
+}
+
+// A graph without pages has no blocks and no ranks
+void testEmpty()
+{
+    std::string const edgesPath = "externalPageRankTest.edges";
+    std::string const blockedPath = "externalPageRankTest.blocks";
+    std::ofstream(edgesPath, std::ios::binary | std::ios::trunc).close();
+    BlockedEdgeFile::write(edgesPath, 0, blockedPath, 1ull << 12);
+    {
+        BlockedEdgeFile file(blockedPath);
+        ASSERT(file.getNumPages() == 0 && file.getNumEdges() == 0 && file.getBlocks().empty(), "Empty graph has blocks");
+        ExternalPageRankComputer computer(2, 1ull << 12);
+        ASSERT(computer.computeForFile(file, alpha, 1000, tolerance).empty(), "Empty graph has ranks");
+        ASSERT(computer.getLastBytesRead() == 0, "Empty graph was read");
+    }
+    std::remove(edgesPath.c_str());
+    std::remove(blockedPath.c_str());
+    std::cout << "External [0 nodes] successed" << std::endl;
+}
+
+// Time of an iteration and of waiting for the disk under a budget far below the size of the edges
+void externalPerformance(SyntheticGraphGenerator const& generator)
+{
+    WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    std::string const edgesPath = "externalPageRankTest.edges";
+    std::string const blockedPath = "externalPageRankTest.blocks";
+    SyntheticGraphWriter::writeEdgeList(generator, pool, edgesPath);
+
+    PerformanceTimer timer;
+    BlockedEdgeFile::write(edgesPath, generator.getNumPages(), blockedPath, 1ull << 20);
+    double partitionSeconds = timer.getElapsedSeconds();
+    {
+        BlockedEdgeFile file(blockedPath);
+        uint64_t budget = ExternalPageRankComputer::getResidentBytes(file) + 4 * file.getMaxBlockBytes();
+        ExternalPageRankComputer computer(pool.getNumThreads(), budget);
+        timer = PerformanceTimer();
+        computer.computeForFile(file, alpha, 1000, tolerance);
+        double seconds = timer.getElapsedSeconds();
+        std::cout << "External " << generator.getName() << " [" << file.getNumPages() << " nodes, " << file.getNumEdges() << " edges, budget " << budget
+                  << " bytes]: partitioning " << partitionSeconds << "s, " << computer.getLastIterations() << " iterations " << seconds << "s, I/O wait "
+                  << computer.getLastIoWaitSeconds() << "s, read " << computer.getLastBytesRead() / seconds / 1e6 << " MB/s" << std::endl;
+    }
+
+    std::remove(edgesPath.c_str());
+    std::remove(blockedPath.c_str());
+}
+
+int main()
+{
+    SimpleIdGenerator idGenerator("c7e1a3f5b9d2e4a6c8f0b1d3e5a7c9f2b4d6e8a0c1f3b5d7e9a2c4f6b8d0e1a3");
+
+    testEmpty();
+    testExternal(RmatGraphGenerator(2, 3.0, 1), idGenerator, 1ull << 12);
+    testExternal(PowerLawGraphGenerator(1, 10.0, 1), idGenerator, 1ull << 12);
+    testExternal(RmatGraphGenerator(5000, 8.0, 2), idGenerator, 1ull << 14);
+    // The most linked page of a power-law graph takes a large block
+    testExternal(PowerLawGraphGenerator(20000, 10.0, 3), idGenerator, 1ull << 18);
+
+    externalPerformance(RmatGraphGenerator(1 << 18, 16.0, 4));
+
+    return 0;
+}
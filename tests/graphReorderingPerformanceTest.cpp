@@ -0,0 +1,50 @@
+#include <sstream>
+
+#include "../src/immutable/common.hpp"
+
+#include "../src/compiledNetwork.hpp"
+#include "../src/graphReordering.hpp"
+#include "../src/vectorizedPageRankComputer.hpp"
+
+#include "./lib/networkGenerator.hpp"
+#include "./lib/performanceTimer.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+// Usage: graphReorderingPerformanceTest [number of pages]
+int main(int argc, char** argv)
+{
+    ASSERT(argc <= 2, "Too many arguments: " << argc);
+
+    uint32_t size = 100000;
+    if (argc == 2) {
+        std::stringstream(argv[1]) >> size;
+    }
+
+    SimpleIdGenerator idGenerator("2000f1ffa5ce95d0f1e1893598e6aeeb2c214c85a88e3569d62c2dccd06a8725");
+    Network network = PowerLawNetworkGenerator(idGenerator).generateNetworkOfSize(size);
+    network.generateIds(0, network.getSize());
+
+    VectorizedPageRankComputer computer(1);
+    double baseCompile = 0.0;
+    double baseCompute = 0.0;
+    for (ReorderStrategy strategy : { ReorderStrategy::None, ReorderStrategy::InDegree, ReorderStrategy::ReverseCuthillMcKee, ReorderStrategy::CacheWindow }) {
+        PerformanceTimer compileTimer;
+        CompiledNetwork compiled(network, strategy);
+        double compile = compileTimer.getElapsedSeconds();
+
+        PerformanceTimer computeTimer;
+        computer.computeRanks(compiled.getGraph(), 0.85, 100, 0.0000001);
+        double compute = computeTimer.getElapsedSeconds();
+
+        if (strategy == ReorderStrategy::None) {
+            baseCompile = compile;
+            baseCompute = compute;
+        }
+        // Ranks do not depend on the order of pages, so all orders take the same number of
+        // iterations and the compute speedup is also the per-iteration speedup
+        std::cout << "Reordering Performance Test [" << size << " nodes, " << compiled.getNumEdges() << " edges, " << GraphReordering::getName(strategy) << "]"
+                  << " reorder took: " << compile - baseCompile << "s, compute took: " << compute << "s, speedup: " << baseCompute / compute << std::endl;
+    }
+
+    return 0;
+}
@@ -1,7 +1,18 @@
 #ifndef NETWORK_GENERATOR
 #define NETWORK_GENERATOR
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <utility>
+
 #include "../../src/immutable/network.hpp"
+#include "../../src/parallelNetworkReader.hpp"
+#include "../../src/syntheticGraphGenerator.hpp"
+#include "../../src/workerPool.hpp"
 
 class NetworkGenerator {
 public:
@@ -39,6 +50,7 @@ public:
     virtual Network generateNetworkOfSize(uint32_t const size) const
     {
         Network network(this->idGenerator);
+        network.reserve(size);
         for (uint32_t i = 0; i < size; ++i) {
             Page page = this->generatePageFromNum(i);
 
@@ -69,6 +81,7 @@ public:
     Network generateNetworkOfSize(uint32_t const size) const
     {
         Network network(this->idGenerator);
+        network.reserve(size);
         uint32_t connectedPartSize = size / 1000;
 
         for (uint32_t i = 0; i < connectedPartSize; ++i) {
@@ -98,41 +111,167 @@ public:
     }
 };
 
-class StdinGenerator : public NetworkGenerator {
+// Pages with exponentially distributed out-degrees (average averageDegree)
+// linking to targets with power-law distributed in-degrees. Popular targets are
+// scattered over the network, as in crawled web graphs.
+class PowerLawNetworkGenerator : public NetworkGenerator {
 public:
-    StdinGenerator(IdGenerator const& idGeneratorArg)
+    PowerLawNetworkGenerator(IdGenerator const& idGeneratorArg, double averageDegreeArg = 10.0, uint32_t seedArg = 42)
         : NetworkGenerator(idGeneratorArg)
+        , averageDegree(averageDegreeArg)
+        , seed(seedArg)
     {
     }
 
     Network generateNetworkOfSize(uint32_t const size) const
     {
+        std::mt19937 random(this->seed);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+        std::vector<uint32_t> popularity(size);
+        std::vector<PageId> ids;
+        ids.reserve(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            popularity[i] = i;
+            ids.push_back(this->generatePageFromNumWithGeneratedId(i).getId());
+        }
+        std::shuffle(popularity.begin(), popularity.end(), random);
+
         Network network(this->idGenerator);
+        network.reserve(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            Page page = this->generatePageFromNum(i);
+            uint32_t degree = static_cast<uint32_t>(-std::log(1.0 - uniform(random)) * this->averageDegree);
+            for (uint32_t link = 0; link < degree; ++link) {
+                // rank = size * u^3 gives in-degrees falling as a power of the popularity rank
+                double u = uniform(random);
+                uint32_t rank = std::min(size - 1, static_cast<uint32_t>(size * u * u * u));
+                page.addLink(ids[popularity[rank]]);
+            }
+            network.addPage(page);
+        }
 
-        std::string numberOfNodesStr;
-        std::getline(std::cin, numberOfNodesStr);
-        uint32_t numberOfNodes = std::stoul(numberOfNodesStr);
-        ASSERT(numberOfNodes == size, "Incorrect size=" << size << ", fromStdin=" << numberOfNodes);
+        return network;
+    }
 
-        for (uint32_t i = 0; i < numberOfNodes; ++i) {
-            std::string content;
-            std::getline(std::cin, content);
-            Page page(content);
+private:
+    double averageDegree;
+    uint32_t seed;
+};
 
-            std::string edges;
-            std::getline(std::cin, edges);
+// A power-law network with a part of the pages in isolated pairs linking to
+// each other. Ranks of the pairs converge only with the rate alpha (and
+// oscillate), while the rest of the network converges much faster.
+class SlowComponentsNetworkGenerator : public NetworkGenerator {
+public:
+    SlowComponentsNetworkGenerator(IdGenerator const& idGeneratorArg, double slowFractionArg = 0.1)
+        : NetworkGenerator(idGeneratorArg)
+        , slowFraction(slowFractionArg)
+    {
+    }
 
-            std::stringstream edgesStream(edges);
-            std::string edge;
-            while (edgesStream >> edge) {
-                page.addLink(PageId(edge));
-            }
-            //page.generateId(generator);
-            network.addPage(page);
+    Network generateNetworkOfSize(uint32_t const size) const
+    {
+        uint32_t numPairs = static_cast<uint32_t>(size * this->slowFraction / 2);
+        uint32_t coreSize = size - 2 * numPairs;
+        Network network = PowerLawNetworkGenerator(this->idGenerator).generateNetworkOfSize(coreSize);
+        network.reserve(size);
+
+        for (uint32_t i = coreSize; i < size; i += 2) {
+            Page first = this->generatePageFromNum(i);
+            Page second = this->generatePageFromNum(i + 1);
+            first.addLink(this->generatePageFromNumWithGeneratedId(i + 1).getId());
+            second.addLink(this->generatePageFromNumWithGeneratedId(i).getId());
+            network.addPage(first);
+            network.addPage(second);
         }
 
         return network;
     }
+
+private:
+    double slowFraction;
+};
+
+// Network of a SyntheticGraphGenerator created for the requested size, built by
+// a pool of threads. The same size always gives the same network.
+class SyntheticNetworkGenerator : public NetworkGenerator {
+public:
+    typedef std::function<std::shared_ptr<SyntheticGraphGenerator>(uint32_t)> Factory;
+
+    SyntheticNetworkGenerator(IdGenerator const& idGeneratorArg, Factory factoryArg, uint32_t numThreadsArg = std::max(1u, std::thread::hardware_concurrency()))
+        : NetworkGenerator(idGeneratorArg)
+        , factory(factoryArg)
+        , numThreads(numThreadsArg)
+    {
+    }
+
+    Network generateNetworkOfSize(uint32_t const size) const
+    {
+        WorkerPool pool(this->numThreads);
+        return SyntheticGraphWriter::toNetwork(*this->factory(size), this->idGenerator, pool);
+    }
+
+    std::string getName(uint32_t size) const
+    {
+        return this->factory(size)->getName();
+    }
+
+private:
+    Factory factory;
+    uint32_t numThreads;
+};
+
+class RmatNetworkGenerator : public SyntheticNetworkGenerator {
+public:
+    RmatNetworkGenerator(IdGenerator const& idGeneratorArg, double edgeFactor = 16.0, uint64_t seed = 42)
+        : SyntheticNetworkGenerator(idGeneratorArg, [edgeFactor, seed](uint32_t size) {
+            return std::shared_ptr<SyntheticGraphGenerator>(new RmatGraphGenerator(size, edgeFactor, seed));
+        })
+    {
+    }
+};
+
+// Kronecker network of a 3 x 3 initiator with a dense core linked from the
+// rest of the pages and sparse links between the others.
+class KroneckerNetworkGenerator : public SyntheticNetworkGenerator {
+public:
+    KroneckerNetworkGenerator(IdGenerator const& idGeneratorArg, double edgeFactor = 10.0, uint64_t seed = 42)
+        : SyntheticNetworkGenerator(idGeneratorArg, [edgeFactor, seed](uint32_t size) {
+            return std::shared_ptr<SyntheticGraphGenerator>(new KroneckerGraphGenerator({ 0.9, 0.6, 0.2, 0.6, 0.3, 0.1, 0.2, 0.1, 0.1 }, size, edgeFactor, seed));
+        })
+    {
+    }
+};
+
+class ScaleFreeNetworkGenerator : public SyntheticNetworkGenerator {
+public:
+    ScaleFreeNetworkGenerator(IdGenerator const& idGeneratorArg, double averageDegree = 10.0, double outExponent = 2.5, double inExponent = 2.1, double danglingFraction = 0.1, uint64_t seed = 42)
+        : SyntheticNetworkGenerator(idGeneratorArg, [averageDegree, outExponent, inExponent, danglingFraction, seed](uint32_t size) {
+            return std::shared_ptr<SyntheticGraphGenerator>(new PowerLawGraphGenerator(size, averageDegree, seed, outExponent, inExponent, danglingFraction));
+        })
+    {
+    }
+};
+
+class StdinGenerator : public NetworkGenerator {
+public:
+    StdinGenerator(IdGenerator const& idGeneratorArg)
+        : NetworkGenerator(idGeneratorArg)
+        , reader(std::max(1u, std::thread::hardware_concurrency()))
+    {
+    }
+
+    Network generateNetworkOfSize(uint32_t const size) const
+    {
+        Network network = this->reader.readStream(std::cin, this->idGenerator);
+        ASSERT(network.getSize() == size, "Incorrect size=" << size << ", fromStdin=" << network.getSize());
+
+        return network;
+    }
+
+private:
+    ParallelNetworkReader reader;
 };
 
 #endif // NETWORK_GENERATOR
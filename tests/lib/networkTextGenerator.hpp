@@ -0,0 +1,39 @@
+#ifndef NETWORK_TEXT_GENERATOR
+#define NETWORK_TEXT_GENERATOR
+
+#include <random>
+#include <string>
+
+// Generates input in the e2e text format of roughly the given size. Pages have
+// 0-15 links to random page ids, some of them have empty contents.
+std::string generateNetworkText(size_t approximateSize, uint32_t seed)
+{
+    static char const hexDigits[] = "0123456789abcdef";
+    std::mt19937 random(seed);
+
+    std::string body;
+    body.reserve(approximateSize + 1024);
+    uint32_t numberOfNodes = 0;
+    while (body.size() < approximateSize) {
+        if (random() % 50 != 0) {
+            body += "Page content number " + std::to_string(numberOfNodes);
+        }
+        body += '\n';
+
+        uint32_t numLinks = random() % 16;
+        for (uint32_t link = 0; link < numLinks; ++link) {
+            if (link > 0) {
+                body += ' ';
+            }
+            for (uint32_t i = 0; i < 64; ++i) {
+                body += hexDigits[random() % 16];
+            }
+        }
+        body += '\n';
+        numberOfNodes++;
+    }
+
+    return std::to_string(numberOfNodes) + "\n" + body;
+}
+
+#endif // NETWORK_TEXT_GENERATOR
@@ -9,19 +9,22 @@ class PerformanceTimer {
 public:
     PerformanceTimer()
     {
-        this->startTime = std::chrono::system_clock::now();
+        this->startTime = std::chrono::steady_clock::now();
     }
 
     void printTimeDifference(std::string const& activityName)
     {
-        auto end = std::chrono::system_clock::now();
-        std::chrono::duration<double> diff = end - this->startTime;
+        std::cout << activityName << " took: " << std::setw(9) << this->getElapsedSeconds() << "s" << std::endl;
+    }
 
-        std::cout << activityName << " took: " << std::setw(9) << diff.count() << "s" << std::endl;
+    double getElapsedSeconds() const
+    {
+        std::chrono::duration<double> diff = std::chrono::steady_clock::now() - this->startTime;
+        return diff.count();
     }
 
 private:
-    std::chrono::time_point<std::chrono::system_clock> startTime;
+    std::chrono::time_point<std::chrono::steady_clock> startTime;
 };
 
 #endif // PERFORMANCE_TIMER_H_
@@ -0,0 +1,35 @@
+#ifndef TESTS_LIB_POPENSHA256IDGENERATOR_HPP_
+#define TESTS_LIB_POPENSHA256IDGENERATOR_HPP_
+
+#include <cstdio>
+
+#include "../../src/immutable/idGenerator.hpp"
+
+// Former Sha256IdGenerator, shells out to sha256sum for every content.
+// Kept only as a baseline for sha256PerformanceTest.
+class PopenSha256IdGenerator : public IdGenerator {
+public:
+    virtual PageId generateId(std::string const& content) const
+    {
+        return PageId(getCommandOutput("printf \"" + content + "\" | sha256sum"));
+    }
+
+private:
+    const size_t buffer_size = 128;
+
+    std::string getCommandOutput(std::string const& command) const
+    {
+        char buffer[buffer_size];
+        std::string result = "";
+
+        FILE* file = popen(command.c_str(), "r");
+        while (fgets(buffer, buffer_size, file)) {
+            result += buffer;
+        }
+        pclose(file);
+
+        return result.substr(0, result.length() - 4);
+    }
+};
+
+#endif /* TESTS_LIB_POPENSHA256IDGENERATOR_HPP_ */
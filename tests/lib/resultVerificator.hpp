@@ -1,7 +1,9 @@
 #ifndef RESULT_COMPARATOR_HPP_
 #define RESULT_COMPARATOR_HPP_
 
+#include <cmath>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "networkGenerator.hpp"
@@ -69,6 +71,33 @@ public:
             ++iter2;
         }
     };
+
+    // Same pages in the same order, with ranks within maxError
+    static void verifySame(std::vector<PageIdAndRank> const& result, std::vector<PageIdAndRank> const& expected, double maxError)
+    {
+        ASSERT(result.size() == expected.size(), "Unexpected sizes: result=" << result.size() << ", expected=" << expected.size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            ASSERT(result[i].getPageId() == expected[i].getPageId(), "PageId mismatch: " << result[i].getPageId() << "!=" << expected[i].getPageId());
+            ASSERT(std::abs(result[i].getPageRank() - expected[i].getPageRank()) < maxError,
+                "Invalid result, pageId=" << result[i].getPageId() << ", res=" << result[i].getPageRank() << ", expected=" << expected[i].getPageRank());
+        }
+    }
+    // Same pages in any order, ranks may differ by maxError plus maxRelativeError of the expected rank
+    static void verifyRanks(std::vector<PageIdAndRank> const& result, std::vector<PageIdAndRank> const& expected, double maxError, double maxRelativeError)
+    {
+        ASSERT(result.size() == expected.size(), "Unexpected sizes: result=" << result.size() << ", expected=" << expected.size());
+
+        std::unordered_map<PageId, PageRank, PageIdHash> expectedRanks;
+        for (auto const& pageIdAndRank : expected) {
+            expectedRanks[pageIdAndRank.getPageId()] = pageIdAndRank.getPageRank();
+        }
+        for (auto const& pageIdAndRank : result) {
+            auto found = expectedRanks.find(pageIdAndRank.getPageId());
+            ASSERT(found != expectedRanks.end(), "Unexpected page in result: " << pageIdAndRank.getPageId());
+            ASSERT(std::abs(found->second - pageIdAndRank.getPageRank()) < maxError + maxRelativeError * found->second,
+                "Invalid result, pageId=" << pageIdAndRank.getPageId() << ", res=" << pageIdAndRank.getPageRank() << ", expected=" << found->second);
+        }
+    }
 };
 
 #endif // RESULT_COMPARATOR_HPP_
@@ -10,9 +10,21 @@ public:
     {
     }
 
+    // The id starts with the content length and the content itself (hex encoded),
+    // the rest of the 64 hex digits is taken from the hash.
     virtual PageId generateId(std::string const& content) const
     {
-        return this->hash + content;
+        static char const* digits = "0123456789abcdef";
+        ASSERT(content.size() < PageId::numBytes, "Content too long for SimpleIdGenerator: " << content);
+
+        std::string id;
+        id.push_back(digits[content.size() >> 4]);
+        id.push_back(digits[content.size() & 0xf]);
+        for (unsigned char c : content) {
+            id.push_back(digits[c >> 4]);
+            id.push_back(digits[c & 0xf]);
+        }
+        return PageId(id + this->hash.substr(id.size(), PageId::hexLength - id.size()));
     }
 
 private:
@@ -0,0 +1,47 @@
+#include <sstream>
+
+#include "../src/immutable/common.hpp"
+
+#include "../src/parallelNetworkReader.hpp"
+#include "../src/sha256IdGenerator.hpp"
+#include "../src/textNetworkReader.hpp"
+
+#include "./lib/networkTextGenerator.hpp"
+#include "./lib/performanceTimer.hpp"
+
+void printThroughput(std::string const& name, size_t bytes, PerformanceTimer const& timer)
+{
+    double seconds = timer.getElapsedSeconds();
+    std::cout << "Network Reader Performance Test [" << name << "] took: " << seconds << "s, "
+              << bytes / seconds / (1 << 20) << " MB/s" << std::endl;
+}
+
+// Usage: networkReaderPerformanceTest [input size in MB, 1024 for the full 1 GB run]
+int main(int argc, char** argv)
+{
+    ASSERT(argc <= 2, "Too many arguments: " << argc);
+
+    size_t sizeInMegabytes = 64;
+    if (argc == 2) {
+        std::stringstream(argv[1]) >> sizeInMegabytes;
+    }
+
+    Sha256IdGenerator idGenerator;
+    std::string input = generateNetworkText(sizeInMegabytes << 20, 1);
+
+    {
+        std::stringstream in(input);
+        PerformanceTimer timer;
+        Network network = TextNetworkReader::read(in, idGenerator);
+        printThroughput("TextNetworkReader, " + std::to_string(sizeInMegabytes) + " MB", input.size(), timer);
+    }
+
+    for (uint32_t numThreads : { 1, 2, 4, 8 }) {
+        ParallelNetworkReader reader(numThreads);
+        PerformanceTimer timer;
+        Network network = reader.parse(input.data(), input.size(), idGenerator);
+        printThroughput("ParallelNetworkReader[" + std::to_string(numThreads) + "], " + std::to_string(sizeInMegabytes) + " MB", input.size(), timer);
+    }
+
+    return 0;
+}
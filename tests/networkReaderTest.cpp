@@ -0,0 +1,50 @@
+#include <sstream>
+
+#include "../src/immutable/common.hpp"
+
+#include "../src/parallelNetworkReader.hpp"
+#include "../src/sha256IdGenerator.hpp"
+#include "../src/textNetworkReader.hpp"
+
+#include "./lib/networkTextGenerator.hpp"
+
+std::string printNetwork(Network const& network)
+{
+    std::stringstream out;
+    out << network;
+    return out.str();
+}
+
+void verifyInput(std::string const& name, std::string const& input, IdGenerator const& idGenerator)
+{
+    std::stringstream textIn(input);
+    std::string expected = printNetwork(TextNetworkReader::read(textIn, idGenerator));
+
+    for (uint32_t numThreads : { 1, 2, 5 }) {
+        ParallelNetworkReader reader(numThreads);
+        ASSERT(printNetwork(reader.parse(input.data(), input.size(), idGenerator)) == expected,
+            "Parsed network differs, input=" << name << ", numThreads=" << numThreads);
+
+        std::stringstream streamIn(input);
+        ASSERT(printNetwork(reader.readStream(streamIn, idGenerator)) == expected,
+            "Read network differs, input=" << name << ", numThreads=" << numThreads);
+    }
+    std::cout << "Input " << name << " passed" << std::endl;
+}
+
+int main()
+{
+    Sha256IdGenerator idGenerator;
+    std::string const id1 = "43e255cca92dafcf2d317e795c006ab3ebfcf833fc3a9a9c82cc3cb0a1b5251f";
+    std::string const id2 = "b7628d82a284526971095162ba34be8bc05c6e06b9face83b46c2813f7f2157b";
+
+    verifyInput("empty", "0\n", idGenerator);
+    verifyInput("single", "1\nfirst\n" + id1 + "\n", idGenerator);
+    verifyInput("no trailing newline", "2\nfirst\n" + id1 + " " + id2 + "\nsecond\n" + id2, idGenerator);
+    verifyInput("missing last links line", "2\nfirst\n" + id1 + "\nsecond", idGenerator);
+    verifyInput("CRLF", "2\r\nfirst\r\n" + id1 + " \t" + id2 + "\r\n\r\n\r\n", idGenerator);
+    verifyInput("trailing lines", "1\nfirst\n\nignored\n" + id1 + "\n", idGenerator);
+    verifyInput("synthetic", generateNetworkText(5 << 20, 7), idGenerator);
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../src/immutable/common.hpp"
+#include "../src/immutable/pageId.hpp"
+
+#include "../src/pageIdIndex.hpp"
+#include "../src/pageIdMap.hpp"
+#include "../src/workerPool.hpp"
+
+#include "./lib/performanceTimer.hpp"
+
+std::vector<PageId> generatePageIds(size_t size, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    std::vector<PageId> ids(size);
+    for (auto& id : ids) {
+        uint64_t words[4] = { random(), random(), random(), random() };
+        id = PageId::fromBytes(reinterpret_cast<uint8_t const*>(words));
+    }
+    return ids;
+}
+
+// Every id is found at its first position, whichever pool built the index
+void testIndex(uint32_t size, uint32_t numThreads)
+{
+    std::vector<PageId> ids = generatePageIds(size, size);
+    // Every tenth id repeats the one before
+    for (uint32_t i = 10; i < size; i += 10) {
+        ids[i] = ids[i - 1];
+    }
+    WorkerPool pool(numThreads);
+    PageIdIndex index(ids.data(), size, pool);
+    for (uint32_t i = 0; i < size; ++i) {
+        uint32_t expected = (i % 10 == 0 && i > 0) ? i - 1 : i;
+        ASSERT(index.find(ids[i]) == expected, "Invalid index of id=" << i << ", got=" << index.find(ids[i]));
+    }
+    for (auto const& missing : generatePageIds(1000, size + 1)) {
+        ASSERT(index.find(missing) == PageIdIndex::notFound, "Found an id outside of the index");
+    }
+    std::cout << "Page id index [" << size << " ids, " << numThreads << " threads] successed" << std::endl;
+}
+
+// Threads interning overlapping ids give every distinct id exactly one dense index, kept when the table grows
+void testConcurrentInterning(uint32_t numDistinct, uint32_t numThreads)
+{
+    std::vector<PageId> ids = generatePageIds(numDistinct, 7 * numDistinct);
+    PageIdMap map(numDistinct);
+    WorkerPool pool(numThreads);
+    std::vector<std::vector<uint32_t>> indices(numThreads, std::vector<uint32_t>(numDistinct));
+    std::vector<ThreadSlot<uint32_t>> numInterned(numThreads);
+    pool.run([&](uint32_t thread) {
+        // Every thread goes over all ids, starting at a different one
+        numInterned[thread].value = 0;
+        for (uint32_t i = 0; i < numDistinct; ++i) {
+            uint32_t id = (i + thread * (numDistinct / numThreads)) % numDistinct;
+            auto interned = map.insertOrGet(ids[id]);
+            indices[thread][id] = interned.first;
+            numInterned[thread].value += interned.second ? 1 : 0;
+        }
+    });
+
+    uint32_t totalInterned = 0;
+    for (auto const& slot : numInterned) {
+        totalInterned += slot.value;
+    }
+    ASSERT(totalInterned == numDistinct && map.getSize() == numDistinct, "Interned=" << totalInterned << " ids, expected=" << numDistinct);
+
+    std::vector<PageId> interned = map.getPageIds();
+    std::vector<bool> seen(numDistinct, false);
+    for (uint32_t id = 0; id < numDistinct; ++id) {
+        uint32_t index = indices[0][id];
+        ASSERT(index < numDistinct && not seen[index], "Index=" << index << " given twice");
+        seen[index] = true;
+        for (uint32_t thread = 1; thread < numThreads; ++thread) {
+            ASSERT(indices[thread][id] == index, "Threads got different indices of id=" << id);
+        }
+        ASSERT(map.find(ids[id]) == index && interned[index] == ids[id], "Invalid interned id=" << id);
+    }
+
+    // Growing keeps the indices, the grown table interns further ids
+    map.reserve(2 * numDistinct + 16);
+    for (uint32_t id = 0; id < numDistinct; ++id) {
+        ASSERT(map.find(ids[id]) == indices[0][id], "Invalid index of id=" << id << " after growing");
+    }
+    PageId extra = generatePageIds(1, 1)[0];
+    ASSERT(map.find(extra) == PageIdMap::notFound, "Found an id that was not interned");
+    auto added = map.insertOrGet(extra);
+    ASSERT(added.first == numDistinct && added.second && map.find(extra) == numDistinct, "Invalid index of an id interned after growing");
+    std::cout << "Page id interning [" << numDistinct << " ids, " << numThreads << " threads] successed" << std::endl;
+}
+
+// Lookups of present and missing ids in std::unordered_map and in the Swiss tables
+void lookupPerformance(uint32_t size)
+{
+    std::vector<PageId> ids = generatePageIds(size, 42);
+    std::vector<PageId> queries = generatePageIds(size, 43);
+    for (uint32_t i = 0; i < size; i += 2) {
+        queries[i] = ids[(i * 7919ull) % size];
+    }
+    WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()));
+
+    PerformanceTimer timer;
+    std::unordered_map<PageId, uint32_t, PageIdHash> unorderedMap;
+    for (uint32_t i = 0; i < size; ++i) {
+        unorderedMap.emplace(ids[i], i);
+    }
+    double unorderedBuild = timer.getElapsedSeconds();
+    timer = PerformanceTimer();
+    uint64_t unorderedFound = 0;
+    for (auto const& query : queries) {
+        unorderedFound += unorderedMap.count(query);
+    }
+    double unorderedLookup = timer.getElapsedSeconds();
+
+    timer = PerformanceTimer();
+    PageIdIndex index(ids.data(), size, pool);
+    double indexBuild = timer.getElapsedSeconds();
+    timer = PerformanceTimer();
+    uint64_t indexFound = 0;
+    for (auto const& query : queries) {
+        indexFound += index.find(query) != PageIdIndex::notFound ? 1 : 0;
+    }
+    double indexLookup = timer.getElapsedSeconds();
+
+    timer = PerformanceTimer();
+    PageIdMap map(size);
+    pool.run([&](uint32_t thread) {
+        auto range = WorkerPool::range(size, thread, pool.getNumThreads());
+        for (size_t i = range.first; i < range.second; ++i) {
+            map.insertOrGet(ids[i]);
+        }
+    });
+    double mapBuild = timer.getElapsedSeconds();
+    ASSERT(unorderedFound == indexFound && map.getSize() == size, "Tables disagree");
+
+    std::cout << "Page id tables [" << size << " ids]: std::unordered_map build " << unorderedBuild << "s, lookup " << unorderedLookup
+              << "s; PageIdIndex build " << indexBuild << "s, lookup " << indexLookup << "s; PageIdMap interning " << mapBuild << "s on "
+              << pool.getNumThreads() << " threads" << std::endl;
+}
+
+int main()
+{
+    for (uint32_t numThreads : { 1, 3, 7 }) {
+        testIndex(1, numThreads);
+        testIndex(100, numThreads);
+        testIndex(50000, numThreads);
+        testConcurrentInterning(1, numThreads);
+        testConcurrentInterning(20000, numThreads);
+    }
+    testIndex(1000000, 4);
+    testConcurrentInterning(200000, 4);
+
+    lookupPerformance(1000000);
+
+    return 0;
+}
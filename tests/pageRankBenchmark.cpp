@@ -0,0 +1,488 @@
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "../src/immutable/common.hpp"
+#include "../src/immutable/pageIdAndRank.hpp"
+
+#include "../src/acceleratedPageRankComputer.hpp"
+#include "../src/compiledNetwork.hpp"
+#include "../src/computationStats.hpp"
+#include "../src/jsonWriter.hpp"
+#include "../src/multiThreadedPageRankComputer.hpp"
+#include "../src/phaseTimes.hpp"
+#include "../src/samplingProfiler.hpp"
+#include "../src/singleThreadedPageRankComputer.hpp"
+#include "../src/vectorizedPageRankComputer.hpp"
+
+#include "./lib/networkGenerator.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+// Benchmark matrix of graph families x sizes x computers x thread counts.
+// Every cell is run warmup times untimed and then trials times, each on a fresh
+// copy of the same network, and reported as median and p95 of the total time
+// and of every phase, plus edges processed per second of iterating and the peak
+// resident set of the cell.
+//
+// Usage: pageRankBenchmark [--quick] [--trials N] [--warmup N] [--sizes N,N,...]
+//                          [--threads N,N,...] [--filter TEXT] [--json PATH] [--trace PREFIX]
+//                          [--profile PREFIX] [--profile-phase PHASE] [--profile-hz N]
+// --filter keeps cells whose "family/size/computer" contains TEXT, --json
+// writes all results to PATH for comparison between releases. --trace runs
+// every cell once more with ComputationStats attached and writes its Chrome
+// trace to PREFIX<cell>.trace.json. --profile samples one more run of every
+// cell and writes collapsed stacks grouped by phase (only PHASE if given) to
+// PREFIX<cell>.folded, see utils/generateFlameChartSvg.sh.
+
+double const alpha = 0.85;
+double const tolerance = 0.0000001;
+uint32_t const maxIterations = 1000;
+
+struct Measurement {
+    double total;
+    PhaseTimes phases;
+    uint32_t iterations;
+    std::vector<std::pair<std::string, double>> extra; // metrics specific to a computer
+};
+
+struct Subject {
+    std::string name;
+    uint32_t numThreads;
+    std::function<Measurement(Network const&)> run;
+    std::function<void(std::shared_ptr<ComputationStats>)> attachStats;
+};
+
+struct GraphFamily {
+    std::string name;
+    std::shared_ptr<NetworkGenerator> generator;
+};
+
+struct Summary {
+    double median;
+    double p95;
+    double min;
+};
+
+Summary summarize(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    // p95 by the nearest rank
+    size_t p95Index = static_cast<size_t>(std::ceil(0.95 * samples.size())) - 1;
+    size_t middle = samples.size() / 2;
+    double median = samples.size() % 2 == 1 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2.0;
+    return Summary { median, samples[p95Index], samples.front() };
+}
+
+void addExtraMetrics(PageRankComputer const&, Measurement&)
+{
+}
+
+// max / average busy time of the threads, 1 means perfectly balanced work
+template <typename Computer>
+void addImbalance(Computer const& computer, Measurement& measurement)
+{
+    double maxBusyTime = 0.0;
+    double sumBusyTime = 0.0;
+    for (double busyTime : computer.getLastBusyTimes()) {
+        maxBusyTime = std::max(maxBusyTime, busyTime);
+        sumBusyTime += busyTime;
+    }
+    if (sumBusyTime > 0.0) {
+        measurement.extra.push_back(std::make_pair("imbalance", maxBusyTime * computer.getLastBusyTimes().size() / sumBusyTime));
+    }
+}
+
+void addExtraMetrics(MultiThreadedPageRankComputer const& computer, Measurement& measurement)
+{
+    addImbalance(computer, measurement);
+}
+
+void addExtraMetrics(VectorizedPageRankComputer const& computer, Measurement& measurement)
+{
+    addImbalance(computer, measurement);
+}
+
+void addExtraMetrics(AcceleratedPageRankComputer const& computer, Measurement& measurement)
+{
+    AcceleratedPageRankComputer::Statistics statistics = computer.getLastStatistics();
+    measurement.extra.push_back(std::make_pair("extrapolations", static_cast<double>(statistics.extrapolations)));
+    measurement.extra.push_back(std::make_pair("edgeVisits", static_cast<double>(statistics.edgeVisits)));
+}
+
+template <typename Computer>
+Subject makeSubject(uint32_t numThreads, Computer* computerPointer)
+{
+    std::shared_ptr<Computer> computer(computerPointer);
+    return Subject { computer->getName(), numThreads, [computer](Network const& network) {
+                        Measurement measurement;
+                        PhaseStopwatch stopwatch;
+                        std::vector<PageIdAndRank> result = computer->computeForNetwork(network, alpha, maxIterations, tolerance);
+                        measurement.total = stopwatch.lap();
+                        ASSERT(result.size() == network.getSize(), "Invalid result size=" << result.size());
+
+                        measurement.phases = computer->getLastPhaseTimes();
+                        measurement.iterations = computer->getLastIterations();
+                        addExtraMetrics(*computer, measurement);
+                        return measurement;
+                    },
+        [computer](std::shared_ptr<ComputationStats> stats) { computer->attachStats(stats); } };
+}
+
+std::vector<Subject> makeSubjects(std::vector<uint32_t> const& threadCounts)
+{
+    std::vector<Subject> subjects;
+    subjects.push_back(makeSubject(1, new SingleThreadedPageRankComputer()));
+    subjects.push_back(makeSubject(1, new SingleThreadedPageRankComputer(IterationMode::InPlace)));
+    subjects.push_back(makeSubject(1, new AcceleratedPageRankComputer()));
+    for (uint32_t numThreads : threadCounts) {
+        subjects.push_back(makeSubject(numThreads, new MultiThreadedPageRankComputer(numThreads)));
+        subjects.push_back(makeSubject(numThreads, new MultiThreadedPageRankComputer(numThreads, IterationMode::InPlace)));
+        subjects.push_back(makeSubject(numThreads, new VectorizedPageRankComputer(numThreads)));
+        subjects.push_back(makeSubject(numThreads,
+            new VectorizedPageRankComputer(numThreads, VectorizedPageRankComputer::detectKernel(), ReorderStrategy::None, RankPrecision::Float)));
+    }
+    return subjects;
+}
+
+struct Options {
+    bool quick = false;
+    uint32_t trials = 5;
+    uint32_t warmup = 1;
+    std::vector<uint32_t> sizes = { 100000, 1000000 };
+    std::vector<uint32_t> threadCounts = { 1, 2, 4, 8 };
+    std::string filter;
+    std::string jsonPath;
+    std::string tracePrefix;
+    std::string profilePrefix;
+    std::string profilePhase;
+    uint32_t profileFrequency = 1000;
+};
+
+std::vector<uint32_t> parseList(std::string const& text)
+{
+    std::vector<uint32_t> values;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        end = end == std::string::npos ? text.size() : end;
+        values.push_back(static_cast<uint32_t>(std::stoul(text.substr(start, end - start))));
+        start = end + 1;
+    }
+    return values;
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    Options options;
+    bool sizesGiven = false;
+    bool threadsGiven = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--quick") {
+            options.quick = true;
+        } else if (argument == "--trials" && hasValue) {
+            options.trials = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (argument == "--warmup" && hasValue) {
+            options.warmup = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (argument == "--sizes" && hasValue) {
+            options.sizes = parseList(argv[++i]);
+            sizesGiven = true;
+        } else if (argument == "--threads" && hasValue) {
+            options.threadCounts = parseList(argv[++i]);
+            threadsGiven = true;
+        } else if (argument == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (argument == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (argument == "--trace" && hasValue) {
+            options.tracePrefix = argv[++i];
+        } else if (argument == "--profile" && hasValue) {
+            options.profilePrefix = argv[++i];
+        } else if (argument == "--profile-phase" && hasValue) {
+            options.profilePhase = argv[++i];
+        } else if (argument == "--profile-hz" && hasValue) {
+            options.profileFrequency = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else {
+            ASSERT(false, "Unknown argument " << argument << ", usage: " << argv[0]
+                                              << " [--quick] [--trials N] [--warmup N] [--sizes N,...] [--threads N,...] [--filter TEXT] [--json PATH] [--trace PREFIX]"
+                                                 " [--profile PREFIX] [--profile-phase PHASE] [--profile-hz N]");
+        }
+    }
+    if (options.quick) {
+        options.trials = std::min(options.trials, 3u);
+        options.sizes = sizesGiven ? options.sizes : std::vector<uint32_t> { 10000 };
+        options.threadCounts = threadsGiven ? options.threadCounts : std::vector<uint32_t> { 1, 2 };
+    }
+    ASSERT(options.trials > 0, "At least one trial is needed");
+    return options;
+}
+
+struct Record {
+    std::string family;
+    uint32_t size;
+    uint64_t numEdges;
+    std::string computer;
+    uint32_t numThreads;
+    uint32_t trials;
+    uint32_t iterations; // median over the trials
+    Summary total;
+    Summary hashing;
+    Summary build;
+    Summary iterating;
+    Summary output;
+    double edgesPerSecond; // edges processed per second of iterating, median time
+    uint64_t peakRssBytes; // largest resident set during the cell, pristine network included
+    std::vector<std::pair<std::string, double>> extra; // averages over the trials
+};
+
+std::string cellPath(std::string const& prefix, GraphFamily const& family, uint32_t size, Subject const& subject, std::string const& suffix)
+{
+    std::string path = prefix + family.name + "-" + std::to_string(size) + "-";
+    for (char c : subject.name) {
+        path += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    return path + suffix;
+}
+
+// One more untimed run of the cell with stats collected, written as a Chrome trace
+void writeTrace(GraphFamily const& family, uint32_t size, Network const& pristine, Subject const& subject, std::string const& prefix)
+{
+    auto stats = std::make_shared<ComputationStats>();
+    subject.attachStats(stats);
+    Network network = pristine;
+    subject.run(network);
+    subject.attachStats(nullptr);
+
+    std::string path = cellPath(prefix, family, size, subject, ".trace.json");
+    std::ofstream out(path, std::ios::trunc);
+    ASSERT(out.good(), "Cannot open " << path << " for writing");
+    stats->writeChromeTrace(out);
+    out << std::endl;
+    ASSERT(out.good(), "Writing " << path << " failed");
+}
+
+// One more untimed run of the cell under the sampling profiler, stacks are grouped by phase
+void writeProfile(GraphFamily const& family, uint32_t size, Network const& pristine, Subject const& subject, Options const& options)
+{
+    auto stats = std::make_shared<ComputationStats>();
+    subject.attachStats(stats);
+    Network network = pristine;
+    SamplingProfiler profiler(options.profileFrequency);
+    profiler.start();
+    subject.run(network);
+    profiler.stop();
+    subject.attachStats(nullptr);
+
+    std::string path = cellPath(options.profilePrefix, family, size, subject, ".folded");
+    std::ofstream out(path, std::ios::trunc);
+    ASSERT(out.good(), "Cannot open " << path << " for writing");
+    profiler.writeCollapsedStacks(out, stats.get(), options.profilePhase);
+    ASSERT(out.good(), "Writing " << path << " failed");
+}
+
+// Lowers the peak resident set of the process to the current one (Linux 4.0+), so
+// that every cell reports its own peak rather than the largest one so far
+void resetPeakRss()
+{
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5" << std::endl;
+}
+
+// Largest resident set since the last reset, the largest one of the process where it cannot be reset
+uint64_t getPeakRssBytes()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+    struct rusage usage;
+    ASSERT(getrusage(RUSAGE_SELF, &usage) == 0, "Cannot read resource usage");
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+Record runCell(GraphFamily const& family, uint32_t size, uint64_t numEdges, Network const& pristine, Subject const& subject, Options const& options)
+{
+    resetPeakRss();
+    for (uint32_t i = 0; i < options.warmup; ++i) {
+        Network network = pristine;
+        subject.run(network);
+    }
+
+    std::vector<Measurement> measurements;
+    for (uint32_t i = 0; i < options.trials; ++i) {
+        // Page ids are generated by the computation, so every trial needs an untouched network
+        Network network = pristine;
+        measurements.push_back(subject.run(network));
+    }
+
+    Record record;
+    record.peakRssBytes = getPeakRssBytes();
+    record.family = family.name;
+    record.size = size;
+    record.numEdges = numEdges;
+    record.computer = subject.name;
+    record.numThreads = subject.numThreads;
+    record.trials = options.trials;
+
+    auto summarizeOf = [&measurements](std::function<double(Measurement const&)> const& metric) {
+        std::vector<double> samples;
+        for (auto const& measurement : measurements) {
+            samples.push_back(metric(measurement));
+        }
+        return summarize(samples);
+    };
+    record.total = summarizeOf([](Measurement const& m) { return m.total; });
+    record.hashing = summarizeOf([](Measurement const& m) { return m.phases.hashing; });
+    record.build = summarizeOf([](Measurement const& m) { return m.phases.build; });
+    record.iterating = summarizeOf([](Measurement const& m) { return m.phases.iterations; });
+    record.output = summarizeOf([](Measurement const& m) { return m.phases.output; });
+    record.iterations = static_cast<uint32_t>(summarizeOf([](Measurement const& m) { return static_cast<double>(m.iterations); }).median);
+    record.edgesPerSecond = record.iterating.median > 0.0 ? static_cast<double>(numEdges) * record.iterations / record.iterating.median : 0.0;
+
+    if (not options.tracePrefix.empty()) {
+        writeTrace(family, size, pristine, subject, options.tracePrefix);
+    }
+    if (not options.profilePrefix.empty()) {
+        writeProfile(family, size, pristine, subject, options);
+    }
+
+    for (size_t metric = 0; metric < measurements.front().extra.size(); ++metric) {
+        double sum = 0.0;
+        for (auto const& measurement : measurements) {
+            sum += measurement.extra[metric].second;
+        }
+        record.extra.push_back(std::make_pair(measurements.front().extra[metric].first, sum / measurements.size()));
+    }
+    return record;
+}
+
+void printRecord(Record const& record)
+{
+    std::cout << std::fixed << std::setprecision(4) << record.family << " [" << record.size << " nodes, " << record.numEdges << " edges] " << record.computer
+              << ": total " << record.total.median << "s (p95 " << record.total.p95 << "s), hashing " << record.hashing.median << "s, build "
+              << record.build.median << "s, iterations " << record.iterating.median << "s, output " << record.output.median << "s, " << record.iterations
+              << " iterations, " << std::setprecision(1) << record.edgesPerSecond / 1e6 << "M edges/s, peak RSS " << record.peakRssBytes / (1 << 20) << " MB";
+    for (auto const& metric : record.extra) {
+        std::cout << std::setprecision(3) << ", " << metric.first << " " << metric.second;
+    }
+    std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+}
+
+void writeSummary(JsonWriter& json, std::string const& name, Summary const& summary)
+{
+    json.key(name).beginObject().field("median", summary.median).field("p95", summary.p95).field("min", summary.min).endObject();
+}
+
+void writeJson(std::string const& path, Options const& options, std::vector<Record> const& records)
+{
+    std::ofstream out(path, std::ios::trunc);
+    ASSERT(out.good(), "Cannot open " << path << " for writing");
+
+    JsonWriter json(out);
+    json.beginObject();
+    json.field("benchmark", "pageRank");
+    json.field("timestamp", static_cast<uint64_t>(std::time(nullptr)));
+    json.key("machine").beginObject();
+    json.field("hardwareThreads", std::thread::hardware_concurrency());
+    json.field("compiler", __VERSION__);
+#ifdef NDEBUG
+    json.field("optimized", true);
+#else
+    json.field("optimized", false);
+#endif
+    json.endObject();
+    json.key("config").beginObject();
+    json.field("alpha", alpha).field("tolerance", tolerance).field("maxIterations", maxIterations);
+    json.field("trials", options.trials).field("warmup", options.warmup).field("filter", options.filter);
+    json.endObject();
+
+    json.key("results").beginArray();
+    for (auto const& record : records) {
+        json.beginObject();
+        json.field("family", record.family).field("size", record.size).field("edges", record.numEdges);
+        json.field("computer", record.computer).field("threads", record.numThreads).field("trials", record.trials);
+        json.field("iterations", record.iterations).field("edgesPerSecond", record.edgesPerSecond).field("peakRssBytes", record.peakRssBytes);
+        writeSummary(json, "total", record.total);
+        json.key("phases").beginObject();
+        writeSummary(json, "hashing", record.hashing);
+        writeSummary(json, "build", record.build);
+        writeSummary(json, "iterations", record.iterating);
+        writeSummary(json, "output", record.output);
+        json.endObject();
+        json.key("extra").beginObject();
+        for (auto const& metric : record.extra) {
+            json.field(metric.first, metric.second);
+        }
+        json.endObject();
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    out << std::endl;
+    ASSERT(out.good(), "Writing " << path << " failed");
+}
+
+int main(int argc, char** argv)
+{
+    Options options = parseOptions(argc, argv);
+
+    SimpleIdGenerator idGenerator("2000f1ffa5ce95d0f1e1893598e6aeeb2c214c85a88e3569d62c2dccd06a8725");
+    std::vector<GraphFamily> families = {
+        { "sparse", std::make_shared<NetworkWithoutManyEdgesGenerator>(idGenerator) },
+        { "powerlaw", std::make_shared<PowerLawNetworkGenerator>(idGenerator) },
+        { "slowcomponents", std::make_shared<SlowComponentsNetworkGenerator>(idGenerator) },
+        { "rmat", std::make_shared<RmatNetworkGenerator>(idGenerator) },
+        { "kronecker", std::make_shared<KroneckerNetworkGenerator>(idGenerator) },
+        { "scalefree", std::make_shared<ScaleFreeNetworkGenerator>(idGenerator) },
+    };
+    std::vector<Subject> subjects = makeSubjects(options.threadCounts);
+
+    std::vector<Record> records;
+    for (auto const& family : families) {
+        for (uint32_t size : options.sizes) {
+            std::vector<Subject const*> selected;
+            for (auto const& subject : subjects) {
+                if ((family.name + "/" + std::to_string(size) + "/" + subject.name).find(options.filter) != std::string::npos) {
+                    selected.push_back(&subject);
+                }
+            }
+            if (selected.empty()) {
+                continue;
+            }
+
+            Network pristine = family.generator->generateNetworkOfSize(size);
+            uint64_t numEdges = 0;
+            {
+                // Freed before the cells run, their peaks include only the pristine network
+                Network hashed = pristine;
+                hashed.generateIds(0, hashed.getSize());
+                numEdges = CompiledNetwork(hashed).getNumEdges();
+            }
+
+            for (auto subject : selected) {
+                records.push_back(runCell(family, size, numEdges, pristine, *subject, options));
+                printRecord(records.back());
+            }
+        }
+    }
+
+    if (not options.jsonPath.empty()) {
+        writeJson(options.jsonPath, options, records);
+        std::cout << "Wrote " << records.size() << " results to " << options.jsonPath << std::endl;
+    }
+    return 0;
+}
@@ -1,10 +1,14 @@
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #include "../src/immutable/common.hpp"
 #include "../src/immutable/pageIdAndRank.hpp"
+#include "../src/acceleratedPageRankComputer.hpp"
+#include "../src/incrementalPageRankComputer.hpp"
 #include "../src/multiThreadedPageRankComputer.hpp"
 #include "../src/singleThreadedPageRankComputer.hpp"
+#include "../src/vectorizedPageRankComputer.hpp"
 
 #include "./lib/networkGenerator.hpp"
 #include "./lib/resultVerificator.hpp"
@@ -29,6 +33,7 @@ int main()
     };
     std::vector<std::shared_ptr<PageRankComputer>> computersToTest = {
         std::shared_ptr<PageRankComputer>(new SingleThreadedPageRankComputer {}),
+        std::shared_ptr<PageRankComputer>(new SingleThreadedPageRankComputer { IterationMode::InPlace }),
         std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 1 }),
         std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 2 }),
         std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 3 }),
@@ -37,7 +42,29 @@ int main()
         std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 7 }),
         std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 8 }),
         std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 9 }),
+        std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 1, IterationMode::InPlace }),
+        std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 3, IterationMode::InPlace }),
+        // Two nodes sharing CPU 0, so that the NUMA mode runs on any machine
+        std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 3, MultiThreadedPageRankComputer::ExecutionMode::Numa, NumaTopology({ { 0, { 0 } }, { 1, { 0 } } }) }),
+        // CPU 1000 cannot be pinned, so the NUMA mode falls back to the shared layout
+        std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 3, MultiThreadedPageRankComputer::ExecutionMode::Numa, NumaTopology({ { 0, { 0 } }, { 1, { 1000 } } }) }),
+        std::shared_ptr<PageRankComputer>(new MultiThreadedPageRankComputer { 4, MultiThreadedPageRankComputer::ExecutionMode::Numa }),
+        std::shared_ptr<PageRankComputer>(new VectorizedPageRankComputer { 1, VectorizedPageRankComputer::Kernel::Scalar }),
+        std::shared_ptr<PageRankComputer>(new VectorizedPageRankComputer { 3, VectorizedPageRankComputer::Kernel::Scalar }),
+        std::shared_ptr<PageRankComputer>(new VectorizedPageRankComputer { 1 }),
+        std::shared_ptr<PageRankComputer>(new VectorizedPageRankComputer { 4 }),
+        std::shared_ptr<PageRankComputer>(new VectorizedPageRankComputer { 2, VectorizedPageRankComputer::Kernel::Scalar, ReorderStrategy::InDegree }),
+        std::shared_ptr<PageRankComputer>(new VectorizedPageRankComputer { 2, VectorizedPageRankComputer::Kernel::Scalar, ReorderStrategy::ReverseCuthillMcKee }),
+        std::shared_ptr<PageRankComputer>(new VectorizedPageRankComputer { 2, VectorizedPageRankComputer::Kernel::Scalar, ReorderStrategy::CacheWindow }),
+        std::shared_ptr<PageRankComputer>(new IncrementalPageRankComputer {}),
+        std::shared_ptr<PageRankComputer>(new AcceleratedPageRankComputer {}),
+        std::shared_ptr<PageRankComputer>(new AcceleratedPageRankComputer { AcceleratedPageRankComputer::Extrapolation::Aitken, true }),
+        std::shared_ptr<PageRankComputer>(new AcceleratedPageRankComputer { AcceleratedPageRankComputer::Extrapolation::Quadratic, false }),
+        std::shared_ptr<PageRankComputer>(new AcceleratedPageRankComputer { AcceleratedPageRankComputer::Extrapolation::None, true }),
     };
+    if (VectorizedPageRankComputer::isKernelSupported(VectorizedPageRankComputer::Kernel::Avx2)) {
+        computersToTest.push_back(std::shared_ptr<PageRankComputer>(new VectorizedPageRankComputer { 2, VectorizedPageRankComputer::Kernel::Avx2 }));
+    }
 
     SimpleIdGenerator idGenerator("b7628d82a284526971095162ba34be8bc05c6e06b9face83b46c2813f7f2157b");
     SimpleNetworkGenerator networkGenerator(idGenerator);
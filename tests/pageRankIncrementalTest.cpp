@@ -0,0 +1,153 @@
+#include <map>
+#include <unordered_map>
+
+#include "../src/immutable/common.hpp"
+#include "../src/immutable/pageIdAndRank.hpp"
+#include "../src/incrementalPageRankComputer.hpp"
+#include "../src/singleThreadedPageRankComputer.hpp"
+
+#include "./lib/resultVerificator.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+// Pages of the network (by content number) and their links
+struct NetworkDescription {
+    std::vector<uint32_t> pages;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> links;
+};
+
+PageId pageIdOf(IdGenerator const& idGenerator, uint32_t num)
+{
+    return idGenerator.generateId(std::to_string(num));
+}
+
+Network buildNetwork(IdGenerator const& idGenerator, NetworkDescription const& description)
+{
+    Network network(idGenerator);
+    for (uint32_t num : description.pages) {
+        Page page(std::to_string(num));
+        auto links = description.links.find(num);
+        if (links != description.links.end()) {
+            for (uint32_t target : links->second) {
+                page.addLink(pageIdOf(idGenerator, target));
+            }
+        }
+        network.addPage(page);
+    }
+    return network;
+}
+
+void removeLink(NetworkDescription& description, uint32_t from, uint32_t to)
+{
+    auto& links = description.links[from];
+    links.erase(std::find(links.begin(), links.end(), to));
+}
+
+int main()
+{
+    double const alpha = 0.85;
+    double const tolerance = 1e-12;
+    uint32_t const size = 2000;
+
+    SimpleIdGenerator idGenerator("b7628d82a284526971095162ba34be8bc05c6e06b9face83b46c2813f7f2157b");
+    SingleThreadedPageRankComputer referenceComputer;
+    IncrementalPageRankComputer computer;
+
+    NetworkDescription description;
+    for (uint32_t i = 0; i < size; ++i) {
+        description.pages.push_back(i);
+        for (uint32_t j = 0; j < size; ++j) {
+            if (i != j && i % 11 != 4 && (i * 7 + j * 13) % 97 == 0) {
+                description.links[i].push_back(j);
+            }
+        }
+    }
+
+    std::cout << "Starting full computation" << std::endl;
+    auto result = computer.computeForNetwork(buildNetwork(idGenerator, description), alpha, 1000, tolerance);
+    ResultVerificator::verifyRanks(result, referenceComputer.computeForNetwork(buildNetwork(idGenerator, description), alpha, 1000, tolerance), 0.0, 1e-6);
+    uint64_t fullPushes = computer.getLastNumPushes();
+    std::cout << "Full computation finished with successed, pushes=" << fullPushes << std::endl;
+
+    std::cout << "Starting update with added and removed pages and links" << std::endl;
+    NetworkDelta delta(idGenerator);
+    for (uint32_t num : { 5, 17 }) {
+        delta.removePage(pageIdOf(idGenerator, num));
+        description.pages.erase(std::find(description.pages.begin(), description.pages.end(), num));
+        description.links.erase(num);
+    }
+    std::map<uint32_t, std::vector<uint32_t>> addedPages = {
+        { size, { 3, size + 1 } }, // links to a page added later in the same delta
+        { size + 1, { size, 5 } }, // links to a removed page
+        { size + 2, {} }, // dangling
+    };
+    for (auto const& added : addedPages) {
+        Page page(std::to_string(added.first));
+        for (uint32_t target : added.second) {
+            page.addLink(pageIdOf(idGenerator, target));
+        }
+        delta.addPage(page);
+        description.pages.push_back(added.first);
+        description.links[added.first] = added.second;
+    }
+    for (auto const& link : std::vector<std::pair<uint32_t, uint32_t>> { { 10, size }, { 11, size + 2 }, { 4, 1 } }) {
+        delta.addLink(pageIdOf(idGenerator, link.first), pageIdOf(idGenerator, link.second));
+        description.links[link.first].push_back(link.second);
+    }
+    for (uint32_t from : { 20, 21 }) {
+        uint32_t to = description.links[from].front();
+        delta.removeLink(pageIdOf(idGenerator, from), pageIdOf(idGenerator, to));
+        removeLink(description, from, to);
+    }
+
+    result = computer.updateForNetwork(result, delta, alpha, 1000, tolerance);
+    ResultVerificator::verifyRanks(result, referenceComputer.computeForNetwork(buildNetwork(idGenerator, description), alpha, 1000, tolerance), 0.0, 1e-6);
+    std::cout << "Update finished with successed, pushes=" << computer.getLastNumPushes() << std::endl;
+
+    std::cout << "Starting update removing a page added by the previous update" << std::endl;
+    NetworkDelta secondDelta(idGenerator);
+    secondDelta.removePage(pageIdOf(idGenerator, size));
+    description.pages.erase(std::find(description.pages.begin(), description.pages.end(), size));
+    description.links.erase(size);
+    secondDelta.addLink(pageIdOf(idGenerator, 0), pageIdOf(idGenerator, 1));
+    description.links[0].push_back(1);
+
+    result = computer.updateForNetwork(result, secondDelta, alpha, 1000, tolerance);
+    ResultVerificator::verifyRanks(result, referenceComputer.computeForNetwork(buildNetwork(idGenerator, description), alpha, 1000, tolerance), 0.0, 1e-6);
+    std::cout << "Update finished with successed, pushes=" << computer.getLastNumPushes() << std::endl;
+
+    std::cout << "Starting update adding back a removed page" << std::endl;
+    NetworkDelta thirdDelta(idGenerator);
+    Page readded(std::to_string(5));
+    readded.addLink(pageIdOf(idGenerator, 6));
+    thirdDelta.addPage(readded);
+    description.pages.push_back(5);
+    description.links[5] = { 6 };
+
+    result = computer.updateForNetwork(result, thirdDelta, alpha, 1000, tolerance);
+    ResultVerificator::verifyRanks(result, referenceComputer.computeForNetwork(buildNetwork(idGenerator, description), alpha, 1000, tolerance), 0.0, 1e-6);
+    std::cout << "Update finished with successed, pushes=" << computer.getLastNumPushes() << std::endl;
+
+    std::cout << "Starting updates of views" << std::endl;
+    IncrementalPageRankComputer viewComputer;
+    auto view = viewComputer.computeViewForNetwork(buildNetwork(idGenerator, description), alpha, 1000, tolerance);
+    for (uint32_t step = 0; step < 3; ++step) {
+        NetworkDelta viewDelta(idGenerator);
+        uint32_t from = 100 + step;
+        viewDelta.addLink(pageIdOf(idGenerator, from), pageIdOf(idGenerator, 3 * step + 1));
+        description.links[from].push_back(3 * step + 1);
+
+        uint64_t epoch = view.getEpoch();
+        view = viewComputer.updateView(view, viewDelta, alpha, 1000, tolerance);
+        ASSERT(view.getEpoch() == epoch + 1, "Invalid epoch=" << view.getEpoch());
+        auto expected = referenceComputer.computeForNetwork(buildNetwork(idGenerator, description), alpha, 1000, tolerance);
+        ResultVerificator::verifyRanks(view.toVector(), expected, 0.0, 1e-6);
+        auto changed = view.getChangedRanks();
+        ASSERT(changed.size() < view.getSize(), "Every page changed after adding a link");
+        for (auto const& pageIdAndRank : changed) {
+            ASSERT(view.getRank(pageIdAndRank.getPageId()) == pageIdAndRank.getPageRank(), "Invalid changed rank of page=" << pageIdAndRank.getPageId());
+        }
+        std::cout << "View update finished with successed, pushes=" << viewComputer.getLastNumPushes() << ", changed pages=" << changed.size() << std::endl;
+    }
+
+    return 0;
+}
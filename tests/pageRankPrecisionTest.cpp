@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <unordered_map>
+
+#include "../src/immutable/common.hpp"
+#include "../src/immutable/pageIdAndRank.hpp"
+
+#include "../src/singleThreadedPageRankComputer.hpp"
+#include "../src/vectorizedPageRankComputer.hpp"
+
+#include "./lib/networkGenerator.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+struct PrecisionScenario {
+    uint32_t numberOfNodes;
+    double alpha;
+    bool powerLaw;
+};
+
+struct Errors {
+    double maxRelative;
+    double l1;
+    double discordantPairs; // fraction of page pairs ordered differently than by the reference
+};
+
+// Counts inversions of values by merge sort
+uint64_t countInversions(std::vector<double>& values, std::vector<double>& buffer, size_t start, size_t end)
+{
+    if (end - start < 2) {
+        return 0;
+    }
+    size_t middle = start + (end - start) / 2;
+    uint64_t inversions = countInversions(values, buffer, start, middle) + countInversions(values, buffer, middle, end);
+
+    size_t left = start;
+    size_t right = middle;
+    size_t out = start;
+    while (left < middle || right < end) {
+        if (right == end || (left < middle && values[left] <= values[right])) {
+            buffer[out++] = values[left++];
+        } else {
+            inversions += middle - left;
+            buffer[out++] = values[right++];
+        }
+    }
+    std::copy(buffer.begin() + start, buffer.begin() + end, values.begin() + start);
+    return inversions;
+}
+
+Errors compareWithReference(std::vector<PageIdAndRank> const& result, std::vector<PageIdAndRank> const& reference)
+{
+    ASSERT(result.size() == reference.size(), "Unexpected sizes: result=" << result.size() << ", reference=" << reference.size());
+
+    std::unordered_map<PageId, PageRank, PageIdHash> ranks;
+    for (auto const& pageIdAndRank : result) {
+        ranks[pageIdAndRank.getPageId()] = pageIdAndRank.getPageRank();
+    }
+
+    Errors errors = { 0.0, 0.0, 0.0 };
+    // Ranks of the result listed in the order of the reference ranks, ties of the reference broken by the result
+    std::vector<std::pair<double, double>> pairs;
+    for (auto const& expected : reference) {
+        auto found = ranks.find(expected.getPageId());
+        ASSERT(found != ranks.end(), "Missing page in result: " << expected.getPageId());
+        double error = std::abs(found->second - expected.getPageRank());
+        errors.maxRelative = std::max(errors.maxRelative, error / expected.getPageRank());
+        errors.l1 += error;
+        pairs.push_back(std::make_pair(expected.getPageRank(), found->second));
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+    std::vector<double> values;
+    for (auto const& pair : pairs) {
+        values.push_back(pair.second);
+    }
+    std::vector<double> buffer(values.size());
+    double numPairs = values.size() * (values.size() - 1) / 2.0;
+    errors.discordantPairs = numPairs == 0 ? 0.0 : countInversions(values, buffer, 0, values.size()) / numPairs;
+    return errors;
+}
+
+int main()
+{
+    // Scenarios of pageRankCalculationTest and larger power-law graphs
+    std::vector<PrecisionScenario> scenarios = {
+        { 3, 0.85, false },
+        { 3, 0.15, false },
+        { 5, 0.85, false },
+        { 100, 0.85, false },
+        { 2000, 0.85, false },
+        { 50000, 0.85, true },
+    };
+    // Bounds on the maximal relative error of every storage type
+    std::vector<std::pair<RankPrecision, double>> precisions = {
+        { RankPrecision::Float, 1e-5 },
+        { RankPrecision::BFloat16, 2e-2 },
+    };
+
+    SimpleIdGenerator idGenerator("b7628d82a284526971095162ba34be8bc05c6e06b9face83b46c2813f7f2157b");
+    SimpleNetworkGenerator simpleGenerator(idGenerator);
+    PowerLawNetworkGenerator powerLawGenerator(idGenerator);
+    SingleThreadedPageRankComputer referenceComputer;
+
+    for (auto const& scenario : scenarios) {
+        NetworkGenerator const& generator = scenario.powerLaw ? static_cast<NetworkGenerator const&>(powerLawGenerator) : simpleGenerator;
+        auto reference = referenceComputer.computeForNetwork(generator.generateNetworkOfSize(scenario.numberOfNodes), scenario.alpha, 100, 0.0000001);
+
+        for (auto const& precision : precisions) {
+            VectorizedPageRankComputer computer(2, VectorizedPageRankComputer::detectKernel(), ReorderStrategy::None, precision.first);
+            auto result = computer.computeForNetwork(generator.generateNetworkOfSize(scenario.numberOfNodes), scenario.alpha, 100, 0.0000001);
+            Errors errors = compareWithReference(result, reference);
+
+            std::cout << "Precision Test [" << scenario.numberOfNodes << " nodes, alpha=" << scenario.alpha << ", " << computer.getName() << "]"
+                      << " max relative error: " << errors.maxRelative << ", L1 error: " << errors.l1
+                      << ", discordant pairs: " << errors.discordantPairs << std::endl;
+            ASSERT(errors.maxRelative < precision.second, "Relative error=" << errors.maxRelative << " above bound=" << precision.second);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "../src/immutable/common.hpp"
+#include "../src/immutable/pageIdAndRank.hpp"
+
+#include "../src/parameterSweepPageRankComputer.hpp"
+#include "../src/singleThreadedPageRankComputer.hpp"
+#include "../src/vectorizedPageRankComputer.hpp"
+
+#include "./lib/networkGenerator.hpp"
+#include "./lib/performanceTimer.hpp"
+#include "./lib/resultVerificator.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+typedef ParameterSweepPageRankComputer::Parameters Parameters;
+
+// Every parameter set gives the same ranks and iterations as a separate computation
+void testSweep(ParameterSweepPageRankComputer const& computer, NetworkGenerator const& networkGenerator, uint32_t size, std::vector<Parameters> const& parameters)
+{
+    auto results = computer.computeForNetwork(networkGenerator.generateNetworkOfSize(size), parameters, 1000);
+    ASSERT(results.size() == parameters.size(), "Unexpected number of results=" << results.size());
+
+    std::cout << "Sweep [" << size << " nodes, " << computer.getName() << "]:";
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        SingleThreadedPageRankComputer single;
+        auto expected = single.computeForNetwork(networkGenerator.generateNetworkOfSize(size), parameters[i].alpha, 1000, parameters[i].tolerance);
+        ResultVerificator::verifySame(results[i], expected, 0.0000001);
+        ASSERT(computer.getLastIterations()[i] == single.getLastIterations(),
+            "Unexpected iterations=" << computer.getLastIterations()[i] << " for alpha=" << parameters[i].alpha << ", expected=" << single.getLastIterations());
+        std::cout << " alpha=" << parameters[i].alpha << " in " << computer.getLastIterations()[i] << " iterations";
+    }
+    std::cout << ", successed" << std::endl;
+}
+
+// Compares one sweep with a computation per parameter set
+void sweepPerformance(ParameterSweepPageRankComputer const& computer, PageRankComputer const& separateComputer, NetworkGenerator const& networkGenerator, uint32_t size, std::vector<Parameters> const& parameters)
+{
+    Network network = networkGenerator.generateNetworkOfSize(size);
+    PerformanceTimer sweepTimer;
+    computer.computeForNetwork(network, parameters, 1000);
+    sweepTimer.printTimeDifference("Parameter sweep [" + std::to_string(size) + " nodes, " + std::to_string(parameters.size()) + " sets, " + computer.getName() + "]");
+
+    std::vector<Network> networks;
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        networks.push_back(networkGenerator.generateNetworkOfSize(size));
+    }
+    PerformanceTimer separateTimer;
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        separateComputer.computeForNetwork(networks[i], parameters[i].alpha, 1000, parameters[i].tolerance);
+    }
+    separateTimer.printTimeDifference("Parameter sweep [" + std::to_string(size) + " nodes, " + std::to_string(parameters.size()) + " sets, separately with " + separateComputer.getName() + "]");
+}
+
+int main()
+{
+    SimpleIdGenerator idGenerator("5e1f4c8a2b6d0e9f3a7c1b5d9e3f7a2c6b0d4e8f2a6c0b4d8e2f6a0c4b8d2e6f");
+    SimpleNetworkGenerator simpleGenerator(idGenerator);
+    PowerLawNetworkGenerator powerLawGenerator(idGenerator);
+
+    std::vector<Parameters> parameters = { { 0.5, 0.0000001 }, { 0.85, 0.0000001 }, { 0.9, 0.0000001 }, { 0.99, 0.0000001 } };
+    std::vector<Parameters> mixedTolerances = { { 0.85, 0.001 }, { 0.15, 0.0000001 }, { 0.85, 0.0000001 }, { 0.0, 0.0000001 }, { 0.85, 0.00001 } };
+
+    for (uint32_t numThreads : { 1, 2, 3 }) {
+        ParameterSweepPageRankComputer computer(numThreads);
+        testSweep(computer, simpleGenerator, 5, parameters);
+        testSweep(computer, simpleGenerator, 100, parameters);
+        testSweep(computer, simpleGenerator, 100, mixedTolerances);
+        testSweep(computer, powerLawGenerator, 5000, parameters);
+        testSweep(computer, powerLawGenerator, 5000, { { 0.85, 0.0000001 } });
+    }
+
+    sweepPerformance(ParameterSweepPageRankComputer { 1 }, VectorizedPageRankComputer { 1 }, powerLawGenerator, 100000, parameters);
+
+    return 0;
+}
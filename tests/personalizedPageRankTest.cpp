@@ -0,0 +1,169 @@
+#include <random>
+#include <unordered_map>
+
+#include "../src/immutable/common.hpp"
+#include "../src/immutable/pageIdAndRank.hpp"
+
+#include "../src/personalizedPageRankComputer.hpp"
+#include "../src/singleThreadedPageRankComputer.hpp"
+
+#include "./lib/networkGenerator.hpp"
+#include "./lib/performanceTimer.hpp"
+#include "./lib/resultVerificator.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+typedef PersonalizedPageRankComputer::TeleportVector TeleportVector;
+
+// Straightforward power iteration of personalized PageRank, page ids have to be generated
+std::vector<PageIdAndRank> computeReference(Network const& network, TeleportVector const& teleport, double alpha)
+{
+    auto const& pages = network.getPages();
+    std::unordered_map<PageId, size_t, PageIdHash> indices;
+    for (size_t i = 0; i < pages.size(); ++i) {
+        indices[pages[i].getId()] = i;
+    }
+
+    std::vector<double> jumps(pages.size(), 0.0);
+    double totalWeight = 0.0;
+    for (auto const& seed : teleport) {
+        totalWeight += seed.second;
+    }
+    for (auto const& seed : teleport) {
+        jumps[indices.at(seed.first)] += seed.second / totalWeight;
+    }
+
+    std::vector<double> ranks = jumps;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        double dangleSum = 0.0;
+        std::vector<double> next(pages.size(), 0.0);
+        for (size_t page = 0; page < pages.size(); ++page) {
+            auto const& links = pages[page].getLinks();
+            if (links.empty()) {
+                dangleSum += ranks[page];
+            }
+            for (auto const& link : links) {
+                auto target = indices.find(link);
+                if (target != indices.end()) {
+                    next[target->second] += alpha * ranks[page] / links.size();
+                }
+            }
+        }
+
+        double difference = 0.0;
+        for (size_t page = 0; page < pages.size(); ++page) {
+            next[page] += ((1.0 - alpha) + alpha * dangleSum) * jumps[page];
+            difference += std::abs(next[page] - ranks[page]);
+        }
+        ranks.swap(next);
+        if (difference < 1e-13) {
+            break;
+        }
+    }
+
+    std::vector<PageIdAndRank> result;
+    for (size_t page = 0; page < pages.size(); ++page) {
+        result.push_back(PageIdAndRank(pages[page].getId(), ranks[page]));
+    }
+    return result;
+}
+
+std::vector<TeleportVector> generateTeleports(NetworkGenerator const& networkGenerator, uint32_t networkSize, uint32_t count, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<uint32_t> pages(0, networkSize - 1);
+    std::uniform_int_distribution<uint32_t> sizes(1, 6);
+    std::uniform_real_distribution<double> weights(0.1, 1.0);
+
+    std::vector<TeleportVector> teleports(count);
+    for (auto& teleport : teleports) {
+        uint32_t size = sizes(random);
+        for (uint32_t i = 0; i < size; ++i) {
+            teleport.push_back(std::make_pair(networkGenerator.generatePageFromNumWithGeneratedId(pages(random)).getId(), weights(random)));
+        }
+    }
+    return teleports;
+}
+
+// A teleport vector over all pages gives the ordinary PageRank
+void testUniformTeleport(PersonalizedPageRankComputer const& computer, NetworkGenerator const& networkGenerator, uint32_t size)
+{
+    TeleportVector uniform;
+    for (uint32_t i = 0; i < size; ++i) {
+        uniform.push_back(std::make_pair(networkGenerator.generatePageFromNumWithGeneratedId(i).getId(), 1.0));
+    }
+
+    auto results = computer.computeForNetwork(networkGenerator.generateNetworkOfSize(size), { uniform }, 0.85, 100, 0.0000001);
+    auto expected = SingleThreadedPageRankComputer().computeForNetwork(networkGenerator.generateNetworkOfSize(size), 0.85, 100, 0.0000001);
+    ASSERT(results.size() == 1, "Unexpected number of results=" << results.size());
+    ResultVerificator::verifySame(results[0], expected, 0.000001);
+
+    std::cout << "Uniform teleport [" << size << " nodes, " << computer.getName() << "] successed" << std::endl;
+}
+
+void testBatch(PersonalizedPageRankComputer const& computer, NetworkGenerator const& networkGenerator, uint32_t size, uint32_t count, double alpha)
+{
+    std::vector<TeleportVector> teleports = generateTeleports(networkGenerator, size, count, size + count);
+    auto results = computer.computeForNetwork(networkGenerator.generateNetworkOfSize(size), teleports, alpha, 200, 0.0000001);
+    ASSERT(results.size() == teleports.size(), "Unexpected number of results=" << results.size());
+
+    Network network = networkGenerator.generateNetworkOfSize(size);
+    network.generateIds(0, network.getSize());
+    uint32_t maxIterations = 0;
+    for (size_t i = 0; i < teleports.size(); ++i) {
+        ResultVerificator::verifySame(results[i], computeReference(network, teleports[i], alpha), 0.000001);
+        maxIterations = std::max(maxIterations, computer.getLastIterations()[i]);
+    }
+
+    std::cout << "Batch [" << size << " nodes, " << count << " seed sets, alpha=" << alpha << ", " << computer.getName()
+              << "] successed, max iterations " << maxIterations << std::endl;
+}
+
+// Compares one batched pass with computing the seed sets one by one
+void batchPerformance(PersonalizedPageRankComputer const& computer, NetworkGenerator const& networkGenerator, uint32_t size, uint32_t count)
+{
+    std::vector<TeleportVector> teleports = generateTeleports(networkGenerator, size, count, 7);
+
+    Network network = networkGenerator.generateNetworkOfSize(size);
+    PerformanceTimer batchTimer;
+    computer.computeForNetwork(network, teleports, 0.85, 200, 0.0000001);
+    batchTimer.printTimeDifference("Personalized PageRank [" + std::to_string(size) + " nodes, " + std::to_string(count) + " seed sets batched, " + computer.getName() + "]");
+
+    std::vector<Network> networks;
+    for (uint32_t i = 0; i < count; ++i) {
+        networks.push_back(networkGenerator.generateNetworkOfSize(size));
+    }
+    PerformanceTimer singleTimer;
+    for (uint32_t i = 0; i < count; ++i) {
+        computer.computeForNetwork(networks[i], { teleports[i] }, 0.85, 200, 0.0000001);
+    }
+    singleTimer.printTimeDifference("Personalized PageRank [" + std::to_string(size) + " nodes, " + std::to_string(count) + " seed sets one by one, " + computer.getName() + "]");
+}
+
+int main()
+{
+    SimpleIdGenerator idGenerator("8d9b6f4a1c3e5f7a9b0c2d4e6f8a1b3c5d7e9f0a2b4c6d8e0f1a3b5c7d9e1f3a");
+    SimpleNetworkGenerator simpleGenerator(idGenerator);
+    PowerLawNetworkGenerator powerLawGenerator(idGenerator);
+
+    std::vector<std::shared_ptr<PersonalizedPageRankComputer>> computers = {
+        std::shared_ptr<PersonalizedPageRankComputer>(new PersonalizedPageRankComputer { 1, VectorizedPageRankComputer::Kernel::Scalar }),
+        std::shared_ptr<PersonalizedPageRankComputer>(new PersonalizedPageRankComputer { 3, VectorizedPageRankComputer::Kernel::Scalar }),
+        std::shared_ptr<PersonalizedPageRankComputer>(new PersonalizedPageRankComputer { 2 }),
+    };
+    if (VectorizedPageRankComputer::isKernelSupported(VectorizedPageRankComputer::Kernel::Avx2)) {
+        computers.push_back(std::shared_ptr<PersonalizedPageRankComputer>(new PersonalizedPageRankComputer { 2, VectorizedPageRankComputer::Kernel::Avx2 }));
+    }
+
+    for (auto const& computer : computers) {
+        testUniformTeleport(*computer, simpleGenerator, 100);
+        testUniformTeleport(*computer, powerLawGenerator, 2000);
+        testBatch(*computer, simpleGenerator, 5, 3, 0.85);
+        testBatch(*computer, simpleGenerator, 100, 30, 0.85);
+        testBatch(*computer, powerLawGenerator, 2000, 21, 0.5);
+        testBatch(*computer, powerLawGenerator, 2000, 21, 0.85);
+    }
+
+    batchPerformance(PersonalizedPageRankComputer { 1 }, powerLawGenerator, 20000, 32);
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <memory>
+
+#include "../src/immutable/common.hpp"
+#include "../src/immutable/pageIdAndRank.hpp"
+
+#include "../src/graphReordering.hpp"
+#include "../src/rankView.hpp"
+#include "../src/vectorizedPageRankComputer.hpp"
+
+#include "./lib/networkGenerator.hpp"
+#include "./lib/performanceTimer.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+// Full sort of the classic result, best first, equal ranks in the order of the network
+std::vector<PageIdAndRank> sortedResult(std::vector<PageIdAndRank> result)
+{
+    std::stable_sort(result.begin(), result.end(), [](PageIdAndRank const& first, PageIdAndRank const& second) {
+        return first.getPageRank() > second.getPageRank();
+    });
+    return result;
+}
+
+void verifyTop(std::vector<PageIdAndRank> const& top, std::vector<PageIdAndRank> const& sorted, size_t k)
+{
+    ASSERT(top.size() == std::min(k, sorted.size()), "Unexpected top size=" << top.size() << " for k=" << k);
+    for (size_t i = 0; i < top.size(); ++i) {
+        ASSERT(top[i].getPageRank() == sorted[i].getPageRank(), "Invalid rank at position=" << i << ", res=" << top[i].getPageRank() << ", expected=" << sorted[i].getPageRank());
+    }
+}
+
+void testView(VectorizedPageRankComputer const& computer, NetworkGenerator const& networkGenerator, uint32_t size)
+{
+    Network network = networkGenerator.generateNetworkOfSize(size);
+    RankView view = computer.computeViewForNetwork(network, 0.85, 100, 0.0000001);
+    ASSERT(view.getSize() == size, "Invalid view size=" << view.getSize());
+
+    // Vector result keeps the order of the network
+    std::vector<PageIdAndRank> result = view.toVector();
+    auto const& pages = network.getPages();
+    for (uint32_t i = 0; i < size; ++i) {
+        ASSERT(result[i].getPageId() == pages[i].getId(), "PageId mismatch at index=" << i);
+    }
+
+    size_t streamed = 0;
+    view.forEach([&](PageId const& pageId, double rank) {
+        ASSERT(pageId == result[streamed].getPageId() && rank == result[streamed].getPageRank(), "Streamed page mismatch at index=" << streamed);
+        streamed++;
+    });
+    ASSERT(streamed == size, "Unexpected number of streamed pages=" << streamed);
+
+    std::vector<PageIdAndRank> sorted = sortedResult(result);
+    WorkerPool pool(3);
+    for (size_t k : { 0, 1, 10, 100, 10000 }) {
+        verifyTop(view.topK(k), sorted, k);
+        verifyTop(view.topK(k, pool), sorted, k);
+    }
+
+    std::cout << "RankView [" << size << " nodes, " << computer.getName() << "] successed" << std::endl;
+}
+
+// Compares selecting the best pages with materializing and sorting every page
+void topKPerformance(NetworkGenerator const& networkGenerator, uint32_t size, size_t k)
+{
+    RankView view = VectorizedPageRankComputer(1).computeViewForNetwork(networkGenerator.generateNetworkOfSize(size), 0.85, 100, 0.0000001);
+    WorkerPool pool(2);
+
+    PerformanceTimer topTimer;
+    view.topK(k, pool);
+    topTimer.printTimeDifference("Top " + std::to_string(k) + " of " + std::to_string(size) + " pages");
+
+    PerformanceTimer sortTimer;
+    sortedResult(view.toVector());
+    sortTimer.printTimeDifference("Sorted vector of " + std::to_string(size) + " pages");
+}
+
+int main()
+{
+    SimpleIdGenerator idGenerator("2c7e0a4f9b1d3e5a7c9f0b2d4e6a8c1f3b5d7e9a0c2e4f6b8d0a1c3e5f7b9d1e");
+    SimpleNetworkGenerator simpleGenerator(idGenerator);
+    PowerLawNetworkGenerator powerLawGenerator(idGenerator);
+
+    testView(VectorizedPageRankComputer { 1 }, simpleGenerator, 5);
+    testView(VectorizedPageRankComputer { 2 }, simpleGenerator, 1000);
+    testView(VectorizedPageRankComputer { 2 }, powerLawGenerator, 5000);
+    testView(VectorizedPageRankComputer { 2, VectorizedPageRankComputer::detectKernel(), ReorderStrategy::ReverseCuthillMcKee }, powerLawGenerator, 5000);
+
+    topKPerformance(powerLawGenerator, 500000, 100);
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../src/immutable/common.hpp"
+
+#include "../src/computationStats.hpp"
+#include "../src/samplingProfiler.hpp"
+#include "../src/vectorizedPageRankComputer.hpp"
+
+#include "./lib/networkGenerator.hpp"
+#include "./lib/performanceTimer.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+// Kept out of line, so that it shows up in the sampled stacks
+__attribute__((noinline)) double spinForProfiler(double seconds)
+{
+    PerformanceTimer timer;
+    double sum = 0.0;
+    while (timer.getElapsedSeconds() < seconds) {
+        for (int i = 1; i < 10000; ++i) {
+            sum += std::sqrt(static_cast<double>(i));
+        }
+    }
+    return sum;
+}
+
+uint64_t countSamples(std::string const& collapsed, std::string const& frame)
+{
+    std::istringstream lines(collapsed);
+    uint64_t count = 0;
+    std::string line;
+    while (std::getline(lines, line)) {
+        ASSERT(line.rfind(' ') != std::string::npos, "Invalid collapsed stack " << line);
+        if (line.find(frame) != std::string::npos) {
+            count += std::stoull(line.substr(line.rfind(' ') + 1));
+        }
+    }
+    return count;
+}
+
+// Both threads are sampled at about the requested frequency
+void testThreads()
+{
+    SamplingProfiler profiler(1000);
+    double sums[2];
+    // Profiling starts while the other thread already runs
+    std::thread other([&sums] { sums[1] = spinForProfiler(0.6); });
+    profiler.start();
+    sums[0] = spinForProfiler(0.3);
+    other.join();
+    profiler.stop();
+
+    std::ostringstream out;
+    profiler.writeCollapsedStacks(out);
+    uint64_t spinSamples = countSamples(out.str(), "spinForProfiler");
+    ASSERT(spinSamples > 300, "Too few samples=" << spinSamples << " of sampled threads, all=" << profiler.getNumSamples());
+    ASSERT(countSamples(out.str(), "main;testThreads()") > 30, "Too few samples of the main thread");
+    ASSERT(profiler.getNumDropped() == 0, "Dropped samples=" << profiler.getNumDropped());
+
+    std::cout << "Profiler of threads: " << profiler.getNumSamples() << " samples, " << spinSamples << " in spinForProfiler, sums " << sums[0] + sums[1]
+              << ", successed" << std::endl;
+}
+
+// CPU timers do not count time a thread sleeps
+void testCpuClock()
+{
+    SamplingProfiler profiler(1000, SamplingProfiler::Clock::Cpu, 1 << 12);
+    profiler.start();
+    double sum = spinForProfiler(0.2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    profiler.stop();
+
+    std::ostringstream out;
+    profiler.writeCollapsedStacks(out);
+    ASSERT(countSamples(out.str(), "spinForProfiler") > 10, "Too few CPU samples=" << profiler.getNumSamples());
+    ASSERT(countSamples(out.str(), "sleep") * 10 < profiler.getNumSamples(), "Sleeping thread was sampled by CPU time");
+
+    std::cout << "Profiler of CPU time: " << profiler.getNumSamples() << " samples, sum " << sum << ", successed" << std::endl;
+}
+
+// Samples taken in every phase of a computation are grouped under its name
+void testPhases()
+{
+    SimpleIdGenerator idGenerator("7c3a9e1f5b2d8c4a6e0f3b7d9a1c5e8f2b4d6a0c3e7f9b1d5a8c2e4f6b0d3a7c");
+    RmatNetworkGenerator generator(idGenerator);
+    Network network = generator.generateNetworkOfSize(50000);
+
+    VectorizedPageRankComputer computer(2);
+    auto stats = std::make_shared<ComputationStats>();
+    computer.attachStats(stats);
+    SamplingProfiler profiler(5000, SamplingProfiler::Clock::Wall, 1 << 15);
+    profiler.start();
+    computer.computeForNetwork(network, 0.85, 1000, 0.0000001);
+    profiler.stop();
+
+    std::ostringstream all;
+    profiler.writeCollapsedStacks(all, stats.get(), "");
+    std::ostringstream iterations;
+    profiler.writeCollapsedStacks(iterations, stats.get(), "iterations");
+    uint64_t numIterationSamples = countSamples(iterations.str(), "[iterations];");
+    ASSERT(numIterationSamples > 0 && numIterationSamples == countSamples(iterations.str(), ""), "Samples of other phases kept");
+    ASSERT(numIterationSamples == countSamples(all.str(), "[iterations];"), "Different samples of the iterations phase");
+    ASSERT(countSamples(all.str(), "[build];") > 0, "No samples of building the graph");
+    ASSERT(countSamples(all.str(), "") == profiler.getNumSamples(), "Lost samples");
+
+    std::cout << "Profiler of phases: " << countSamples(all.str(), "[generateIds];") << " generateIds, " << countSamples(all.str(), "[build];")
+              << " build, " << numIterationSamples << " iterations samples, successed" << std::endl;
+}
+
+int main()
+{
+    testThreads();
+    testCpuClock();
+    testPhases();
+    return 0;
+}
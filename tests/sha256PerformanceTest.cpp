@@ -0,0 +1,54 @@
+#include "../src/immutable/common.hpp"
+
+#include "../src/sha256IdGenerator.hpp"
+
+#include "./lib/performanceTimer.hpp"
+#include "./lib/popenSha256IdGenerator.hpp"
+
+std::vector<std::string> generateContents(uint32_t num)
+{
+    std::vector<std::string> contents;
+    for (uint32_t i = 0; i < num; ++i) {
+        contents.push_back("Page content number " + std::to_string(i) + "\n");
+    }
+    return contents;
+}
+
+void sha256ComputationWithNumContents(uint32_t num, IdGenerator const& generator, std::string const& name)
+{
+    std::vector<std::string> contents = generateContents(num);
+
+    PerformanceTimer timer;
+    for (auto const& content : contents) {
+        generator.generateId(content);
+    }
+    timer.printTimeDifference("SHA256 Performance Test [" + std::to_string(num) + " contents, " + name + "]");
+}
+
+void sha256BatchComputationWithNumContents(uint32_t num, IdGenerator const& generator, std::string const& name)
+{
+    std::vector<std::string> contents = generateContents(num);
+    std::vector<std::string const*> contentPtrs;
+    for (auto const& content : contents) {
+        contentPtrs.push_back(&content);
+    }
+
+    PerformanceTimer timer;
+    generator.generateIds(contentPtrs);
+    timer.printTimeDifference("SHA256 Performance Test [" + std::to_string(num) + " contents, " + name + "]");
+}
+
+int main()
+{
+    PopenSha256IdGenerator popenGenerator;
+    Sha256IdGenerator generator;
+
+    sha256ComputationWithNumContents(200, popenGenerator, "popen sha256sum");
+    sha256ComputationWithNumContents(200, generator, "native");
+    sha256BatchComputationWithNumContents(200, generator, "native batch x" + std::to_string(Sha256::laneCount()));
+
+    sha256ComputationWithNumContents(1000000, generator, "native");
+    sha256BatchComputationWithNumContents(1000000, generator, "native batch x" + std::to_string(Sha256::laneCount()));
+
+    return 0;
+}
@@ -13,10 +13,53 @@ void testSha256(std::string const& testScenario, std::string const& expectedResu
                                       << ", expectedResult=" << expectedResult);
 }
 
+void testSha256Batch(uint32_t numContents)
+{
+    Sha256IdGenerator generator;
+    std::vector<std::string> contents;
+    for (uint32_t i = 0; i < numContents; ++i) {
+        // Lengths cross every block boundary, lanes of one group differ in length
+        contents.push_back(std::string((i * 37) % 211, static_cast<char>('a' + i % 26)) + std::to_string(i));
+    }
+
+    std::vector<std::string const*> contentPtrs;
+    for (auto const& content : contents) {
+        contentPtrs.push_back(&content);
+    }
+
+    std::vector<PageId> result = generator.generateIds(contentPtrs);
+    ASSERT(result.size() == contents.size(), "Incorrect batch size=" << result.size());
+    for (uint32_t i = 0; i < numContents; ++i) {
+        ASSERT(result[i] == generator.generateId(contents[i]),
+            "Incorrect batch SHA256, scenario=" << contents[i]
+                                                << ", result=" << result[i]
+                                                << ", expectedResult=" << generator.generateId(contents[i]));
+    }
+}
+
+void testPageIdHex(std::string const& hex, std::string const& expectedHex)
+{
+    PageId pageId(hex);
+    std::ostringstream formatted;
+    formatted << pageId;
+    ASSERT(formatted.str() == expectedHex && pageId.toHex() == expectedHex,
+        "Incorrect PageId hex round trip, hex=" << hex << ", result=" << formatted.str());
+}
+
 int main()
 {
     testSha256("Ala ma kota\n", "c51bc001db0206126e1681ba88497ce583f077a92e427e4f62da96b691d28813");
     testSha256("Zawartość naprawdę naprawdę naprawdę wielkiego pliku 1234567890\n", "69bddbdc52992ae9952d3368d48bfe0517ce346d6040e495de3542926294498b");
+    testSha256("", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    testSha256("He said \"100%\" and left\n", "fa1042fcdc8ce56cb38ec4efc0fada8cba8481408956149a991cc16237a68a76");
+    testSha256(std::string(1000, 'a'), "41edece42d63e8d9bf515a9ba6932e1c20cbc9f5a5d134645adb5db1b9737ea3");
+
+    testPageIdHex("c51bc001db0206126e1681ba88497ce583f077a92e427e4f62da96b691d28813", "c51bc001db0206126e1681ba88497ce583f077a92e427e4f62da96b691d28813");
+    testPageIdHex("C51BC001DB0206126E1681BA88497CE583F077A92E427E4F62DA96B691D28813", "c51bc001db0206126e1681ba88497ce583f077a92e427e4f62da96b691d28813");
+    testPageIdHex("0123456789abcdefABCDEF0000000000000000000000000000000000000000ff", "0123456789abcdefabcdef0000000000000000000000000000000000000000ff");
+
+    testSha256Batch(3);
+    testSha256Batch(1000);
 
     return 0;
 }
@@ -0,0 +1,167 @@
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "../src/immutable/common.hpp"
+
+#include "../src/binaryNetwork.hpp"
+#include "../src/compiledNetwork.hpp"
+#include "../src/syntheticGraphGenerator.hpp"
+#include "../src/workerPool.hpp"
+
+#include "./lib/networkGenerator.hpp"
+#include "./lib/performanceTimer.hpp"
+#include "./lib/simpleIdGenerator.hpp"
+
+void verifySameGraph(CompiledNetwork const& compiled, PageIdTable const& expectedIds, CsrGraph const& expected, uint32_t const* expectedOutDegrees)
+{
+    ASSERT(compiled.getSize() == expected.size, "Invalid size=" << compiled.getSize() << ", expected=" << expected.size);
+    ASSERT(compiled.getNumEdges() == expected.numEdges, "Invalid number of edges=" << compiled.getNumEdges() << ", expected=" << expected.numEdges);
+    for (uint32_t page = 0; page < compiled.getSize(); ++page) {
+        ASSERT(compiled.getPageId(page) == expectedIds.getPageId(page), "Invalid page id of page=" << page);
+        ASSERT(compiled.getOutDegrees()[page] == expectedOutDegrees[page], "Invalid out-degree of page=" << page);
+        ASSERT(compiled.getOffsets()[page + 1] == expected.offsets[page + 1], "Invalid offset of page=" << page);
+    }
+    for (uint64_t e = 0; e < compiled.getNumEdges(); ++e) {
+        ASSERT(compiled.getSources()[e] == expected.sources[e], "Invalid source of edge=" << e);
+    }
+    ASSERT(compiled.getDanglingNodes().size() == expected.numDanglingNodes, "Invalid number of dangling pages=" << compiled.getDanglingNodes().size());
+    for (uint64_t i = 0; i < expected.numDanglingNodes; ++i) {
+        ASSERT(compiled.getDanglingNodes()[i] == expected.danglingNodes[i], "Invalid dangling page=" << i);
+    }
+}
+
+// Any number of threads builds the same graph, the same as a network of pages
+// compiled by any number of threads and as the binary network and edge list written to disk
+void testGenerator(SyntheticGraphGenerator const& generator, IdGenerator const& idGenerator)
+{
+    WorkerPool singlePool(1);
+    WorkerPool pool(3);
+    auto compiled = SyntheticGraphWriter::toCompiledNetwork(generator, idGenerator, singlePool);
+    auto parallelCompiled = SyntheticGraphWriter::toCompiledNetwork(generator, idGenerator, pool);
+    verifySameGraph(*parallelCompiled, *compiled, compiled->getGraph(), compiled->getOutDegrees().data());
+
+    Network network = SyntheticGraphWriter::toNetwork(generator, idGenerator, pool);
+    network.generateIds(0, network.getSize());
+    CompiledNetwork fromPages(network);
+    verifySameGraph(fromPages, *compiled, compiled->getGraph(), compiled->getOutDegrees().data());
+    WorkerPool widePool(7);
+    for (WorkerPool* buildPool : { &pool, &widePool }) {
+        CompiledNetwork parallelFromPages(network, *buildPool);
+        verifySameGraph(parallelFromPages, *compiled, compiled->getGraph(), compiled->getOutDegrees().data());
+    }
+    // Serial building does not take any pool, so tasks of a pool can compile networks
+    singlePool.run([&](uint32_t) {
+        CompiledNetwork nested(network);
+        verifySameGraph(nested, *compiled, compiled->getGraph(), compiled->getOutDegrees().data());
+    });
+
+    std::string const binaryPath = "syntheticGraphTest.bin";
+    SyntheticGraphWriter::writeBinaryNetwork(generator, idGenerator, pool, binaryPath);
+    {
+        MappedNetwork mapped(binaryPath);
+        verifySameGraph(*compiled, mapped, mapped.getGraph(), mapped.getOutDegrees());
+    }
+    std::remove(binaryPath.c_str());
+
+    std::string const edgesPath = "syntheticGraphTest.edges";
+    uint64_t numEdges = SyntheticGraphWriter::writeEdgeList(generator, pool, edgesPath);
+    ASSERT(numEdges == compiled->getNumEdges(), "Invalid number of written edges=" << numEdges);
+    std::vector<uint64_t> inDegrees(generator.getNumPages(), 0);
+    std::ifstream in(edgesPath, std::ios::binary);
+    uint32_t edge[2];
+    for (uint64_t e = 0; e < numEdges; ++e) {
+        in.read(reinterpret_cast<char*>(edge), sizeof(edge));
+        ASSERT(in.good(), "Edge list is too short, edge=" << e);
+        inDegrees[edge[1]]++;
+    }
+    in.close();
+    std::remove(edgesPath.c_str());
+    for (uint32_t page = 0; page < generator.getNumPages(); ++page) {
+        ASSERT(inDegrees[page] == compiled->getOffsets()[page + 1] - compiled->getOffsets()[page], "Invalid in-degree in edge list of page=" << page);
+    }
+
+    std::cout << "Synthetic graph [" << generator.getNumPages() << " nodes, " << generator.getName() << "] successed" << std::endl;
+}
+
+// Edges per page and how much the most linked page stands out
+void testDegrees(SyntheticGraphGenerator const& generator, IdGenerator const& idGenerator, double expectedAverage)
+{
+    WorkerPool pool(2);
+    auto compiled = SyntheticGraphWriter::toCompiledNetwork(generator, idGenerator, pool);
+
+    double average = static_cast<double>(compiled->getNumEdges()) / compiled->getSize();
+    uint64_t maxInDegree = 0;
+    for (uint32_t page = 0; page < compiled->getSize(); ++page) {
+        maxInDegree = std::max(maxInDegree, compiled->getOffsets()[page + 1] - compiled->getOffsets()[page]);
+    }
+    ASSERT(std::abs(average - expectedAverage) < 0.1 * expectedAverage, "Unexpected average degree=" << average << ", expected=" << expectedAverage);
+    ASSERT(maxInDegree > 20 * average, "In-degrees are not skewed, max=" << maxInDegree << ", average=" << average);
+
+    std::cout << "Degrees [" << compiled->getSize() << " nodes, " << generator.getName() << "]: average " << average << ", max in-degree " << maxInDegree
+              << ", dangling pages " << compiled->getDanglingNodes().size() << ", successed" << std::endl;
+}
+
+void generationPerformance(SyntheticGraphGenerator const& generator, IdGenerator const& idGenerator)
+{
+    WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    PerformanceTimer timer;
+    auto compiled = SyntheticGraphWriter::toCompiledNetwork(generator, idGenerator, pool);
+    double seconds = timer.getElapsedSeconds();
+    std::cout << "Generating " << generator.getName() << " [" << compiled->getSize() << " nodes, " << compiled->getNumEdges() << " edges] took: " << seconds
+              << "s, " << compiled->getNumEdges() / seconds << " edges/s" << std::endl;
+}
+
+// Time of building the compiled network serially and on pools of growing size
+void compilationPerformance(SyntheticGraphGenerator const& generator, IdGenerator const& idGenerator)
+{
+    WorkerPool generatorPool(std::max(1u, std::thread::hardware_concurrency()));
+    Network network = SyntheticGraphWriter::toNetwork(generator, idGenerator, generatorPool);
+    network.generateIds(0, network.getSize());
+    PerformanceTimer timer;
+    CompiledNetwork serial(network);
+    double serialSeconds = timer.getElapsedSeconds();
+    std::cout << "Compiling " << generator.getName() << " [" << network.getSize() << " nodes, " << serial.getNumEdges() << " edges] took: " << serialSeconds
+              << "s serially";
+    for (uint32_t numThreads : { 1, 2, 4, 8 }) {
+        WorkerPool pool(numThreads);
+        timer = PerformanceTimer();
+        CompiledNetwork parallel(network, pool);
+        double seconds = timer.getElapsedSeconds();
+        std::cout << ", " << seconds << "s on " << numThreads << " threads (speedup " << serialSeconds / seconds << ")";
+    }
+    std::cout << " with " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+}
+
+int main()
+{
+    SimpleIdGenerator idGenerator("a4c2e9f1b7d3a5c8e0f2b4d6a8c1e3f5b7d9a0c2e4f6b8d1a3c5e7f9b0d2e4f6");
+
+    testGenerator(RmatGraphGenerator(2, 3.0, 1), idGenerator);
+    testGenerator(RmatGraphGenerator(1000, 8.0, 1), idGenerator);
+    testGenerator(RmatGraphGenerator(30000, 16.0, 2), idGenerator);
+    testGenerator(KroneckerGraphGenerator({ 0.9, 0.6, 0.2, 0.6, 0.3, 0.1, 0.2, 0.1, 0.1 }, 20000, 10.0, 3), idGenerator);
+    testGenerator(PowerLawGraphGenerator(1, 10.0, 4), idGenerator);
+    testGenerator(PowerLawGraphGenerator(30000, 10.0, 4), idGenerator);
+
+    testDegrees(RmatGraphGenerator(1 << 16, 16.0, 5), idGenerator, 16.0);
+    testDegrees(KroneckerGraphGenerator({ 0.9, 0.6, 0.2, 0.6, 0.3, 0.1, 0.2, 0.1, 0.1 }, 59049, 10.0, 6), idGenerator, 10.0);
+    testDegrees(PowerLawGraphGenerator(100000, 10.0, 7), idGenerator, 10.0);
+    testDegrees(PowerLawGraphGenerator(100000, 20.0, 7, 3.0, 1.8, 0.0), idGenerator, 20.0);
+
+    // The networks of the adapters are generated the same way for every call
+    RmatNetworkGenerator rmatGenerator(idGenerator);
+    Network first = rmatGenerator.generateNetworkOfSize(500);
+    Network second = rmatGenerator.generateNetworkOfSize(500);
+    ASSERT(first.getSize() == 500 && second.getSize() == 500, "Invalid size of R-MAT network=" << first.getSize());
+    for (uint32_t page = 0; page < 500; ++page) {
+        ASSERT(first.getPages()[page].getLinks() == second.getPages()[page].getLinks(), "Different links of page=" << page);
+    }
+
+    generationPerformance(RmatGraphGenerator(1 << 19, 16.0, 8), idGenerator);
+    generationPerformance(PowerLawGraphGenerator(1 << 19, 16.0, 8), idGenerator);
+    compilationPerformance(RmatGraphGenerator(1 << 17, 16.0, 9), idGenerator);
+
+    return 0;
+}
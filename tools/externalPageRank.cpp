@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/immutable/common.hpp"
+
+#include "../src/blockedEdgeFile.hpp"
+#include "../src/externalPageRankComputer.hpp"
+
+// Computes PageRank of a graph whose edges do not fit in memory. The edge list
+// of (source, target) uint32_t pairs, as written by graphGenerator, is first
+// partitioned into a blocked edge file next to it, then streamed from disk
+// once per iteration within the memory budget. Prints the most ranked pages.
+// Usage: externalPageRank <edges> <pages> <block MiB> <budget MiB> [threads]
+int main(int argc, char** argv)
+{
+    ASSERT(argc == 5 || argc == 6, "Usage: " << argv[0] << " <edges> <pages> <block MiB> <budget MiB> [threads]");
+
+    std::string edgesPath = argv[1];
+    uint32_t numPages = static_cast<uint32_t>(std::stoul(argv[2]));
+    uint64_t blockBytes = std::stoull(argv[3]) << 20;
+    uint64_t budget = std::stoull(argv[4]) << 20;
+    uint32_t numThreads = argc == 6 ? static_cast<uint32_t>(std::stoul(argv[5])) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::string blockedPath = edgesPath + ".blocks";
+    BlockedEdgeFile::write(edgesPath, numPages, blockedPath, blockBytes);
+    BlockedEdgeFile file(blockedPath);
+    std::cout << "Partitioned edges=" << file.getNumEdges() << " of pages=" << file.getNumPages() << " into blocks=" << file.getBlocks().size()
+              << " in " << blockedPath << std::endl;
+
+    ExternalPageRankComputer computer(numThreads, budget);
+    std::vector<double> ranks = computer.computeForFile(file, 0.85, 1000, 0.0000001);
+    std::cout << "Converged in iterations=" << computer.getLastIterations() << " with buffers=" << computer.getLastNumBuffers()
+              << ", waiting for I/O " << computer.getLastIoWaitSeconds() << "s" << std::endl;
+
+    std::vector<uint32_t> pages(ranks.size());
+    std::iota(pages.begin(), pages.end(), 0);
+    size_t numTop = std::min<size_t>(10, pages.size());
+    std::partial_sort(pages.begin(), pages.begin() + numTop, pages.end(), [&ranks](uint32_t a, uint32_t b) {
+        return ranks[a] > ranks[b];
+    });
+    for (size_t i = 0; i < numTop; ++i) {
+        std::cout << pages[i] << " " << ranks[pages[i]] << std::endl;
+    }
+    return 0;
+}
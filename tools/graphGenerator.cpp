@@ -0,0 +1,48 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../src/immutable/common.hpp"
+
+#include "../src/sha256IdGenerator.hpp"
+#include "../src/syntheticGraphGenerator.hpp"
+#include "../src/workerPool.hpp"
+
+// Generates a synthetic graph straight into the binary network format read by
+// MappedNetwork, or streams its edges as (source, target) uint32_t pairs.
+// Usage: graphGenerator <rmat|kronecker|powerlaw> <pages> <edges per page> <binary|edges> <output> [seed]
+int main(int argc, char** argv)
+{
+    ASSERT(argc == 6 || argc == 7, "Usage: " << argv[0] << " <rmat|kronecker|powerlaw> <pages> <edges per page> <binary|edges> <output> [seed]");
+
+    std::string family = argv[1];
+    uint32_t numPages = static_cast<uint32_t>(std::stoul(argv[2]));
+    double edgesPerPage = std::stod(argv[3]);
+    std::string format = argv[4];
+    uint64_t seed = argc == 7 ? std::stoull(argv[6]) : 42;
+
+    std::shared_ptr<SyntheticGraphGenerator> generator;
+    if (family == "rmat") {
+        generator.reset(new RmatGraphGenerator(numPages, edgesPerPage, seed));
+    } else if (family == "kronecker") {
+        generator.reset(new KroneckerGraphGenerator({ 0.9, 0.6, 0.2, 0.6, 0.3, 0.1, 0.2, 0.1, 0.1 }, numPages, edgesPerPage, seed));
+    } else if (family == "powerlaw") {
+        generator.reset(new PowerLawGraphGenerator(numPages, edgesPerPage, seed));
+    } else {
+        ASSERT(false, "Unknown graph family " << family);
+    }
+
+    WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    if (format == "binary") {
+        Sha256IdGenerator idGenerator;
+        SyntheticGraphWriter::writeBinaryNetwork(*generator, idGenerator, pool, argv[5]);
+        std::cout << "Generated " << generator->getName() << " network of pages=" << numPages << " into " << argv[5] << std::endl;
+    } else {
+        ASSERT(format == "edges", "Unknown output format " << format);
+        uint64_t numEdges = SyntheticGraphWriter::writeEdgeList(*generator, pool, argv[5]);
+        std::cout << "Generated " << generator->getName() << " edges=" << numEdges << " of pages=" << numPages << " into " << argv[5] << std::endl;
+    }
+    return 0;
+}
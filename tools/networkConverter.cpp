@@ -0,0 +1,27 @@
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#include "../src/immutable/common.hpp"
+
+#include "../src/binaryNetwork.hpp"
+#include "../src/compiledNetwork.hpp"
+#include "../src/sha256IdGenerator.hpp"
+#include "../src/parallelNetworkReader.hpp"
+
+// Converts a network in the e2e text format into the binary format read by MappedNetwork.
+// Usage: networkConverter <input.txt> <output.bin>
+int main(int argc, char** argv)
+{
+    ASSERT(argc == 3, "Usage: " << argv[0] << " <input.txt> <output.bin>");
+
+    Sha256IdGenerator idGenerator;
+    Network network = ParallelNetworkReader(std::max(1u, std::thread::hardware_concurrency())).readFile(argv[1], idGenerator);
+    network.generateIds(0, network.getSize());
+
+    CompiledNetwork compiled(network);
+    BinaryNetwork::write(compiled, argv[2]);
+
+    std::cout << "Converted pages=" << compiled.getSize() << ", edges=" << compiled.getNumEdges() << " into " << argv[2] << std::endl;
+    return 0;
+}
@@ -2,4 +2,9 @@ git clone https://github.com/brendangregg/FlameGraph > /dev/null 2> /dev/null ||
 
 input=$1
 output=$2
-cat $1 | ./FlameGraph/stackcollapse-gdb.pl | ./FlameGraph/flamegraph.pl > $2
+# Collapsed stacks of SamplingProfiler (*.folded) need no collapsing
+if [[ $input == *.folded ]]; then
+	cat $1 | ./FlameGraph/flamegraph.pl > $2
+else
+	cat $1 | ./FlameGraph/stackcollapse-gdb.pl | ./FlameGraph/flamegraph.pl > $2
+fi
@@ -1,5 +1,7 @@
 #!/bin/bash
 # Profiler based on http://poormansprofiler.org/
+# Stops the process for every sample, timing-sensitive runs are better profiled
+# in-process by SamplingProfiler (src/samplingProfiler.hpp, pageRankBenchmark --profile).
 
 programToProfile=$1
 outputName=$2